@@ -24,11 +24,13 @@
 #define FCITX_LIBRARY_SUFFIX ".so"
 
 #include "androidaddonloader.h"
+#include "../trace-event.h"
 
 namespace fcitx {
 
 AddonInstance *AndroidSharedLibraryLoader::load(const AddonInfo &info,
                                                 AddonManager *manager) {
+    TraceSpan span("loadAddon", "addon", info.uniqueName());
     auto iter = registry_.find(info.uniqueName());
     if (iter == registry_.end()) {
         std::vector<std::string> libnames =
@@ -2,6 +2,7 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  * SPDX-FileCopyrightText: Copyright 2021-2023 Fcitx5 for Android Contributors
  */
+#include <fcitx/action.h>
 #include <fcitx/addonfactory.h>
 #include <fcitx/addonmanager.h>
 #include <fcitx/candidatelist.h>
@@ -11,9 +12,14 @@
 #include <fcitx/inputmethodmanager.h>
 #include <fcitx/inputpanel.h>
 #include <fcitx/statusarea.h>
+#include <fcitx/userinterfacemanager.h>
 #include <fcitx-utils/event.h>
+#include <fcitx-utils/standardpaths.h>
+
+#include <filesystem>
 
 #include "androidfrontend.h"
+#include "../candidate-delta.h"
 
 namespace fcitx {
 
@@ -25,7 +31,8 @@ public:
                         const std::string &pkgName)
             : InputContextV2(inputContextManager, pkgName),
               frontend_(frontend),
-              uid_(uid) {
+              uid_(uid),
+              filterCache_(frontend->outputFilterCounters()) {
         created();
     }
 
@@ -36,6 +43,8 @@ public:
 
     [[nodiscard]] const char *frontend() const override { return "androidfrontend"; }
 
+    [[nodiscard]] int uid() const { return uid_; }
+
     void commitStringImpl(const std::string &text) override {
         frontend_->commitString(text, -1);
     }
@@ -92,40 +101,75 @@ public:
     }
 
     void updateCandidatesBulk() {
+        KeystrokeSpan span(frontend_->keystrokeTracer(), KeystrokeStage::Candidates);
+        syncOutputFilter();
+        if (frontend_->candidateDeltaEnabled()) {
+            updateCandidatesDelta();
+            return;
+        }
         std::vector<CandidateEntity> candidates;
-        int total = 0;
-        const auto &list = inputPanel().candidateList();
-        if (list) {
-            const auto &bulk = list->toBulk();
-            if (bulk) {
-                total = bulk->totalSize();
-                // limit candidate count to 16 (for paging)
-                const int limit = total < 0 ? 16 : std::min(total, 16);
-                for (int i = 0; i < limit; i++) {
-                    try {
-                        // maybe unnecessary; I don't see anywhere using `CandidateWord::setPlaceHolder`
-                        // if (candidate.isPlaceHolder()) continue;
-                        candidates.emplace_back(candidateEntity(bulk->candidateFromAll(i)));
-                    } catch (const std::invalid_argument &e) {
-                        FCITX_WARN() << "updateCandidatesBulk(): " << e.what();
-                        total = static_cast<int>(candidates.size());
-                        break;
-                    }
-                }
-            } else {
-                total = list->size();
-                for (int i = 0; i < total; i++) {
-                    candidates.emplace_back(candidateEntity(list->candidate(i)));
-                }
-            }
+        if (frontend_->candidateBufferEnabled()) {
+            auto &buffer = frontend_->candidateBuffer();
+            buffer.clear();
+            const int total = collectCandidatesBulk([&buffer, &candidates](CandidateEntity &&c) {
+                buffer.append(c);
+                candidates.emplace_back(std::move(c));
+            });
+            buffer.finish();
+            frontend_->updateCandidateBuffer(total);
+            frontend_->primeCandidateCursor(inputPanel().candidateList(), total, candidates);
+            return;
         }
+        const int total = collectCandidatesBulk([&candidates](CandidateEntity &&c) {
+            candidates.emplace_back(std::move(c));
+        });
         frontend_->updateCandidateList(candidates, total);
+        frontend_->primeCandidateCursor(inputPanel().candidateList(), total, candidates);
+    }
+
+    /**
+     * Push only candidates that are not in the list this context pushed last time,
+     * if the client still has that list.
+     */
+    void updateCandidatesDelta() {
+        std::vector<CandidateEntity> candidates;
+        const int total = collectCandidatesBulk([&candidates](CandidateEntity &&c) {
+            candidates.emplace_back(std::move(c));
+        });
+        std::vector<int32_t> delta;
+        std::vector<size_t> inserted;
+        if (lastCandidatesGeneration_ != 0 && lastCandidatesGeneration_ == frontend_->candidateDeltaBase()) {
+            delta = candidate_delta::encode(lastCandidates_, candidates, inserted);
+        }
+        auto &buffer = frontend_->candidateBuffer();
+        buffer.clear();
+        if (delta.empty()) {
+            for (const auto &c: candidates) {
+                buffer.append(c);
+            }
+        } else {
+            for (const auto i: inserted) {
+                buffer.append(candidates[i]);
+            }
+        }
+        buffer.finish();
+        lastCandidatesGeneration_ = frontend_->updateCandidateDelta(total, std::move(delta));
+        frontend_->primeCandidateCursor(inputPanel().candidateList(), total, candidates);
+        lastCandidates_ = std::move(candidates);
     }
 
     void updateCandidatesPaged() {
+        syncOutputFilter();
         const auto &list = inputPanel().candidateList();
         if (!list) {
-            frontend_->updatePagedCandidate(PagedCandidateEntity::Empty);
+            if (frontend_->candidateBufferEnabled()) {
+                auto &buffer = frontend_->candidateBuffer();
+                buffer.clear();
+                buffer.finish();
+                frontend_->updatePagedCandidateBuffer(-1, CandidateLayoutHint::NotSet, false, false);
+            } else {
+                frontend_->updatePagedCandidate(PagedCandidateEntity::Empty);
+            }
             return;
         }
         int cursorIndex = list->cursorIndex();
@@ -138,6 +182,16 @@ public:
             hasNext = pageable->hasNext();
         }
         int size = list->size();
+        if (frontend_->candidateBufferEnabled()) {
+            auto &buffer = frontend_->candidateBuffer();
+            buffer.clear();
+            for (int i = 0; i < size; i++) {
+                buffer.append(candidateEntityWithLabel(list->label(i), list->candidate(i)));
+            }
+            buffer.finish();
+            frontend_->updatePagedCandidateBuffer(cursorIndex, layoutHint, hasPrev, hasNext);
+            return;
+        }
         std::vector<CandidateEntity> candidates;
         candidates.reserve(size);
         for (int i = 0; i < size; i++) {
@@ -181,6 +235,7 @@ public:
     }
 
     std::vector<CandidateEntity> getCandidates(const int offset, const int limit) {
+        syncOutputFilter();
         std::vector<CandidateEntity> candidates;
         const auto &list = inputPanel().candidateList();
         if (list) {
@@ -206,6 +261,29 @@ public:
         return candidates;
     }
 
+    /**
+     * Candidate `idx` of the whole list, for CandidateCursor
+     * @return false if out of range
+     */
+    bool candidateAt(const int idx, CandidateEntity &out) {
+        const auto &list = inputPanel().candidateList();
+        if (!list) return false;
+        const auto &bulk = list->toBulk();
+        if (bulk) {
+            const int totalSize = bulk->totalSize();
+            if (totalSize >= 0 && idx >= totalSize) return false;
+            try {
+                out = candidateEntity(bulk->candidateFromAll(idx));
+            } catch (const std::invalid_argument &e) {
+                return false;
+            }
+            return true;
+        }
+        if (idx >= list->size()) return false;
+        out = candidateEntityWithLabel(list->label(idx), list->candidate(idx));
+        return true;
+    }
+
     std::vector<CandidateActionEntity> getCandidateAction(const int idx) {
         std::vector<CandidateActionEntity> actions;
         const auto &list = inputPanel().candidateList();
@@ -292,13 +370,101 @@ public:
 private:
     AndroidFrontend *frontend_;
     int uid_;
+    // last bulk candidates pushed by this context, base of the next delta
+    std::vector<CandidateEntity> lastCandidates_;
+    uint32_t lastCandidatesGeneration_ = 0;
+    // filtered candidate strings, valid as long as filterState_ holds
+    OutputFilterCache filterCache_;
+    std::string filterState_;
+
+    // keys of texts other than a single unformatted segment start with this
+    static constexpr char SegmentedKeyTag = '\x01';
 
     inline Text filterText(const Text &orig) {
         return frontend_->instance()->outputFilter(this, orig);
     }
 
     inline std::string filterString(const Text &orig) {
-        return filterText(orig).toString();
+        if (orig.empty()) {
+            return {};
+        }
+        const auto filter = [this, &orig]() { return filterText(orig).toString(); };
+        if (orig.size() == 1 && orig.formatAt(0).toInteger() == 0) {
+            const auto &str = orig.stringAt(0);
+            if (str[0] != SegmentedKeyTag) {
+                return filterCache_.get(str, filter);
+            }
+        }
+        // filters may convert segments separately, so they are part of the key
+        std::string key(1, SegmentedKeyTag);
+        for (size_t i = 0; i < orig.size(); i++) {
+            const auto &str = orig.stringAt(i);
+            key += std::to_string(orig.formatAt(i).toInteger());
+            key += ':';
+            key += std::to_string(str.size());
+            key += ':';
+            key += str;
+        }
+        return filterCache_.get(key, filter);
+    }
+
+    /**
+     * Drop cached filter results if anything output filters depend on has changed: the input
+     * method, state of addons toggled from status area (chttrans, fullwidth...), or their config.
+     * Called once per candidate push rather than per string.
+     */
+    void syncOutputFilter() {
+        std::string state = frontend_->instance()->inputMethod(this);
+        state += '\0';
+        state += std::to_string(frontend_->outputFilterEpoch());
+        for (auto *action: statusArea().allActions()) {
+            state += '\0';
+            state += action->name();
+            state += '\0';
+            state += action->shortText(this);
+            state += action->isChecked(this) ? '1' : '0';
+        }
+        if (state != filterState_) {
+            filterState_ = std::move(state);
+            filterCache_.reset();
+        }
+    }
+
+    /**
+     * Feed the first page of bulk candidates (or the whole list if it's not bulk) to `sink`.
+     * @return total candidate count, -1 if unknown
+     */
+    template<typename Sink>
+    int collectCandidatesBulk(Sink &&sink) {
+        int total = 0;
+        const auto &list = inputPanel().candidateList();
+        if (!list) {
+            return total;
+        }
+        const auto &bulk = list->toBulk();
+        if (bulk) {
+            total = bulk->totalSize();
+            // first window only, the rest is read by CandidateCursor when expanded
+            const int window = frontend_->candidateWindowSize();
+            const int limit = total < 0 ? window : std::min(total, window);
+            for (int i = 0; i < limit; i++) {
+                try {
+                    // maybe unnecessary; I don't see anywhere using `CandidateWord::setPlaceHolder`
+                    // if (candidate.isPlaceHolder()) continue;
+                    sink(candidateEntity(bulk->candidateFromAll(i)));
+                } catch (const std::invalid_argument &e) {
+                    FCITX_WARN() << "updateCandidatesBulk(): " << e.what();
+                    total = i;
+                    break;
+                }
+            }
+        } else {
+            total = list->size();
+            for (int i = 0; i < total; i++) {
+                sink(candidateEntity(list->candidate(i)));
+            }
+        }
+        return total;
     }
 
     CandidateEntity candidateEntity(const CandidateWord &candidate) {
@@ -312,13 +478,42 @@ private:
     }
 };
 
+static std::string inputContextSnapshotPath() {
+    const auto dir = StandardPaths::global().userDirectory(StandardPathsType::PkgData) / "androidfrontend";
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    return (dir / "icsnapshot").string();
+}
+
 AndroidFrontend::AndroidFrontend(Instance *instance)
         : instance_(instance),
           focusGroup_("android", instance->inputContextManager()),
           activeIC_(nullptr),
           icCache_(),
+          icSnapshot_(inputContextSnapshotPath(), icCache_.capacity()),
+          pendingActivation_(PendingActivation::None),
+          activationStart_(),
+          activationStats_(),
           eventHandlers_(),
-          pagingMode_(0) {
+          pagingMode_(0),
+          candidateBufferEnabled_(false),
+          candidateBuffer_(),
+          transactionEnabled_(false),
+          transaction_(),
+          inputPanelDirty_(false),
+          statusAreaDirty_(false),
+          candidateGenerationCounter_(0),
+          candidateGeneration_(0),
+          candidateCursor_(),
+          candidateCursorList_(),
+          candidateWindowSize_(16),
+          outputFilterEpoch_(0),
+          outputFilterCacheStats_(),
+          frameScheduler_(),
+          frameTimer_(),
+          keystrokeTracer_(),
+          statusAreaDigest_(0),
+          statusAreaStats_() {
     eventHandlers_.emplace_back(instance_->watchEvent(
             EventType::InputContextInputMethodActivated,
             EventWatcherPhase::Default,
@@ -326,6 +521,7 @@ AndroidFrontend::AndroidFrontend(Instance *instance)
                 auto &e = static_cast<InputMethodActivatedEvent &>(event);
                 if (e.inputContext() != activeIC_) return;
                 imChangeCallback(makeInputMethodStatus(activeIC_));
+                saveInputContextState(activeIC_);
             }
     ));
     eventHandlers_.emplace_back(instance_->watchEvent(
@@ -345,6 +541,20 @@ AndroidFrontend::AndroidFrontend(Instance *instance)
             [this](Event &event) {
                 auto &e = static_cast<InputContextFlushUIEvent &>(event);
                 if (e.inputContext() != activeIC_) return;
+                if (transactionEnabled_) {
+                    // superseded states are never built, see flushUITransaction
+                    switch (e.component()) {
+                        case UserInterfaceComponent::InputPanel:
+                            inputPanelDirty_ = true;
+                            break;
+                        case UserInterfaceComponent::StatusArea:
+                            statusAreaDirty_ = true;
+                            break;
+                    }
+                    markFrameDirty();
+                    return;
+                }
+                KeystrokeSpan span(&keystrokeTracer_, KeystrokeStage::FlushUI);
                 switch (e.component()) {
                     case UserInterfaceComponent::InputPanel: {
                         activeIC_->updateInputPanel();
@@ -356,7 +566,11 @@ AndroidFrontend::AndroidFrontend(Instance *instance)
                         break;
                     }
                     case UserInterfaceComponent::StatusArea: {
-                        statusAreaUpdateCallback(makeStatusAreaActions(activeIC_), makeInputMethodStatus(activeIC_));
+                        auto actions = makeStatusAreaActions(activeIC_);
+                        auto status = makeInputMethodStatus(activeIC_);
+                        if (statusAreaChanged(actions, status)) {
+                            statusAreaUpdateCallback(actions, status);
+                        }
                         break;
                     }
                 }
@@ -366,20 +580,42 @@ AndroidFrontend::AndroidFrontend(Instance *instance)
 
 void AndroidFrontend::keyEvent(const Key &key, bool isRelease, const int timestamp) {
     if (!activeIC_) return;
+    KeystrokeSpan span(&keystrokeTracer_, KeystrokeStage::FrontendKeyEvent);
     KeyEvent keyEvent(activeIC_, key, isRelease);
-    activeIC_->keyEvent(keyEvent);
+    {
+        KeystrokeSpan engineSpan(&keystrokeTracer_, KeystrokeStage::Engine);
+        activeIC_->keyEvent(keyEvent);
+    }
     if (!keyEvent.accepted()) {
         auto sym = key.sym();
-        keyEventCallback(sym, key.states(), Key::keySymToUnicode(sym), isRelease, timestamp);
+        if (transactionEnabled_) {
+            transaction_.forwardKey(sym, key.states(), Key::keySymToUnicode(sym), isRelease, timestamp);
+        } else {
+            keyEventCallback(sym, key.states(), Key::keySymToUnicode(sym), isRelease, timestamp);
+        }
+    }
+    if (transactionEnabled_) {
+        // don't wait for the deferred UI update, so that the key produces at most one transaction;
+        // none if its UI state is held by frameScheduler_
+        instance_->flushUI();
+        flushUITransaction();
     }
 }
 
 void AndroidFrontend::forwardKey(const Key &key, bool isRelease) {
     auto sym = key.sym();
+    if (transactionEnabled_) {
+        transaction_.forwardKey(sym, key.states(), Key::keySymToUnicode(sym), isRelease, -1);
+        return;
+    }
     keyEventCallback(sym, key.states(), Key::keySymToUnicode(sym), isRelease, -1);
 }
 
 void AndroidFrontend::commitString(const std::string &str, const int cursor) {
+    if (transactionEnabled_) {
+        transaction_.commitString(str, cursor);
+        return;
+    }
     commitStringCallback(str, cursor);
 }
 
@@ -388,10 +624,19 @@ void AndroidFrontend::updateCandidateList(const std::vector<CandidateEntity> &ca
 }
 
 void AndroidFrontend::updateClientPreedit(const Text &clientPreedit) {
+    if (transactionEnabled_) {
+        transaction_.clientPreedit = clientPreedit;
+        markFrameDirty();
+        return;
+    }
     preeditCallback(clientPreedit);
 }
 
 void AndroidFrontend::updateInputPanel(const Text &preedit, const Text &auxUp, const Text &auxDown, const std::vector<CandidateActionEntity> &tabs) {
+    if (transactionEnabled_) {
+        transaction_.inputPanel = UITransaction::InputPanel{preedit, auxUp, auxDown, tabs};
+        return;
+    }
     inputPanelCallback(preedit, auxUp, auxDown, tabs);
 }
 
@@ -443,21 +688,61 @@ void AndroidFrontend::focusInputContext(bool focus) {
     if (!activeIC_) return;
     if (focus) {
         activeIC_->focusIn();
+        if (pendingActivation_ != PendingActivation::None) {
+            const auto nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - activationStart_).count());
+            if (pendingActivation_ == PendingActivation::Warm) {
+                activationStats_.warm++;
+                activationStats_.warmNanos += nanos;
+            } else {
+                activationStats_.cold++;
+                activationStats_.coldNanos += nanos;
+            }
+            pendingActivation_ = PendingActivation::None;
+        }
     } else {
         activeIC_->focusOut();
     }
 }
 
 void AndroidFrontend::activateInputContext(const int uid, const std::string &pkgName) {
+    // pending changes belong to the previous input context
+    deliverUITransaction();
     auto *ptr = icCache_.find(uid);
     if (ptr) {
         activeIC_ = dynamic_cast<AndroidInputContext *>(ptr->get());
+        pendingActivation_ = PendingActivation::None;
     } else {
+        activationStart_ = std::chrono::steady_clock::now();
         auto *ic = new AndroidInputContext(this, instance_->inputContextManager(), uid, pkgName);
-        activeIC_ = ic;
         icCache_.insert(uid, ic);
         ic->setFocusGroup(&focusGroup_);
+        // restore before activeIC_ is set, so it is not reported as a switch by user
+        pendingActivation_ = restoreInputContext(ic) ? PendingActivation::Warm : PendingActivation::Cold;
+        activeIC_ = ic;
+        saveInputContextState(ic);
+    }
+}
+
+bool AndroidFrontend::restoreInputContext(AndroidInputContext *ic) {
+    // read the file only when the first input context is created in this process
+    icSnapshot_.load();
+    const auto *state = icSnapshot_.find(ic->uid());
+    // uid may have been taken by another package since
+    if (!state || state->pkgName != ic->program()) return false;
+    ic->setCapabilityFlags(CapabilityFlags(state->capabilityFlags));
+    // set before focus, so the engine is activated once with the restored input method
+    // instead of activating the default one and then switching
+    if (!state->inputMethod.empty() &&
+        instance_->inputMethodManager().entry(state->inputMethod) &&
+        instance_->inputMethod(ic) != state->inputMethod) {
+        instance_->setCurrentInputMethod(ic, state->inputMethod, true);
     }
+    return true;
+}
+
+void AndroidFrontend::saveInputContextState(AndroidInputContext *ic) {
+    icSnapshot_.put({ic->uid(), ic->program(), instance_->inputMethod(ic), ic->capabilityFlags().toInteger()});
 }
 
 InputContext *AndroidFrontend::activeInputContext() const {
@@ -467,6 +752,7 @@ InputContext *AndroidFrontend::activeInputContext() const {
 void AndroidFrontend::deactivateInputContext(const int uid) {
     auto *ptr = icCache_.find(uid);
     if (!ptr) return;
+    deliverUITransaction();
     focusGroup_.setFocusedInputContext(nullptr);
     activeIC_ = nullptr;
 }
@@ -474,6 +760,7 @@ void AndroidFrontend::deactivateInputContext(const int uid) {
 void AndroidFrontend::setCapabilityFlags(uint64_t flag) {
     if (!activeIC_) return;
     activeIC_->setCapabilityFlags(CapabilityFlags(flag));
+    saveInputContextState(activeIC_);
 }
 
 void AndroidFrontend::setCandidateListCallback(const CandidateListCallback &callback) {
@@ -485,7 +772,80 @@ std::vector<CandidateEntity> AndroidFrontend::getCandidates(const int offset, co
     return activeIC_->getCandidates(offset, limit);
 }
 
+uint32_t AndroidFrontend::openCandidateCursor() {
+    if (candidateCursor_.generation() != 0 && candidateCursorListAlive()) {
+        // keep what has been prefetched for this list
+        return candidateCursor_.generation();
+    }
+    candidateCursorList_.reset();
+    if (!activeIC_) {
+        candidateCursor_.close();
+        return 0;
+    }
+    const auto &list = activeIC_->inputPanel().candidateList();
+    if (!list) {
+        candidateCursor_.close();
+        return 0;
+    }
+    candidateCursorList_ = list;
+    const auto &bulk = list->toBulk();
+    return candidateCursor_.open(bulk ? bulk->totalSize() : list->size());
+}
+
+bool AndroidFrontend::readCandidates(const uint32_t generation, const int offset, const int limit,
+                                     std::vector<CandidateEntity> &candidates) {
+    if (!candidateCursorListAlive()) {
+        candidateCursor_.close();
+    }
+    // next window is fetched by prefetchCandidates, after the client got this one
+    return candidateCursor_.read(generation, offset, limit, candidates, [this](int i, CandidateEntity &c) {
+        return activeIC_->candidateAt(i, c);
+    });
+}
+
+void AndroidFrontend::primeCandidateCursor(const std::shared_ptr<CandidateList> &list, const int total,
+                                           const std::vector<CandidateEntity> &first) {
+    if (!list) {
+        candidateCursorList_.reset();
+        candidateCursor_.close();
+        return;
+    }
+    candidateCursorList_ = list;
+    candidateCursor_.open(total);
+    candidateCursor_.prime(first, candidateWindowSize_);
+}
+
+void AndroidFrontend::prefetchCandidates() {
+    if (!candidateCursor_.readaheadPending()) return;
+    if (!candidateCursorListAlive()) {
+        candidateCursor_.close();
+        return;
+    }
+    candidateCursor_.readahead([this](int i, CandidateEntity &c) {
+        return activeIC_->candidateAt(i, c);
+    });
+}
+
+bool AndroidFrontend::candidatePrefetchPending() {
+    return candidateCursor_.readaheadPending() && candidateCursorListAlive();
+}
+
+void AndroidFrontend::setCandidateWindowSize(const int size) {
+    candidateWindowSize_ = std::max(size, 1);
+}
+
+bool AndroidFrontend::candidateCursorListAlive() const {
+    if (!activeIC_) return false;
+    const auto &list = activeIC_->inputPanel().candidateList();
+    // weak_ptr keeps the address from being reused while it is not expired
+    return list && !candidateCursorList_.expired() && candidateCursorList_.lock() == list;
+}
+
 void AndroidFrontend::deleteSurrounding(const int before, const int after) {
+    if (transactionEnabled_) {
+        transaction_.deleteSurrounding(before, after);
+        return;
+    }
     deleteSurroundingCallback(before, after);
 }
 
@@ -506,6 +866,81 @@ void AndroidFrontend::updatePagedCandidate(const PagedCandidateEntity &paged) {
     pagedCandidateCallback(paged);
 }
 
+void AndroidFrontend::updateCandidateBuffer(const int total) {
+    if (transactionEnabled_) {
+        // content is already in transaction_.candidateBuffer
+        transaction_.candidates = UITransaction::Candidates{0, total};
+        return;
+    }
+    candidateBufferCallback(candidateBuffer_, total);
+}
+
+void AndroidFrontend::updatePagedCandidateBuffer(const int cursorIndex, const CandidateLayoutHint layoutHint,
+                                                 const bool hasPrev, const bool hasNext) {
+    if (transactionEnabled_) {
+        transaction_.candidates = UITransaction::Candidates{1, cursorIndex, layoutHint, hasPrev, hasNext};
+        // a pending bulk push may have been replaced
+        candidateGeneration_ = 0;
+        return;
+    }
+    pagedCandidateBufferCallback(candidateBuffer_, cursorIndex, layoutHint, hasPrev, hasNext);
+}
+
+uint32_t AndroidFrontend::candidateDeltaBase() const {
+    // only one candidate list per transaction reaches the client
+    return transaction_.candidates ? 0 : candidateGeneration_;
+}
+
+uint32_t AndroidFrontend::updateCandidateDelta(const int total, std::vector<int32_t> delta) {
+    UITransaction::Candidates candidates{0, total};
+    candidates.baseGeneration = delta.empty() ? 0 : candidateGeneration_;
+    candidates.delta = std::move(delta);
+    // 0 means the client list is unknown
+    if (++candidateGenerationCounter_ == 0) {
+        candidateGenerationCounter_ = 1;
+    }
+    candidates.generation = candidateGenerationCounter_;
+    candidateGeneration_ = candidateGenerationCounter_;
+    transaction_.candidates = std::move(candidates);
+    return candidateGeneration_;
+}
+
+void AndroidFrontend::resyncCandidates() {
+    candidateGeneration_ = 0;
+    if (!activeIC_) return;
+    activeIC_->updateUserInterface(UserInterfaceComponent::InputPanel);
+}
+
+void AndroidFrontend::setInputContextCacheCapacity(const int capacity) {
+    if (activeIC_) {
+        // active one must survive the shrink
+        icCache_.find(activeIC_->uid());
+    }
+    icCache_.setCapacity(static_cast<size_t>(std::max(capacity, 1)));
+    icSnapshot_.setMaxEntries(icCache_.capacity());
+}
+
+void AndroidFrontend::resetOutputFilterCache() {
+    // input contexts notice on their next push
+    outputFilterEpoch_++;
+}
+
+OutputFilterCacheStats AndroidFrontend::outputFilterCacheStats() {
+    return outputFilterCacheStats_;
+}
+
+void AndroidFrontend::setUIFrameBudget(const int micros) {
+    frameScheduler_.setBudget(static_cast<uint64_t>(std::max(micros, 0)));
+}
+
+FrameSchedulerStats AndroidFrontend::uiFrameStats() {
+    return frameScheduler_.stats();
+}
+
+InputContextCacheStats AndroidFrontend::inputContextCacheStats() {
+    return {icCache_.stats(), icCache_.size(), icCache_.capacity(), activationStats_};
+}
+
 void AndroidFrontend::offsetCandidatePage(int delta) {
     if (!activeIC_) return;
     activeIC_->offsetCandidatePage(delta);
@@ -516,6 +951,64 @@ void AndroidFrontend::triggerCandidateListTabAction(int id) {
     activeIC_->triggerTabAction(id);
 }
 
+void AndroidFrontend::markFrameDirty() {
+    if (!frameScheduler_.markDirty(now(CLOCK_MONOTONIC))) return;
+    // held until the frame deadline, unless something flushes it earlier
+    if (!frameTimer_) {
+        frameTimer_ = instance_->eventLoop().addTimeEvent(
+                CLOCK_MONOTONIC, frameScheduler_.deadline(), 0,
+                [this](EventSourceTime *, uint64_t) {
+                    deliverUITransaction();
+                    return true;
+                });
+    } else {
+        frameTimer_->setTime(frameScheduler_.deadline());
+        frameTimer_->setOneShot();
+    }
+}
+
+void AndroidFrontend::flushUITransaction() {
+    if (!transactionEnabled_) return;
+    // text changes are never held, they may depend on the state the user has seen
+    const bool urgent = !transaction_.actions.empty();
+    if (!frameScheduler_.shouldPush(now(CLOCK_MONOTONIC), urgent)) return;
+    deliverUITransaction();
+}
+
+void AndroidFrontend::deliverUITransaction() {
+    if (!transactionEnabled_) return;
+    if (frameTimer_) {
+        frameTimer_->setEnabled(false);
+    }
+    if (activeIC_) {
+        KeystrokeSpan span(&keystrokeTracer_, KeystrokeStage::FlushUI);
+        if (inputPanelDirty_) {
+            activeIC_->updateInputPanel();
+            if (pagingMode_ == 0) {
+                activeIC_->updateCandidatesBulk();
+            } else {
+                activeIC_->updateCandidatesPaged();
+            }
+        }
+        if (statusAreaDirty_) {
+            auto actions = makeStatusAreaActions(activeIC_);
+            auto status = makeInputMethodStatus(activeIC_);
+            if (statusAreaChanged(actions, status)) {
+                transaction_.statusArea = UITransaction::StatusArea{std::move(actions), std::move(status)};
+            }
+        }
+    }
+    inputPanelDirty_ = false;
+    statusAreaDirty_ = false;
+    if (transaction_.empty()) {
+        frameScheduler_.cancel();
+        return;
+    }
+    uiTransactionCallback(transaction_);
+    transaction_.clear();
+    frameScheduler_.pushed(now(CLOCK_MONOTONIC));
+}
+
 void AndroidFrontend::setCommitStringCallback(const CommitStringCallback &callback) {
     commitStringCallback = callback;
 }
@@ -556,6 +1049,21 @@ void AndroidFrontend::setSwitchInputMethodCallback(const SwitchInputMethodCallba
     switchInputMethodCallback = callback;
 }
 
+void AndroidFrontend::setCandidateBufferCallback(const CandidateBufferCallback &callback) {
+    candidateBufferCallback = callback;
+    candidateBufferEnabled_ = true;
+}
+
+void AndroidFrontend::setPagedCandidateBufferCallback(const PagedCandidateBufferCallback &callback) {
+    pagedCandidateBufferCallback = callback;
+    candidateBufferEnabled_ = true;
+}
+
+void AndroidFrontend::setUITransactionCallback(const UITransactionCallback &callback) {
+    uiTransactionCallback = callback;
+    transactionEnabled_ = true;
+}
+
 InputMethodStatus AndroidFrontend::makeInputMethodStatus(InputContext *ic) {
     auto *entry = instance_->inputMethodEntry(ic);
     auto *engine = instance_->inputMethodEngine(ic);
@@ -574,6 +1082,34 @@ std::vector<ActionEntity> AndroidFrontend::makeStatusAreaActions(fcitx::InputCon
     return actions;
 }
 
+bool AndroidFrontend::statusAreaChanged(const std::vector<ActionEntity> &actions, const InputMethodStatus &status) {
+    statusAreaStats_.flushes++;
+    Digest digest;
+    digest.add(static_cast<uint64_t>(actions.size()));
+    for (const auto &a: actions) {
+        a.addTo(digest);
+    }
+    status.addTo(digest);
+    if (digest.value() == statusAreaDigest_) {
+        statusAreaStats_.suppressed++;
+        return false;
+    }
+    statusAreaDigest_ = digest.value();
+    return true;
+}
+
+std::vector<ActionEntity> AndroidFrontend::statusAreaMenu(int id) {
+    if (!activeIC_) return {};
+    auto *action = instance_->userInterfaceManager().lookupActionById(id);
+    if (!action) return {};
+    statusAreaStats_.menus++;
+    return ActionEntity::menuOf(action, activeIC_);
+}
+
+StatusAreaStats AndroidFrontend::statusAreaStats() {
+    return statusAreaStats_;
+}
+
 class AndroidFrontendFactory : public AddonFactory {
 public:
     AddonInstance *create(AddonManager *manager) override {
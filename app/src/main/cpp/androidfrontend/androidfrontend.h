@@ -6,11 +6,18 @@
 #ifndef FCITX5_ANDROID_ANDROIDFRONTEND_H
 #define FCITX5_ANDROID_ANDROIDFRONTEND_H
 
+#include <chrono>
+
 #include <fcitx/instance.h>
 #include <fcitx/addoninstance.h>
+#include <fcitx/candidatelist.h>
+#include <fcitx-utils/event.h>
 #include <fcitx-utils/i18n.h>
 
 #include "androidfrontend_public.h"
+#include "../candidate-cursor.h"
+#include "framescheduler.h"
+#include "icsnapshot.h"
 #include "inputcontextcache.h"
 
 namespace fcitx {
@@ -29,6 +36,16 @@ public:
     void updateInputPanel(const Text &preedit, const Text &auxUp, const Text &auxDown, const std::vector<CandidateActionEntity> &tabs);
     void releaseInputContext(int uid);
     void updatePagedCandidate(const PagedCandidateEntity &paged);
+    [[nodiscard]] bool candidateBufferEnabled() const { return candidateBufferEnabled_ || transactionEnabled_; }
+    CandidateBuffer &candidateBuffer() { return transactionEnabled_ ? transaction_.candidateBuffer : candidateBuffer_; }
+    void updateCandidateBuffer(int total);
+    void updatePagedCandidateBuffer(int cursorIndex, CandidateLayoutHint layoutHint, bool hasPrev, bool hasNext);
+    // bulk candidates are pushed as delta against the previous push within transactions
+    [[nodiscard]] bool candidateDeltaEnabled() const { return transactionEnabled_; }
+    // generation of the bulk candidate list the client will have, 0 if a delta is not possible
+    [[nodiscard]] uint32_t candidateDeltaBase() const;
+    // content is in candidateBuffer(); empty delta means full push; returns generation of this push
+    uint32_t updateCandidateDelta(int total, std::vector<int32_t> delta);
 
     void keyEvent(const Key &key, bool isRelease, int timestamp);
     void forwardKey(const Key &key, bool isRelease);
@@ -42,6 +59,18 @@ public:
     [[nodiscard]] InputContext *activeInputContext() const;
     void setCapabilityFlags(uint64_t flag);
     std::vector<CandidateEntity> getCandidates(int offset, int limit);
+    // returns generation of the cursor, 0 if there is no candidate list
+    uint32_t openCandidateCursor();
+    // returns false if the list of `generation` has been replaced
+    bool readCandidates(uint32_t generation, int offset, int limit, std::vector<CandidateEntity> &candidates);
+    [[nodiscard]] int candidateWindowSize() const { return candidateWindowSize_; }
+    void setCandidateWindowSize(int size);
+    // cursor starts on `list` with `first` pushed, the next window is left to prefetchCandidates
+    void primeCandidateCursor(const std::shared_ptr<CandidateList> &list, int total, const std::vector<CandidateEntity> &first);
+    // convert pending candidate window ahead of time, called when the event loop is idle
+    void prefetchCandidates();
+    // whether prefetchCandidates has a window to fetch
+    bool candidatePrefetchPending();
     std::vector<CandidateActionEntity> getCandidateActions(int idx);
     void triggerCandidateAction(int idx, int actionIdx);
     void triggerTabAction(int idx);
@@ -50,6 +79,24 @@ public:
     void setCandidatePagingMode(int mode);
     void offsetCandidatePage(int delta);
     void triggerCandidateListTabAction(int id);
+    void flushUITransaction();
+    void resyncCandidates();
+    void setInputContextCacheCapacity(int capacity);
+    InputContextCacheStats inputContextCacheStats();
+    // filtered candidate strings are memoized per input context, counters are shared
+    OutputFilterCacheStats &outputFilterCounters() { return outputFilterCacheStats_; }
+    // changes when cached filter results must be dropped for reasons not visible to input contexts
+    [[nodiscard]] uint32_t outputFilterEpoch() const { return outputFilterEpoch_; }
+    void resetOutputFilterCache();
+    OutputFilterCacheStats outputFilterCacheStats();
+    // minimum interval of UI pushes while keys arrive faster than that, 0 to push every change
+    void setUIFrameBudget(int micros);
+    FrameSchedulerStats uiFrameStats();
+    // owned here since native-lib can't share statics with this library
+    KeystrokeTracer *keystrokeTracer() { return &keystrokeTracer_; }
+    // entries of the menu of status area action `id`, which are not sent with status area
+    std::vector<ActionEntity> statusAreaMenu(int id);
+    StatusAreaStats statusAreaStats();
     void setCandidateListCallback(const CandidateListCallback &callback);
     void setCommitStringCallback(const CommitStringCallback &callback);
     void setPreeditCallback(const ClientPreeditCallback &callback);
@@ -61,6 +108,9 @@ public:
     void setToastCallback(const ToastCallback &callback);
     void setPagedCandidateCallback(const PagedCandidateCallback &callback);
     void setSwitchInputMethodCallback(const SwitchInputMethodCallback &callback);
+    void setCandidateBufferCallback(const CandidateBufferCallback &callback);
+    void setPagedCandidateBufferCallback(const PagedCandidateBufferCallback &callback);
+    void setUITransactionCallback(const UITransactionCallback &callback);
 
 private:
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, keyEvent);
@@ -74,6 +124,11 @@ private:
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, deactivateInputContext);
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setCapabilityFlags);
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, getCandidates);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, openCandidateCursor);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, readCandidates);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setCandidateWindowSize);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, prefetchCandidates);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, candidatePrefetchPending);
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, getCandidateActions);
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, triggerCandidateAction);
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, triggerTabAction);
@@ -92,13 +147,59 @@ private:
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setToastCallback);
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setPagedCandidateCallback);
     FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setSwitchInputMethodCallback);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setCandidateBufferCallback);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setPagedCandidateBufferCallback);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setUITransactionCallback);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, flushUITransaction);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, resyncCandidates);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setInputContextCacheCapacity);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, inputContextCacheStats);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, resetOutputFilterCache);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, outputFilterCacheStats);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, setUIFrameBudget);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, uiFrameStats);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, keystrokeTracer);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, statusAreaMenu);
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidFrontend, statusAreaStats);
 
     Instance *instance_;
     FocusGroup focusGroup_;
     AndroidInputContext *activeIC_;
     InputContextCache icCache_;
+    // states of cached input contexts, restored when they are created again after restart
+    InputContextSnapshot icSnapshot_;
+    // a new input context is timed from activation until it gets focus
+    enum class PendingActivation { None, Cold, Warm } pendingActivation_;
+    std::chrono::steady_clock::time_point activationStart_;
+    InputContextActivationStats activationStats_;
     std::vector<std::unique_ptr<HandlerTableEntry<EventHandler>>> eventHandlers_;
     int pagingMode_;
+    // candidates are pushed as CandidateBuffer once its callbacks are installed
+    bool candidateBufferEnabled_;
+    CandidateBuffer candidateBuffer_;
+    // UI changes are collected into transaction_ once its callback is installed
+    bool transactionEnabled_;
+    UITransaction transaction_;
+    // input panel and status area are read from activeIC_ when flushing the transaction
+    bool inputPanelDirty_;
+    bool statusAreaDirty_;
+    uint32_t candidateGenerationCounter_;
+    // generation of the bulk candidate list sent to client, 0 if unknown
+    uint32_t candidateGeneration_;
+    // windowed reads of the expanded candidate list
+    CandidateCursor<CandidateEntity> candidateCursor_;
+    std::weak_ptr<CandidateList> candidateCursorList_;
+    // bulk candidates in the first push, and in each prefetch after it
+    int candidateWindowSize_;
+    uint32_t outputFilterEpoch_;
+    OutputFilterCacheStats outputFilterCacheStats_;
+    // paces transactions carrying UI state, frameTimer_ pushes held state at the deadline
+    FrameScheduler frameScheduler_;
+    std::unique_ptr<EventSourceTime> frameTimer_;
+    KeystrokeTracer keystrokeTracer_;
+    // digest of the status area last sent to JVM, flushes that wouldn't change it are dropped
+    uint64_t statusAreaDigest_;
+    StatusAreaStats statusAreaStats_;
 
     CandidateListCallback candidateListCallback = [](const std::vector<CandidateEntity> &, const int) {};
     CommitStringCallback commitStringCallback = [](const std::string &, const int) {};
@@ -111,9 +212,20 @@ private:
     ToastCallback toastCallback = [](const std::string &) {};
     PagedCandidateCallback pagedCandidateCallback = [](const PagedCandidateEntity &) {};
     SwitchInputMethodCallback switchInputMethodCallback = [](const int, const std::string &) {};
+    CandidateBufferCallback candidateBufferCallback = [](const CandidateBuffer &, const int) {};
+    PagedCandidateBufferCallback pagedCandidateBufferCallback = [](const CandidateBuffer &, const int, const CandidateLayoutHint, const bool, const bool) {};
+    UITransactionCallback uiTransactionCallback = [](const UITransaction &) {};
 
+    [[nodiscard]] bool candidateCursorListAlive() const;
+    void markFrameDirty();
+    // push transaction_ now, regardless of frame pacing
+    void deliverUITransaction();
+    bool restoreInputContext(AndroidInputContext *ic);
+    void saveInputContextState(AndroidInputContext *ic);
     InputMethodStatus makeInputMethodStatus(InputContext* ic);
     std::vector<ActionEntity> makeStatusAreaActions(InputContext* ic);
+    // false if JVM already has this status area
+    bool statusAreaChanged(const std::vector<ActionEntity> &actions, const InputMethodStatus &status);
 };
 } // namespace fcitx
 
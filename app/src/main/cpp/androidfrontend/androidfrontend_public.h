@@ -11,6 +11,35 @@
 #include <fcitx-utils/key.h>
 
 #include "../helper-types.h"
+#include "framescheduler.h"
+#include "keystroketracer.h"
+#include "outputfiltercache.h"
+#include "slablrucache.h"
+
+struct InputContextActivationStats {
+    // input contexts created from scratch, and total nanoseconds from activation to focus
+    uint64_t cold = 0;
+    uint64_t coldNanos = 0;
+    // input contexts created with state restored from snapshot
+    uint64_t warm = 0;
+    uint64_t warmNanos = 0;
+};
+
+struct InputContextCacheStats {
+    SlabLRUCacheStats counters;
+    size_t size;
+    size_t capacity;
+    InputContextActivationStats activations;
+};
+
+struct StatusAreaStats {
+    // status area flushes of the active input context
+    uint64_t flushes = 0;
+    // flushes not sent to JVM because nothing it shows has changed
+    uint64_t suppressed = 0;
+    // submenus converted on request
+    uint64_t menus = 0;
+};
 
 typedef std::function<void(const std::vector<CandidateEntity> &, const int)> CandidateListCallback;
 typedef std::function<void(const std::string &, const int)> CommitStringCallback;
@@ -23,6 +52,9 @@ typedef std::function<void(const int, const int)> DeleteSurroundingCallback;
 typedef std::function<void(const std::string &)> ToastCallback;
 typedef std::function<void(const PagedCandidateEntity &)> PagedCandidateCallback;
 typedef std::function<void(const int, const std::string &)> SwitchInputMethodCallback;
+typedef std::function<void(const CandidateBuffer &, const int)> CandidateBufferCallback;
+typedef std::function<void(const CandidateBuffer &, const int, const fcitx::CandidateLayoutHint, const bool, const bool)> PagedCandidateBufferCallback;
+typedef std::function<void(const UITransaction &)> UITransactionCallback;
 
 FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, keyEvent,
                              void(const fcitx::Key &, bool isRelease, const int timestamp))
@@ -57,6 +89,16 @@ FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setCapabilityFlags,
 FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, getCandidates,
                              std::vector<CandidateEntity>(const int, const int))
 
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, openCandidateCursor,
+                             uint32_t())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, readCandidates,
+                             bool(const uint32_t, const int, const int, std::vector<CandidateEntity> &))
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setCandidateWindowSize,
+                             void(const int))
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, prefetchCandidates,
+                             void())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, candidatePrefetchPending,
+                             bool())
 FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, getCandidateActions,
                              std::vector<CandidateActionEntity>(const int))
 
@@ -111,4 +153,37 @@ FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setPagedCandidateCallback,
 FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setSwitchInputMethodCallback,
                              void(const SwitchInputMethodCallback &))
 
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setCandidateBufferCallback,
+                             void(const CandidateBufferCallback &))
+
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setPagedCandidateBufferCallback,
+                             void(const PagedCandidateBufferCallback &))
+
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setUITransactionCallback,
+                             void(const UITransactionCallback &))
+
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, flushUITransaction,
+                             void())
+
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, resyncCandidates,
+                             void())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setInputContextCacheCapacity,
+                             void(const int))
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, inputContextCacheStats,
+                             InputContextCacheStats())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, resetOutputFilterCache,
+                             void())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, outputFilterCacheStats,
+                             OutputFilterCacheStats())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, setUIFrameBudget,
+                             void(const int))
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, uiFrameStats,
+                             FrameSchedulerStats())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, keystrokeTracer,
+                             KeystrokeTracer *())
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, statusAreaMenu,
+                             std::vector<ActionEntity>(const int))
+FCITX_ADDON_DECLARE_FUNCTION(AndroidFrontend, statusAreaStats,
+                             StatusAreaStats())
+
 #endif // FCITX5_ANDROID_ANDROIDFRONTEND_PUBLIC_H
@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_FRAMESCHEDULER_H
+#define FCITX5_ANDROID_FRAMESCHEDULER_H
+
+#include <cstdint>
+
+struct FrameSchedulerStats {
+    // UI states pushed to client
+    uint64_t delivered = 0;
+    // UI states replaced by a newer one before they were pushed
+    uint64_t dropped = 0;
+    // pushes made before the frame deadline because of a commit or other text change
+    uint64_t immediate = 0;
+};
+
+/**
+ * Paces pushes of UI state to at most one per `budget`.
+ *
+ * The first change after a quiet period is pushed right away; changes arriving within `budget`
+ * of the last push are held until that time, and only the latest state is pushed then. So a
+ * change is never held for longer than `budget`, and bursts of keys (hardware keyboards,
+ * auto repeat) produce one push per frame instead of one per key.
+ *
+ * Times are in microseconds of any monotonic clock, the owner passes them in; a timer should
+ * be armed at deadline() when markDirty() asks for it.
+ */
+class FrameScheduler {
+public:
+    explicit FrameScheduler(uint64_t budget = 16000) : budget_(budget) {}
+
+    [[nodiscard]] uint64_t budget() const { return budget_; }
+
+    // 0 disables pacing
+    void setBudget(uint64_t budget) { budget_ = budget; }
+
+    [[nodiscard]] bool pending() const { return pending_; }
+
+    // when held state must be pushed at the latest
+    [[nodiscard]] uint64_t deadline() const { return deadline_; }
+
+    /**
+     * UI state changed at `now`
+     * @return true if it's held and a timer has to be armed at deadline()
+     */
+    bool markDirty(uint64_t now) {
+        changed_ = true;
+        if (pending_) {
+            return false;
+        }
+        pending_ = true;
+        frames_ = 0;
+        deadline_ = delivered_ ? lastPush_ + budget_ : now;
+        return deadline_ > now;
+    }
+
+    /**
+     * A state may be complete (end of a key event or event loop iteration)
+     * @param urgent state includes commits or other changes to text, which are never held
+     * @return true if it should be pushed now, then pushed() or cancel() must be called
+     */
+    bool shouldPush(uint64_t now, bool urgent) {
+        completeFrame();
+        if (urgent && pending_ && now < deadline_) {
+            stats_.immediate++;
+        }
+        return urgent || !pending_ || now >= deadline_;
+    }
+
+    // state was pushed at `now`
+    void pushed(uint64_t now) {
+        lastPush_ = now;
+        delivered_ = true;
+        if (!pending_) {
+            return;
+        }
+        // pushed by timer, or before the end of the iteration
+        completeFrame();
+        stats_.delivered++;
+        stats_.dropped += frames_ - 1;
+        pending_ = false;
+        frames_ = 0;
+    }
+
+    // held state turned out to be empty, nothing was pushed
+    void cancel() {
+        pending_ = false;
+        changed_ = false;
+        frames_ = 0;
+    }
+
+    [[nodiscard]] const FrameSchedulerStats &stats() const { return stats_; }
+
+    void resetStats() { stats_ = {}; }
+
+private:
+    uint64_t budget_;
+    bool pending_ = false;
+    // whether lastPush_ is set
+    bool delivered_ = false;
+    uint64_t lastPush_ = 0;
+    uint64_t deadline_ = 0;
+    // completed states since last push, all but the last one are dropped
+    uint64_t frames_ = 0;
+    // state changed since it was last completed
+    bool changed_ = false;
+    FrameSchedulerStats stats_;
+
+    void completeFrame() {
+        if (changed_) {
+            frames_++;
+            changed_ = false;
+        }
+    }
+};
+
+#endif //FCITX5_ANDROID_FRAMESCHEDULER_H
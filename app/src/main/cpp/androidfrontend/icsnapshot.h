@@ -0,0 +1,403 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_ICSNAPSHOT_H
+#define FCITX5_ANDROID_ICSNAPSHOT_H
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct InputContextState {
+    int uid = 0;
+    std::string pkgName;
+    std::string inputMethod;
+    uint64_t capabilityFlags = 0;
+
+    bool operator==(const InputContextState &other) const {
+        return uid == other.uid && pkgName == other.pkgName &&
+               inputMethod == other.inputMethod && capabilityFlags == other.capabilityFlags;
+    }
+};
+
+/**
+ * On-disk copy of what InputContextCache holds, so input contexts can be restored after the
+ * process gets killed.
+ *
+ * The file is a log of records appended as things change; replaying it gives the states and
+ * their LRU order. It is rewritten with only live states when it has grown well beyond them,
+ * or when its tail is torn. Nothing is read until the first load().
+ *
+ * States live in memory on the caller's thread. Records are only queued there, a thread of its
+ * own appends them and does the rewrites, so activating an input context never waits for a
+ * write or fsync; what is still queued when the process gets killed is lost.
+ *
+ * Format: "FXIC" and version byte, then records of
+ *   'P' uid:i32 capabilityFlags:u64 pkgName:(u16, bytes) inputMethod:(u16, bytes)
+ *   'T' uid:i32   (most recently used)
+ *   'E' uid:i32   (removed)
+ * in native byte order.
+ */
+class InputContextSnapshot {
+public:
+    explicit InputContextSnapshot(std::string path, size_t maxEntries = 80)
+            : path_(std::move(path)), maxEntries_(maxEntries), thread_([this] { run(); }) {}
+
+    InputContextSnapshot(const InputContextSnapshot &) = delete;
+
+    InputContextSnapshot &operator=(const InputContextSnapshot &) = delete;
+
+    // writes what is queued before returning
+    ~InputContextSnapshot() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+        closeLog();
+    }
+
+    [[nodiscard]] bool loaded() const { return loaded_; }
+
+    // read the file once; later calls do nothing
+    void load() {
+        if (loaded_) return;
+        loaded_ = true;
+        std::string data;
+        if (!readFile(data)) {
+            compact();
+            return;
+        }
+        const bool clean = replay(data);
+        trim();
+        if (!clean || records_ > CompactFactor * (states_.size() + 1)) {
+            compact();
+        }
+    }
+
+    [[nodiscard]] const InputContextState *find(int uid) const {
+        auto it = index_.find(uid);
+        return it == index_.end() ? nullptr : &*it->second;
+    }
+
+    // add or update a state as most recently used
+    void put(const InputContextState &state) {
+        load();
+        auto it = index_.find(state.uid);
+        if (it != index_.end()) {
+            if (*it->second == state) {
+                touch(state.uid);
+                return;
+            }
+            states_.erase(it->second);
+        }
+        states_.push_front(state);
+        index_[state.uid] = states_.begin();
+        std::string record;
+        appendPut(record, state);
+        append(record);
+        trim();
+    }
+
+    void touch(int uid) {
+        load();
+        auto it = index_.find(uid);
+        if (it == index_.end() || it->second == states_.begin()) return;
+        states_.splice(states_.begin(), states_, it->second);
+        std::string record;
+        appendUid(record, Touch, uid);
+        append(record);
+    }
+
+    void erase(int uid) {
+        load();
+        auto it = index_.find(uid);
+        if (it == index_.end()) return;
+        states_.erase(it->second);
+        index_.erase(it);
+        std::string record;
+        appendUid(record, Erase, uid);
+        append(record);
+    }
+
+    void setMaxEntries(size_t maxEntries) {
+        maxEntries_ = maxEntries;
+        if (loaded_) trim();
+    }
+
+    // most recently used first
+    [[nodiscard]] std::vector<InputContextState> states() const {
+        return {states_.begin(), states_.end()};
+    }
+
+    [[nodiscard]] size_t size() const { return states_.size(); }
+
+    // queue a rewrite of the file with live states only; records queued before it are dropped
+    void compact() {
+        std::string data(Magic, sizeof(Magic));
+        // oldest first, so that replaying leaves the most recent one at front
+        for (auto it = states_.rbegin(); it != states_.rend(); ++it) {
+            appendPut(data, *it);
+        }
+        records_ = states_.size();
+        {
+            std::lock_guard lock(mutex_);
+            queued_ = std::move(data);
+            rewrite_ = true;
+            rewriteFailed_ = false;
+        }
+        cv_.notify_one();
+    }
+
+    // wait until everything queued is written
+    void sync() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [this] { return queued_.empty() && !writing_; });
+    }
+
+private:
+    static constexpr char Magic[] = {'F', 'X', 'I', 'C', 1};
+    static constexpr char Put = 'P';
+    static constexpr char Touch = 'T';
+    static constexpr char Erase = 'E';
+    // rewrite when the log has this many records per live state
+    static constexpr size_t CompactFactor = 8;
+
+    std::string path_;
+    size_t maxEntries_;
+    bool loaded_ = false;
+    std::list<InputContextState> states_;
+    std::unordered_map<int, std::list<InputContextState>::iterator> index_;
+    // records in the file once the queue is written
+    size_t records_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // notified when the queue is written
+    std::condition_variable idle_;
+    // records to append, or the whole file if rewrite_
+    std::string queued_;
+    bool rewrite_ = false;
+    // appending failed and the log may be torn or gone, the next record asks for a rewrite
+    bool rewriteFailed_ = false;
+    bool writing_ = false;
+    bool stopping_ = false;
+    // writer thread only
+    int fd_ = -1;
+    // last member, started after the others are initialized
+    std::thread thread_;
+
+    // drop least recently used states beyond the limit; the file catches up on next compact()
+    void trim() {
+        while (states_.size() > maxEntries_) {
+            index_.erase(states_.back().uid);
+            states_.pop_back();
+        }
+    }
+
+    void append(const std::string &record) {
+        bool failed;
+        {
+            std::lock_guard lock(mutex_);
+            failed = rewriteFailed_;
+            if (!failed) queued_ += record;
+        }
+        if (failed || ++records_ > CompactFactor * (states_.size() + 1)) {
+            compact();
+            return;
+        }
+        cv_.notify_one();
+    }
+
+    void run() {
+        std::unique_lock lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return stopping_ || !queued_.empty(); });
+            if (queued_.empty()) {
+                return;
+            }
+            auto data = std::move(queued_);
+            queued_.clear();
+            const bool rewrite = rewrite_;
+            rewrite_ = false;
+            writing_ = true;
+            lock.unlock();
+            const bool ok = rewrite ? writeFile(data) : appendLog(data);
+            lock.lock();
+            writing_ = false;
+            // a newer rewrite replaces whatever was left of the log
+            if (!ok && !rewrite_) {
+                rewriteFailed_ = true;
+            }
+            if (queued_.empty()) {
+                idle_.notify_all();
+            }
+        }
+    }
+
+    // writer thread
+    bool appendLog(const std::string &records) {
+        if (fd_ < 0) {
+            fd_ = ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+            // file is gone, next record starts a new one
+            if (fd_ < 0) return false;
+        }
+        if (!writeAll(fd_, records)) {
+            // a partial record would end up in the middle of the log
+            closeLog();
+            return false;
+        }
+        return true;
+    }
+
+    // writer thread; through a temporary file and rename
+    bool writeFile(const std::string &data) {
+        closeLog();
+        const auto tmp = path_ + ".tmp";
+        const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) return false;
+        const bool ok = writeAll(fd, data) && ::fsync(fd) == 0;
+        ::close(fd);
+        if (!ok || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        // the rename itself is only durable once the directory is
+        const auto slash = path_.rfind('/');
+        const auto dir = slash == std::string::npos ? std::string(".") : path_.substr(0, slash + 1);
+        const int dirFd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+        return true;
+    }
+
+    void closeLog() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    bool readFile(std::string &data) const {
+        const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+            data.append(buf, static_cast<size_t>(n));
+        }
+        ::close(fd);
+        return n == 0 && data.size() >= sizeof(Magic) && std::memcmp(data.data(), Magic, sizeof(Magic)) == 0;
+    }
+
+    /**
+     * Apply records in `data`
+     * @return false if it ends with a torn record
+     */
+    bool replay(const std::string &data) {
+        size_t pos = sizeof(Magic);
+        while (pos < data.size()) {
+            const char type = data[pos++];
+            int32_t uid;
+            if (!read(data, pos, uid)) return false;
+            records_++;
+            if (type == Touch || type == Erase) {
+                auto it = index_.find(uid);
+                if (it == index_.end()) continue;
+                if (type == Touch) {
+                    states_.splice(states_.begin(), states_, it->second);
+                } else {
+                    states_.erase(it->second);
+                    index_.erase(it);
+                }
+                continue;
+            }
+            if (type != Put) return false;
+            InputContextState state;
+            state.uid = uid;
+            if (!read(data, pos, state.capabilityFlags) ||
+                !readString(data, pos, state.pkgName) ||
+                !readString(data, pos, state.inputMethod)) {
+                return false;
+            }
+            auto it = index_.find(uid);
+            if (it != index_.end()) {
+                states_.erase(it->second);
+            }
+            states_.push_front(std::move(state));
+            index_[uid] = states_.begin();
+        }
+        return true;
+    }
+
+    template<typename T>
+    static bool read(const std::string &data, size_t &pos, T &value) {
+        if (data.size() - pos < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    static bool readString(const std::string &data, size_t &pos, std::string &value) {
+        uint16_t length;
+        if (!read(data, pos, length) || data.size() - pos < length) return false;
+        value.assign(data, pos, length);
+        pos += length;
+        return true;
+    }
+
+    template<typename T>
+    static void write(std::string &out, T value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static void writeString(std::string &out, const std::string &value) {
+        const auto length = static_cast<uint16_t>(std::min<size_t>(value.size(), UINT16_MAX));
+        write(out, length);
+        out.append(value, 0, length);
+    }
+
+    static void appendUid(std::string &out, char type, int uid) {
+        out.push_back(type);
+        write(out, static_cast<int32_t>(uid));
+    }
+
+    static void appendPut(std::string &out, const InputContextState &state) {
+        appendUid(out, Put, state.uid);
+        write(out, state.capabilityFlags);
+        writeString(out, state.pkgName);
+        writeString(out, state.inputMethod);
+    }
+
+    static bool writeAll(int fd, const std::string &data) {
+        size_t written = 0;
+        while (written < data.size()) {
+            const auto n = ::write(fd, data.data() + written, data.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+};
+
+#endif //FCITX5_ANDROID_ICSNAPSHOT_H
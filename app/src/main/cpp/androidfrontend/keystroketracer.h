@@ -0,0 +1,300 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_KEYSTROKETRACER_H
+#define FCITX5_ANDROID_KEYSTROKETRACER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+enum class KeystrokeStage : uint8_t {
+    // sendKey JNI entry until it returns
+    Jni = 0,
+    // AndroidFrontend::keyEvent
+    FrontendKeyEvent,
+    // InputContext::keyEvent, through the engine
+    Engine,
+    // InputContextFlushUI handling, or building the UI transaction
+    FlushUI,
+    // candidate conversion in updateCandidatesBulk
+    Candidates,
+    // UI callback into JVM
+    Callback,
+    // JNI entry of a key press until the end of the next UI callback
+    Total,
+    Count
+};
+
+constexpr size_t KeystrokeStageCount = static_cast<size_t>(KeystrokeStage::Count);
+
+struct StageLatency {
+    uint64_t count = 0;
+    // nanoseconds, with at most 1/16 relative error
+    uint64_t p50 = 0;
+    uint64_t p95 = 0;
+    uint64_t p99 = 0;
+};
+
+struct KeystrokeLatency {
+    std::array<StageLatency, KeystrokeStageCount> stages;
+    // spans lost because a thread recorded faster than they were collected
+    uint64_t dropped = 0;
+};
+
+/**
+ * Log-linear histogram of nanoseconds: 16 buckets per power of 2
+ */
+class LatencyHistogram {
+public:
+    void add(uint64_t nanos) {
+        buckets_[indexOf(nanos)]++;
+        count_++;
+    }
+
+    [[nodiscard]] uint64_t count() const { return count_; }
+
+    // value at `p` in [0, 1]; the middle of the bucket holding it
+    [[nodiscard]] uint64_t percentile(double p) const {
+        if (count_ == 0) return 0;
+        auto rank = static_cast<uint64_t>(p * static_cast<double>(count_ - 1)) + 1;
+        for (size_t i = 0; i < BucketCount; i++) {
+            if (buckets_[i] >= rank) {
+                return lowerBound(i) + (width(i) - 1) / 2;
+            }
+            rank -= buckets_[i];
+        }
+        return lowerBound(BucketCount - 1);
+    }
+
+    void clear() {
+        buckets_.fill(0);
+        count_ = 0;
+    }
+
+private:
+    static constexpr int SubBits = 4;
+    static constexpr uint64_t SubCount = 1 << SubBits;
+    // values from 2^MaxExponent ns (about 18 minutes) go to the last bucket
+    static constexpr int MaxExponent = 40;
+    static constexpr size_t BucketCount = (MaxExponent - SubBits + 1) * SubCount;
+
+    std::array<uint64_t, BucketCount> buckets_{};
+    uint64_t count_ = 0;
+
+    static size_t indexOf(uint64_t v) {
+        if (v < SubCount) return static_cast<size_t>(v);
+        const int e = 63 - __builtin_clzll(v);
+        if (e >= MaxExponent) return BucketCount - 1;
+        // values in [2^e, 2^(e+1)) are split into SubCount buckets
+        return static_cast<size_t>((e - SubBits + 1) * SubCount + ((v >> (e - SubBits)) & (SubCount - 1)));
+    }
+
+    static uint64_t lowerBound(size_t i) {
+        if (i < SubCount) return i;
+        const int e = static_cast<int>(i / SubCount) + SubBits - 1;
+        return (uint64_t(1) << e) + (i % SubCount) * (uint64_t(1) << (e - SubBits));
+    }
+
+    static uint64_t width(size_t i) {
+        if (i < SubCount) return 1;
+        const int e = static_cast<int>(i / SubCount) + SubBits - 1;
+        return uint64_t(1) << (e - SubBits);
+    }
+};
+
+/**
+ * Records how long each stage of a keystroke takes.
+ *
+ * Spans are tagged with the timestamp of the key being processed, and pushed to a ring owned
+ * by the recording thread, so recording takes no lock; latency() collects all rings into
+ * per-stage histograms. Tracing is off by default and costs one relaxed load per span then.
+ *
+ * native-lib and androidfrontend are separate libraries, so the tracer is owned by
+ * AndroidFrontend and native-lib records through the pointer it exports.
+ */
+class KeystrokeTracer {
+public:
+    struct Span {
+        int32_t id;
+        KeystrokeStage stage;
+        uint64_t nanos;
+    };
+
+    /**
+     * Single producer single consumer ring of spans
+     */
+    class Ring {
+    public:
+        static constexpr uint64_t Capacity = 1024;
+
+        bool push(const Span &span) {
+            const auto head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) >= Capacity) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            spans_[head % Capacity] = span;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        template<typename F>
+        void drain(F &&f) {
+            auto tail = tail_.load(std::memory_order_relaxed);
+            const auto head = head_.load(std::memory_order_acquire);
+            for (; tail != head; tail++) {
+                f(spans_[tail % Capacity]);
+            }
+            tail_.store(tail, std::memory_order_release);
+        }
+
+        uint64_t takeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+        // only touched by the owning thread
+        int32_t currentId = 0;
+        uint64_t keystrokeBegin = 0;
+        uint32_t keystrokeSession = 0;
+
+    private:
+        std::array<Span, Capacity> spans_{};
+        std::atomic<uint64_t> head_{0};
+        std::atomic<uint64_t> tail_{0};
+        std::atomic<uint64_t> dropped_{0};
+    };
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    KeystrokeTracer() : token_(now()) {}
+
+    KeystrokeTracer(const KeystrokeTracer &) = delete;
+
+    KeystrokeTracer &operator=(const KeystrokeTracer &) = delete;
+
+    [[nodiscard]] bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void setEnabled(bool enabled) {
+        if (enabled && !this->enabled()) {
+            // keystrokes begun before tracing was last turned off are never completed
+            session_.fetch_add(1, std::memory_order_relaxed);
+        }
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    // a key press with `id` enters at `begin`; it's the key later spans on this thread belong to
+    void beginKeystroke(int32_t id, uint64_t begin) {
+        auto &r = ring();
+        r.currentId = id;
+        r.keystrokeBegin = begin;
+        r.keystrokeSession = session_.load(std::memory_order_relaxed);
+    }
+
+    // UI produced by the current key has reached JVM
+    void endKeystroke(uint64_t end) {
+        auto &r = ring();
+        if (r.keystrokeBegin == 0) return;
+        if (r.keystrokeSession == session_.load(std::memory_order_relaxed)) {
+            r.push({r.currentId, KeystrokeStage::Total, end - r.keystrokeBegin});
+        }
+        r.keystrokeBegin = 0;
+    }
+
+    void record(KeystrokeStage stage, uint64_t begin, uint64_t end) {
+        auto &r = ring();
+        r.push({r.currentId, stage, end - begin});
+    }
+
+    KeystrokeLatency latency() {
+        std::lock_guard lock(mutex_);
+        collect();
+        KeystrokeLatency result;
+        for (size_t i = 0; i < KeystrokeStageCount; i++) {
+            const auto &h = histograms_[i];
+            result.stages[i] = {h.count(), h.percentile(0.5), h.percentile(0.95), h.percentile(0.99)};
+        }
+        result.dropped = dropped_;
+        return result;
+    }
+
+    void reset() {
+        std::lock_guard lock(mutex_);
+        collect();
+        for (auto &h: histograms_) h.clear();
+        dropped_ = 0;
+    }
+
+private:
+    // tells this tracer from a previous one at the same address in the per thread cache
+    const uint64_t token_;
+    std::atomic<bool> enabled_{false};
+    // times tracing has been turned on
+    std::atomic<uint32_t> session_{0};
+    std::mutex mutex_;
+    std::unordered_map<std::thread::id, std::unique_ptr<Ring>> rings_;
+    std::array<LatencyHistogram, KeystrokeStageCount> histograms_;
+    uint64_t dropped_ = 0;
+
+    Ring &ring() {
+        struct Cache {
+            const KeystrokeTracer *owner = nullptr;
+            uint64_t token = 0;
+            Ring *ring = nullptr;
+        };
+        static thread_local Cache cache;
+        if (cache.owner != this || cache.token != token_) {
+            std::lock_guard lock(mutex_);
+            auto &r = rings_[std::this_thread::get_id()];
+            if (!r) r = std::make_unique<Ring>();
+            cache = {this, token_, r.get()};
+        }
+        return *cache.ring;
+    }
+
+    // mutex_ must be held
+    void collect() {
+        for (auto &[_, r]: rings_) {
+            r->drain([this](const Span &span) {
+                histograms_[static_cast<size_t>(span.stage)].add(span.nanos);
+            });
+            dropped_ += r->takeDropped();
+        }
+    }
+};
+
+/**
+ * Records the enclosing scope as `stage` of the current keystroke, if tracing is enabled
+ */
+class KeystrokeSpan {
+public:
+    KeystrokeSpan(KeystrokeTracer *tracer, KeystrokeStage stage)
+            : tracer_(tracer && tracer->enabled() ? tracer : nullptr),
+              stage_(stage),
+              begin_(tracer_ ? KeystrokeTracer::now() : 0) {}
+
+    KeystrokeSpan(const KeystrokeSpan &) = delete;
+
+    KeystrokeSpan &operator=(const KeystrokeSpan &) = delete;
+
+    ~KeystrokeSpan() {
+        if (tracer_) {
+            tracer_->record(stage_, begin_, KeystrokeTracer::now());
+        }
+    }
+
+private:
+    KeystrokeTracer *tracer_;
+    KeystrokeStage stage_;
+    uint64_t begin_;
+};
+
+#endif //FCITX5_ANDROID_KEYSTROKETRACER_H
@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_OUTPUTFILTERCACHE_H
+#define FCITX5_ANDROID_OUTPUTFILTERCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+struct OutputFilterCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // entries dropped to stay within capacity
+    uint64_t evictions = 0;
+    // times the cache was emptied because the filter chain changed
+    uint64_t invalidations = 0;
+};
+
+/**
+ * Memo of output filter results, source string to filtered string.
+ *
+ * Results are only valid for the filter chain state they were computed with; the owner keeps a
+ * description of that state and calls reset() when it changes.
+ * Entries are kept in two maps of at most capacity / 2 each: when the current one is full it
+ * becomes the previous one, and the old previous one is dropped. Hits in the previous map move
+ * back to the current one, so entries seen on the last few keystrokes survive, which is close
+ * to LRU without bookkeeping on every hit.
+ *
+ * Counters go to `stats`, which may be shared by caches of several input contexts.
+ */
+class OutputFilterCache {
+public:
+    explicit OutputFilterCache(OutputFilterCacheStats &stats, size_t capacity = 512)
+            : stats_(stats), capacity_(capacity < 2 ? 1 : capacity / 2) {}
+
+    /**
+     * @param filter called as `std::string filter()` on miss
+     * @return filtered string, valid until the next call
+     */
+    template<typename Filter>
+    const std::string &get(const std::string &source, Filter &&filter) {
+        auto it = current_.find(source);
+        if (it != current_.end()) {
+            stats_.hits++;
+            return it->second;
+        }
+        auto old = previous_.find(source);
+        if (old != previous_.end()) {
+            stats_.hits++;
+            auto node = previous_.extract(old);
+            rotateIfFull();
+            return current_.insert(std::move(node)).position->second;
+        }
+        stats_.misses++;
+        auto value = filter();
+        rotateIfFull();
+        return current_.emplace(source, std::move(value)).first->second;
+    }
+
+    // filter chain changed, forget everything
+    void reset() {
+        if (current_.empty() && previous_.empty()) return;
+        current_.clear();
+        previous_.clear();
+        stats_.invalidations++;
+    }
+
+    [[nodiscard]] size_t size() const { return current_.size() + previous_.size(); }
+
+private:
+    OutputFilterCacheStats &stats_;
+    // maximum size of each map
+    size_t capacity_;
+    std::unordered_map<std::string, std::string> current_;
+    std::unordered_map<std::string, std::string> previous_;
+
+    void rotateIfFull() {
+        if (current_.size() < capacity_) return;
+        stats_.evictions += previous_.size();
+        previous_ = std::move(current_);
+        current_.clear();
+    }
+};
+
+#endif //FCITX5_ANDROID_OUTPUTFILTERCACHE_H
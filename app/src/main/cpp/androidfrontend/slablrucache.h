@@ -0,0 +1,306 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_SLABLRUCACHE_H
+#define FCITX5_ANDROID_SLABLRUCACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct SlabLRUCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t insertions = 0;
+    uint64_t evictions = 0;
+};
+
+/**
+ * LRU cache of owned objects keyed by int, without allocation after construction.
+ *
+ * Entries live in a slab of `capacity` nodes linked into the LRU order by index, and are
+ * looked up through an open addressing table (linear probing, backward shift deletion) of
+ * at least twice the capacity.
+ *
+ * Destroying a value may call back into the cache (AndroidInputContext releases itself in
+ * its destructor), so entries are always unlinked before their value is destroyed.
+ * Returned pointers stay valid until the entry is removed or setCapacity() is called.
+ */
+template<typename T>
+class SlabLRUCache {
+public:
+    using key_type = int;
+    using value_type = std::unique_ptr<T>;
+
+    explicit SlabLRUCache(size_t capacity = 80) { allocate(capacity); }
+
+    SlabLRUCache(const SlabLRUCache &) = delete;
+
+    SlabLRUCache &operator=(const SlabLRUCache &) = delete;
+
+    ~SlabLRUCache() { clear(); }
+
+    [[nodiscard]] size_t size() const { return size_; }
+
+    [[nodiscard]] size_t capacity() const { return nodes_.size(); }
+
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+    [[nodiscard]] bool contains(key_type key) const { return lookup(key) != Nil; }
+
+    /**
+     * Insert as most recently used, evicting the least recently used entry if full
+     * @return nullptr if `key` is already present
+     */
+    template<typename... Args>
+    value_type *insert(key_type key, Args &&...args) {
+        if (lookup(key) != Nil) {
+            return nullptr;
+        }
+        if (size_ >= nodes_.size()) {
+            evict();
+        }
+        const auto idx = free_;
+        auto &node = nodes_[idx];
+        free_ = node.next;
+        node.key = key;
+        node.value = value_type(std::forward<Args>(args)...);
+        pushFront(idx);
+        tableInsert(idx);
+        size_++;
+        stats_.insertions++;
+        return &node.value;
+    }
+
+    void erase(key_type key) {
+        // destroyed after the entry is gone
+        auto value = take(key);
+    }
+
+    T *release(key_type key) {
+        return take(key).release();
+    }
+
+    // find will refresh the item, so it is not const.
+    value_type *find(key_type key) {
+        const auto idx = lookup(key);
+        if (idx == Nil) {
+            stats_.misses++;
+            return nullptr;
+        }
+        stats_.hits++;
+        if (idx != head_) {
+            unlink(idx);
+            pushFront(idx);
+        }
+        return &nodes_[idx].value;
+    }
+
+    void clear() {
+        std::vector<value_type> values;
+        values.reserve(size_);
+        for (auto idx = head_; idx != Nil; idx = nodes_[idx].next) {
+            values.push_back(std::move(nodes_[idx].value));
+        }
+        reset();
+        // values are destroyed here, with the cache already empty
+    }
+
+    /**
+     * Evict least recently used entries beyond `capacity` (at least 1), then move the
+     * remaining ones into a slab of the new size
+     */
+    void setCapacity(size_t capacity) {
+        if (capacity == 0) {
+            capacity = 1;
+        }
+        if (capacity == nodes_.size()) {
+            return;
+        }
+        while (size_ > capacity) {
+            evict();
+        }
+        // most recently used first
+        std::vector<std::pair<key_type, value_type>> entries;
+        entries.reserve(size_);
+        for (auto idx = head_; idx != Nil; idx = nodes_[idx].next) {
+            entries.emplace_back(nodes_[idx].key, std::move(nodes_[idx].value));
+        }
+        allocate(capacity);
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+            const auto idx = free_;
+            auto &node = nodes_[idx];
+            free_ = node.next;
+            node.key = it->first;
+            node.value = std::move(it->second);
+            pushFront(idx);
+            tableInsert(idx);
+            size_++;
+        }
+    }
+
+    [[nodiscard]] const SlabLRUCacheStats &stats() const { return stats_; }
+
+    void resetStats() { stats_ = {}; }
+
+    // keys from most to least recently used
+    [[nodiscard]] std::vector<key_type> keys() const {
+        std::vector<key_type> result;
+        result.reserve(size_);
+        for (auto idx = head_; idx != Nil; idx = nodes_[idx].next) {
+            result.push_back(nodes_[idx].key);
+        }
+        return result;
+    }
+
+private:
+    static constexpr uint32_t Nil = UINT32_MAX;
+
+    struct Node {
+        key_type key = 0;
+        value_type value;
+        // LRU links while in use, `next` links the free list otherwise
+        uint32_t prev = Nil;
+        uint32_t next = Nil;
+    };
+
+    std::vector<Node> nodes_;
+    // node index per bucket, Nil if empty; size is a power of 2
+    std::vector<uint32_t> table_;
+    size_t mask_ = 0;
+    uint32_t head_ = Nil;
+    uint32_t tail_ = Nil;
+    uint32_t free_ = Nil;
+    size_t size_ = 0;
+    SlabLRUCacheStats stats_;
+
+    void allocate(size_t capacity) {
+        if (capacity == 0) {
+            capacity = 1;
+        }
+        nodes_ = std::vector<Node>(capacity);
+        size_t buckets = 2;
+        while (buckets < capacity * 2) {
+            buckets <<= 1;
+        }
+        table_.assign(buckets, Nil);
+        mask_ = buckets - 1;
+        reset();
+    }
+
+    // forget all entries, values must have been moved out
+    void reset() {
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            nodes_[i].value.reset();
+            nodes_[i].prev = Nil;
+            nodes_[i].next = i + 1 < nodes_.size() ? static_cast<uint32_t>(i + 1) : Nil;
+        }
+        std::fill(table_.begin(), table_.end(), Nil);
+        head_ = tail_ = Nil;
+        free_ = nodes_.empty() ? Nil : 0;
+        size_ = 0;
+    }
+
+    [[nodiscard]] size_t bucketOf(key_type key) const {
+        // Fibonacci hashing, uids are dense so they need spreading
+        const auto h = static_cast<uint32_t>(key) * 0x9e3779b9u;
+        return (h ^ (h >> 16)) & mask_;
+    }
+
+    [[nodiscard]] uint32_t lookup(key_type key) const {
+        for (auto b = bucketOf(key);; b = (b + 1) & mask_) {
+            const auto idx = table_[b];
+            if (idx == Nil || nodes_[idx].key == key) {
+                return idx;
+            }
+        }
+    }
+
+    void tableInsert(uint32_t idx) {
+        auto b = bucketOf(nodes_[idx].key);
+        while (table_[b] != Nil) {
+            b = (b + 1) & mask_;
+        }
+        table_[b] = idx;
+    }
+
+    void tableErase(key_type key) {
+        auto b = bucketOf(key);
+        while (nodes_[table_[b]].key != key) {
+            b = (b + 1) & mask_;
+        }
+        // shift following entries of the probe sequence back, so no tombstone is needed
+        auto hole = b;
+        for (auto next = (hole + 1) & mask_; table_[next] != Nil; next = (next + 1) & mask_) {
+            const auto home = bucketOf(nodes_[table_[next]].key);
+            // entry may move to the hole only if the hole is between its home and its slot
+            if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+                table_[hole] = table_[next];
+                hole = next;
+            }
+        }
+        table_[hole] = Nil;
+    }
+
+    void pushFront(uint32_t idx) {
+        auto &node = nodes_[idx];
+        node.prev = Nil;
+        node.next = head_;
+        if (head_ != Nil) {
+            nodes_[head_].prev = idx;
+        } else {
+            tail_ = idx;
+        }
+        head_ = idx;
+    }
+
+    void unlink(uint32_t idx) {
+        auto &node = nodes_[idx];
+        if (node.prev != Nil) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            head_ = node.next;
+        }
+        if (node.next != Nil) {
+            nodes_[node.next].prev = node.prev;
+        } else {
+            tail_ = node.prev;
+        }
+    }
+
+    // remove entry at `idx` and return its value
+    value_type removeAt(uint32_t idx) {
+        auto &node = nodes_[idx];
+        tableErase(node.key);
+        unlink(idx);
+        auto value = std::move(node.value);
+        node.prev = Nil;
+        node.next = free_;
+        free_ = idx;
+        size_--;
+        return value;
+    }
+
+    value_type take(key_type key) {
+        const auto idx = lookup(key);
+        if (idx == Nil) {
+            return nullptr;
+        }
+        return removeAt(idx);
+    }
+
+    void evict() {
+        if (tail_ == Nil) {
+            return;
+        }
+        stats_.evictions++;
+        // evict item from the end of most recently used list
+        auto value = removeAt(tail_);
+    }
+};
+
+#endif //FCITX5_ANDROID_SLABLRUCACHE_H
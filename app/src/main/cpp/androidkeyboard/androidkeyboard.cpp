@@ -2,8 +2,15 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  * SPDX-FileCopyrightText: Copyright 2021-2023 Fcitx5 for Android Contributors
  */
+#include <algorithm>
+#include <fstream>
+#include <optional>
+
 #include <fcitx-utils/utf8.h>
 #include <fcitx-utils/charutils.h>
+#include <fcitx-utils/log.h>
+#include <fcitx-utils/standardpaths.h>
+#include <fcitx-utils/stringutils.h>
 #include <fcitx/instance.h>
 #include <fcitx/candidatelist.h>
 #include <fcitx/inputpanel.h>
@@ -11,6 +18,7 @@
 
 #include "spell_public.h"
 #include "../../../../../lib/fcitx5/src/main/cpp/fcitx5/src/im/keyboard/chardata.h" // dirty but works
+#include "../../../../../lib/fcitx5/src/main/cpp/fcitx5/src/modules/spell/spell-custom-dict.h"
 
 #include "androidkeyboard.h"
 
@@ -18,6 +26,16 @@ namespace fcitx {
 
 namespace {
 
+// highest cost of a correction for `userInput`, 0 if it's not worth correcting
+int correctionCost(const std::string &userInput) {
+    if (userInput.size() < 2 || userInput.size() > FuzzyMatcher::MaxInputSize ||
+        !std::all_of(userInput.begin(), userInput.end(), charutils::isalpha)) {
+        return 0;
+    }
+    // a missing, extra or wrong key in short words, and a slip to a neighbouring key on top in longer ones
+    return userInput.size() <= 4 ? 2 : 3;
+}
+
 class AndroidKeyboardCandidateWord : public CandidateWord {
 public:
     AndroidKeyboardCandidateWord(AndroidKeyboardEngine *engine, Text text, std::string commit)
@@ -25,6 +43,7 @@ public:
               commit_(std::move(commit)) {}
 
     void select(InputContext *inputContext) const override {
+        engine_->learnWord(inputContext, commit_);
         inputContext->commitString(commit_);
         inputContext->inputPanel().reset();
         inputContext->updatePreedit();
@@ -44,6 +63,7 @@ private:
 AndroidKeyboardEngine::AndroidKeyboardEngine(Instance *instance)
         : instance_(instance) {
     instance_->inputContextManager().registerProperty("androidkeyboardState", &factory_);
+    dispatcher_.attach(&instance_->eventLoop());
     reloadConfig();
     wordHintAction_.setShortText(_("Word hint"));
     wordHintAction_.setLongText(_("Word hint"));
@@ -58,6 +78,8 @@ AndroidKeyboardEngine::AndroidKeyboardEngine(Instance *instance)
     instance_->userInterfaceManager().registerAction("androidkeyboard-word-hint", &wordHintAction_);
 }
 
+AndroidKeyboardEngine::~AndroidKeyboardEngine() = default;
+
 static inline bool isValidSym(const Key &key) {
     if (key.states()) {
         return false;
@@ -173,6 +195,8 @@ std::vector<InputMethodEntry> AndroidKeyboardEngine::listInputMethods() {
 
 void AndroidKeyboardEngine::reloadConfig() {
     readAsIni(config_, ConfPath);
+    // dictionaries may have come with a plugin since
+    supportHint_.clear();
     selectionKeys_.clear();
     const std::array<KeySym, 10> syms{
             FcitxKey_1, FcitxKey_2, FcitxKey_3, FcitxKey_4, FcitxKey_5,
@@ -248,24 +272,114 @@ void AndroidKeyboardEngine::resetState(InputContext *inputContext, bool fromCand
 void AndroidKeyboardEngine::updateCandidate(const InputMethodEntry &entry, InputContext *inputContext) {
     inputContext->inputPanel().reset();
     auto *state = inputContext->propertyFor(&factory_);
+    const auto revision = ++state->revision_;
     const auto userInput = state->buffer_.userInput();
-    std::vector<std::pair<std::string, std::string>> results;
-    if (spell()) {
-        results = spell()->call<ISpell::hintForDisplay>(entry.languageCode(),
-                                                        SpellProvider::Default,
-                                                        userInput,
-                                                        SpellCandidateSize);
+    if (!spell()) {
+        setCandidates(inputContext, userInput, {});
+        return;
+    }
+    const auto &language = entry.languageCode();
+    const auto *cached = state->hintCache_.find(language, userInput);
+    auto *userLexicon = *config_.learnWords ? lexicon(language) : nullptr;
+    const bool correcting = *config_.correctTypos && correctionCost(userInput) > 0;
+    if (cached && !correcting && (!userLexicon || cached->empty())) {
+        setCandidates(inputContext, userInput, *cached);
+        return;
     }
+    // show preedit and hints as they are right away, or those of a prefix that still fit, looking up,
+    // ranking and corrections may take a while; the list is replaced once they are done
+    setCandidates(inputContext, userInput, cached ? *cached : state->hintCache_.provisional(language, userInput));
+    worker_.submit([this, ref = inputContext->watch(), revision, language, userInput, userLexicon, correcting,
+                           cached = cached ? std::optional(*cached) : std::nullopt]() mutable {
+        const bool lookedUp = !cached;
+        auto found = lookedUp ? hint(language, userInput) : std::move(*cached);
+        auto hints = found;
+        if (userLexicon) {
+            userLexicon->rank(hints);
+        }
+        if (correcting) {
+            FuzzyMatcher::merge(hints, correct(language, userInput), userInput);
+        }
+        post([this, ref, revision, language, userInput, lookedUp, found = std::move(found),
+                     hints = std::move(hints)]() mutable {
+            auto *ic = ref.get();
+            if (!ic) {
+                return;
+            }
+            auto *state = ic->propertyFor(&factory_);
+            if (lookedUp) {
+                // still the hints of that input, eg. after backspace
+                state->hintCache_.put(language, userInput, std::move(found));
+            }
+            if (state->revision_ != revision) {
+                wordHintStats_.discarded++;
+                return;
+            }
+            setCandidates(ic, userInput, hints);
+        });
+    });
+}
+
+void AndroidKeyboardEngine::post(std::function<void()> callback) {
+    pendingCallbacks_++;
+    dispatcher_.schedule([this, callback = std::move(callback)]() {
+        callback();
+        pendingCallbacks_--;
+    });
+}
+
+bool AndroidKeyboardEngine::idle() {
+    return worker_.idle() && pendingCallbacks_ == 0;
+}
+
+WordHintCache::Hints AndroidKeyboardEngine::hint(const std::string &language, const std::string &userInput) {
+    auto it = spellDictionaries_.find(language);
+    if (it == spellDictionaries_.end()) {
+        // what the spell addon looks up with SpellProvider::Default, fcitx5 is built without enchant
+        it = spellDictionaries_.emplace(language, SpellCustomDict::requestDict(language)).first;
+    }
+    if (!it->second) {
+        return {};
+    }
+    return it->second->hint(userInput, SpellCandidateSize);
+}
+
+std::vector<FuzzyMatcher::Correction> AndroidKeyboardEngine::correct(const std::string &language,
+                                                                     const std::string &userInput) {
+    auto it = fuzzyDictionaries_.find(language);
+    if (it == fuzzyDictionaries_.end()) {
+        it = fuzzyDictionaries_.emplace(language, FuzzyDictionary()).first;
+        // the spell module does not expose its word list, read the same dictionary file
+        auto path = StandardPaths::global().locate(StandardPathsType::PkgData, "spell/" + language + "_dict.fscd");
+        if (const auto pos = language.find('_'); path.empty() && pos != std::string::npos) {
+            path = StandardPaths::global().locate(StandardPathsType::PkgData,
+                                                  "spell/" + language.substr(0, pos) + "_dict.fscd");
+        }
+        if (!path.empty()) {
+            std::ifstream in(path, std::ios::binary);
+            if (!it->second.loadFscd(in)) {
+                FCITX_WARN() << "Cannot read spell dictionary " << path;
+            }
+        }
+    }
+    return FuzzyMatcher::match(it->second, userInput, correctionCost(userInput), CorrectionSize,
+                               CorrectionTimeBudget).corrections;
+}
+
+void AndroidKeyboardEngine::setCandidates(InputContext *inputContext,
+                                          const std::string &userInput,
+                                          const WordHintCache::Hints &hints) {
+    const auto shown = std::min<size_t>(hints.size(), SpellCandidateSize);
     auto candidateList = std::make_unique<CommonCandidateList>();
-    if (results.empty() || results.front().second != userInput) {
+    if (hints.empty() || hints.front().second != userInput) {
         // TODO: comply with fcitx5 spell module's delim " _-,./?!%"
         // it's fine in androidkeyboard because only "-" won't commit buffer
         const auto segments = stringutils::split(userInput, "-");
         const auto label = segments.size() > 1 ? segments.back() : userInput;
         candidateList->append<AndroidKeyboardCandidateWord>(this, Text(label), userInput);
     }
-    for (const auto &result: results) {
-        candidateList->append<AndroidKeyboardCandidateWord>(this, Text(result.first), result.second);
+    for (size_t i = 0; i < shown; i++) {
+        candidateList->append<AndroidKeyboardCandidateWord>(this, Text(hints[i].first), hints[i].second);
     }
     candidateList->setPageSize(*config_.pageSize);
     candidateList->setSelectionKey(selectionKeys_);
@@ -275,6 +389,23 @@ void AndroidKeyboardEngine::updateCandidate(const InputMethodEntry &entry, Input
     updateUI(inputContext);
 }
 
+void AndroidKeyboardEngine::learnWord(InputContext *inputContext, const std::string &committed) {
+    auto *entry = instance_->inputMethodEntry(inputContext);
+    if (!*config_.learnWords || !entry) {
+        return;
+    }
+    lexicon(entry->languageCode())->record(committed);
+}
+
+UserLexicon *AndroidKeyboardEngine::lexicon(const std::string &language) {
+    auto &lexicon = lexicons_[language];
+    if (!lexicon) {
+        const auto dir = StandardPaths::global().userDirectory(StandardPathsType::PkgData) / "androidkeyboard" / "lexicon";
+        lexicon = std::make_unique<UserLexicon>(dir / language);
+    }
+    return lexicon.get();
+}
+
 void AndroidKeyboardEngine::updateUI(InputContext *inputContext) {
     auto [text, cursor] = preeditWithCursor(inputContext);
     if (inputContext->capabilityFlags().test(CapabilityFlag::Preedit)) {
@@ -329,6 +460,7 @@ void AndroidKeyboardEngine::commitBuffer(InputContext *inputContext) {
     if (preedit.empty()) {
         return;
     }
+    learnWord(inputContext, preedit);
     auto characterCount = utf8::length(preedit, 0, cursor);
     if (inputContext->capabilityFlags().test(CapabilityFlag::CommitStringWithCursor)) {
         inputContext->commitStringWithCursor(preedit, characterCount);
@@ -342,7 +474,14 @@ void AndroidKeyboardEngine::commitBuffer(InputContext *inputContext) {
 }
 
 bool AndroidKeyboardEngine::supportHint(const std::string &language) {
-    const bool hasSpell = spell() && spell()->call<ISpell::checkDict>(language);
+    if (auto it = supportHint_.find(language); it != supportHint_.end()) {
+        return it->second;
+    }
+    bool hasSpell = false;
+    if (spell()) {
+        hasSpell = spell()->call<ISpell::checkDict>(language);
+    }
+    supportHint_.emplace(language, hasSpell);
     return hasSpell;
 }
 
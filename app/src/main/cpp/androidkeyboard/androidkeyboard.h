@@ -5,7 +5,14 @@
 #ifndef FCITX5_ANDROID_ANDROIDKEYBOARD_H
 #define FCITX5_ANDROID_ANDROIDKEYBOARD_H
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 #include <fcitx-config/iniparser.h>
+#include <fcitx-utils/eventdispatcher.h>
 #include <fcitx-utils/inputbuffer.h>
 #include <fcitx-utils/i18n.h>
 #include <fcitx/addonfactory.h>
@@ -13,8 +20,16 @@
 #include <fcitx/inputmethodengine.h>
 #include <fcitx/action.h>
 
+#include "androidkeyboard_public.h"
+#include "fuzzymatcher.h"
+#include "hintworker.h"
+#include "userlexicon.h"
+#include "wordhintcache.h"
+
 namespace fcitx {
 
+class SpellCustomDict;
+
 class Instance;
 
 enum class ChooseModifier {
@@ -40,6 +55,10 @@ FCITX_CONFIGURATION(
             chooseModifier{this, "ChooseModifier", _("Choose key modifier"), ChooseModifier::Alt};
         Option<bool>
             insertSpace{this, "InsertSpace", _("Insert space between words"), false};
+        Option<bool>
+            learnWords{this, "LearnWords", _("Rank word hints by words committed before"), true};
+        Option<bool>
+            correctTypos{this, "CorrectTypos", _("Suggest words for mistyped keys"), true};
 )
 
 class AndroidKeyboardEngine;
@@ -48,11 +67,19 @@ struct AndroidKeyboardEngineState : public InputContextProperty {
     InputBuffer buffer_;
     std::string origKeyString_;
     bool prependSpace_ = false;
+    // kept across words, backspace and retyping a prefix are common; spell dictionaries are not prefix ranked
+    WordHintCache hintCache_;
+    // bumped on every change of buffer, hints looked up for an older one are not shown
+    uint64_t revision_ = 0;
+
+    explicit AndroidKeyboardEngineState(WordHintCacheStats &stats)
+            : hintCache_(stats) {}
 
     void reset() {
         buffer_.clear();
         origKeyString_.clear();
         prependSpace_ = false;
+        revision_++;
     }
 };
 
@@ -60,9 +87,14 @@ class AndroidKeyboardEngine final : public InputMethodEngineV3 {
 public:
     static int constexpr MaxBufferSize = 20;
     static int constexpr SpellCandidateSize = 20;
+    static int constexpr CorrectionSize = 5;
+    // words not screened by then are left out, so that ranked hints do not replace the shown ones late
+    static constexpr auto CorrectionTimeBudget = std::chrono::milliseconds(2);
 
     explicit AndroidKeyboardEngine(Instance *instance);
 
+    ~AndroidKeyboardEngine() override;
+
     Instance *instance() { return instance_; }
 
     void keyEvent(const InputMethodEntry &entry, KeyEvent &event) override;
@@ -106,10 +138,29 @@ public:
     // See also preeditString().
     void commitBuffer(InputContext *inputContext);
 
+    // count `committed` in user lexicon of current input method
+    void learnWord(InputContext *inputContext, const std::string &committed);
+
     void invokeActionImpl(const InputMethodEntry &entry, InvokeActionEvent &event) override;
 
+    const WordHintCacheStats &wordHintStats() const { return wordHintStats_; }
+
+    bool idle();
+
+    FCITX_ADDON_EXPORT_FUNCTION(AndroidKeyboardEngine, idle);
+
 private:
     bool supportHint(const std::string &language);
+    // created on first use, files are loaded in its own thread
+    UserLexicon *lexicon(const std::string &language);
+    // only called from jobs of worker_, dictionaries are read there
+    WordHintCache::Hints hint(const std::string &language, const std::string &userInput);
+    // only called from jobs of worker_, dictionaries are read there
+    std::vector<FuzzyMatcher::Correction> correct(const std::string &language, const std::string &userInput);
+    // replace candidate list with the buffer itself and `hints`, then update UI
+    void setCandidates(InputContext *inputContext, const std::string &userInput, const WordHintCache::Hints &hints);
+    // from jobs of worker_, run `callback` on fcitx thread
+    void post(std::function<void()> callback);
     /**
      * preedit string and byte cursor
      */
@@ -119,9 +170,26 @@ private:
     AndroidKeyboardEngineConfig config_;
     KeyList selectionKeys_;
     fcitx::SimpleAction wordHintAction_;
+    WordHintCacheStats wordHintStats_;
+    // checkDict of each language, asked once as it may load the dictionary
+    std::unordered_map<std::string, bool> supportHint_;
+    std::unordered_map<std::string, std::unique_ptr<UserLexicon>> lexicons_;
+    // only used by jobs of worker_, null if a language has no dictionary; the spell addon is shared
+    // with the rest of fcitx on its thread, so the worker keeps its own of the same files
+    std::unordered_map<std::string, std::unique_ptr<SpellCustomDict>> spellDictionaries_;
+    // only used by jobs of worker_, empty if a language has no spell dictionary
+    std::unordered_map<std::string, FuzzyDictionary> fuzzyDictionaries_;
+    // results of worker_ are posted back to fcitx thread through it
+    EventDispatcher dispatcher_;
+    // posted but not run yet
+    std::atomic<int> pendingCallbacks_{0};
+    // declared after what its jobs use, so that it's joined before they are destroyed
+    HintWorker worker_;
 
     FactoryFor<AndroidKeyboardEngineState> factory_{
-            [](InputContext &) { return new AndroidKeyboardEngineState; }
+            [this](InputContext &) {
+                return new AndroidKeyboardEngineState(wordHintStats_);
+            }
     };
 };
 
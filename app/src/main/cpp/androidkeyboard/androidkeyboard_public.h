@@ -0,0 +1,14 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_ANDROIDKEYBOARD_PUBLIC_H
+#define FCITX5_ANDROID_ANDROIDKEYBOARD_PUBLIC_H
+
+#include <fcitx/addoninstance.h>
+
+// no hint, correction or prediction job is pending or running, and their results are shown
+FCITX_ADDON_DECLARE_FUNCTION(AndroidKeyboardEngine, idle,
+                             bool());
+
+#endif //FCITX5_ANDROID_ANDROIDKEYBOARD_PUBLIC_H
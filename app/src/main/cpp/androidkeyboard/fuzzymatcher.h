@@ -0,0 +1,371 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_FUZZYMATCHER_H
+#define FCITX5_ANDROID_FUZZYMATCHER_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "predictionbudget.h"
+
+/**
+ * Words of a spell dictionary sorted, with the length of prefix each one shares with the
+ * previous word, so matching can resume from there instead of the first letter, and where
+ * the words starting with each letter are.
+ */
+class FuzzyDictionary {
+public:
+    // longer words are never corrections of a word hint input, see AndroidKeyboardEngine::MaxBufferSize
+    static constexpr size_t MaxWordSize = 32;
+
+    /**
+     * Read a fcitx5 spell custom dictionary (.fscd): "FSCD0000", little endian uint32 count,
+     * then a little endian uint16 weight and a NUL terminated word for each entry.
+     * @return false if it's not one; words read so far are kept
+     */
+    bool loadFscd(std::istream &in) {
+        char magic[8];
+        uint8_t count[4];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, "FSCD0000", sizeof(magic)) != 0 ||
+            !in.read(reinterpret_cast<char *>(count), sizeof(count))) {
+            return false;
+        }
+        const uint32_t n = count[0] | count[1] << 8 | count[2] << 16 | static_cast<uint32_t>(count[3]) << 24;
+        std::vector<std::pair<std::string, uint16_t>> entries;
+        entries.reserve(n);
+        std::string word;
+        for (uint32_t i = 0; i < n; i++) {
+            uint8_t weight[2];
+            if (!in.read(reinterpret_cast<char *>(weight), sizeof(weight)) || !std::getline(in, word, '\0')) {
+                break;
+            }
+            entries.emplace_back(word, static_cast<uint16_t>(weight[0] | weight[1] << 8));
+        }
+        const bool complete = entries.size() == n;
+        build(std::move(entries));
+        return complete;
+    }
+
+    // `entries` are words and weights, higher weight for more frequent ones
+    void build(std::vector<std::pair<std::string, uint16_t>> entries) {
+        std::sort(entries.begin(), entries.end());
+        text_.clear();
+        words_.clear();
+        starts_.fill(0);
+        const std::string *prev = nullptr;
+        for (const auto &[word, weight]: entries) {
+            if (word.empty() || word.size() > MaxWordSize || (prev && *prev == word)) {
+                continue;
+            }
+            size_t lcp = 0;
+            if (prev) {
+                while (lcp < prev->size() && lcp < word.size() && (*prev)[lcp] == word[lcp]) lcp++;
+            }
+            words_.push_back({static_cast<uint32_t>(text_.size()), static_cast<uint8_t>(word.size()),
+                              static_cast<uint8_t>(lcp), weight});
+            text_ += word;
+            prev = &word;
+            starts_[static_cast<unsigned char>(word[0]) + 1]++;
+        }
+        for (size_t c = 1; c < starts_.size(); c++) {
+            starts_[c] += starts_[c - 1];
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return words_.size(); }
+
+    [[nodiscard]] std::string_view word(size_t i) const { return {text_.data() + words_[i].offset, words_[i].size}; }
+
+    [[nodiscard]] uint16_t weight(size_t i) const { return words_[i].weight; }
+
+    // length of prefix shared with word i - 1
+    [[nodiscard]] size_t shared(size_t i) const { return words_[i].shared; }
+
+    // indices of words starting with byte `c`, [first, second)
+    [[nodiscard]] std::pair<size_t, size_t> initial(unsigned char c) const { return {starts_[c], starts_[c + 1]}; }
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint8_t size;
+        uint8_t shared;
+        uint16_t weight;
+    };
+
+    std::string text_;
+    std::vector<Entry> words_;
+    // words starting with byte c are from starts_[c] up to starts_[c + 1]
+    std::array<uint32_t, 257> starts_{};
+};
+
+/**
+ * Typo tolerant matching of a partial input against dictionary words, in costs where an
+ * insertion, deletion or substitution is 2, and a substitution of a key next to the intended
+ * one on QWERTY is 1.
+ *
+ * The input is compared with every prefix of each word, so corrections are also completions.
+ * Words are screened with Myers' bit-parallel edit distance, one machine word for the whole
+ * input and one step per letter, resumed from the prefix shared with the previous word, and
+ * stopped once no longer prefix can come within reach. Keys next to each other count as equal
+ * there, so the distance is at most half the cost; the few words within reach are then scored
+ * with the weighted distance. Words starting with the first letter typed or a key next to it
+ * are screened first, so when time runs out the words left are the least likely ones rather
+ * than the end of the alphabet.
+ */
+class FuzzyMatcher {
+public:
+    // input longer than this is not matched
+    static constexpr size_t MaxInputSize = 24;
+
+    struct Correction {
+        std::string word;
+        int cost;
+        uint16_t weight;
+    };
+
+    struct Result {
+        // best first
+        std::vector<Correction> corrections;
+        // some words were not looked at
+        bool exhausted = false;
+    };
+
+    static bool adjacent(char a, char b) {
+        const auto fb = static_cast<unsigned char>(fold(b));
+        return fb >= 'a' && fb <= 'z' && (neighbours()[static_cast<unsigned char>(fold(a))] >> (fb - 'a') & 1);
+    }
+
+    // weighted distance between `input` and the closest prefix of `word`
+    static int prefixCost(std::string_view input, std::string_view word, int maxCost) {
+        const size_t m = input.size();
+        const size_t n = std::min(word.size(), m + static_cast<size_t>(maxCost) / 2);
+        // rows i - 1 and i of the table, over prefixes of word
+        std::array<std::array<int, MaxInputSize + FuzzyDictionary::MaxWordSize + 1>, 2> rows{};
+        for (size_t j = 0; j <= n; j++) rows[0][j] = static_cast<int>(j) * 2;
+        for (size_t i = 1; i <= m; i++) {
+            auto &cur = rows[i % 2];
+            const auto &up = rows[(i - 1) % 2];
+            cur[0] = static_cast<int>(i) * 2;
+            for (size_t j = 1; j <= n; j++) {
+                const char a = fold(input[i - 1]), b = word[j - 1];
+                const int sub = a == b ? 0 : adjacent(a, b) ? 1 : 2;
+                cur[j] = std::min({up[j] + 2, cur[j - 1] + 2, up[j - 1] + sub});
+            }
+        }
+        const auto &last = rows[m % 2];
+        return *std::min_element(last.begin(), last.begin() + static_cast<ptrdiff_t>(n) + 1);
+    }
+
+    /**
+     * @param maxCost corrections costing more are left out
+     * @param limit number of corrections to keep; exact prefixes of `input` are not corrections
+     * @param budget words not screened by then are skipped
+     */
+    static Result match(const FuzzyDictionary &dict, std::string_view input, int maxCost, size_t limit,
+                        std::chrono::steady_clock::duration budget) {
+        Result result;
+        const size_t m = input.size();
+        if (m == 0 || m > MaxInputSize || maxCost <= 0 || limit == 0) {
+            return result;
+        }
+        // edits left after taking neighbouring keys as equal cost 2 each
+        const int maxEdits = std::min(maxCost / 2, static_cast<int>(MaxInputSize));
+        // letters of a word beyond this cost more than maxCost to skip
+        const size_t maxDepth = m + static_cast<size_t>(maxEdits);
+        std::string folded(input);
+        std::array<uint64_t, 256> peq{};
+        for (size_t i = 0; i < m; i++) {
+            folded[i] = fold(input[i]);
+            const auto c = static_cast<unsigned char>(folded[i]);
+            peq[c] |= uint64_t(1) << i;
+            for (unsigned char k = 'a'; k <= 'z'; k++) {
+                if (neighbours()[c] >> (k - 'a') & 1) peq[k] |= uint64_t(1) << i;
+            }
+        }
+        const uint64_t high = uint64_t(1) << (m - 1);
+        const uint64_t mask = m == 64 ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+        // Myers state after each letter of the current word, and best distance of prefixes so far
+        struct Column {
+            uint64_t pv, mv;
+            int score, best;
+        };
+        std::array<Column, MaxInputSize + MaxInputSize + 1> columns{};
+        columns[0] = {mask, 0, static_cast<int>(m), static_cast<int>(m)};
+        size_t depth = 0;
+        // columns from here on are out of reach for every word sharing the prefix
+        size_t dead = SIZE_MAX;
+        PredictionBudget timer(budget, 64);
+        struct Scored {
+            size_t index;
+            int cost;
+            uint16_t weight;
+            size_t size;
+        };
+        std::vector<Scored> found;
+        // cost of the previous word if it was scored, shared by words alike up to maxDepth
+        int previous = -1;
+        for (const auto letter: scanOrder(static_cast<unsigned char>(folded[0]))) {
+            if (result.exhausted) {
+                break;
+            }
+            // a word starting another letter shares nothing with the one before, depth resets
+            const auto [from, to] = dict.initial(letter);
+            for (size_t w = from; w < to; w++) {
+                if (!timer.step()) {
+                    result.exhausted = true;
+                    break;
+                }
+                const auto word = dict.word(w);
+                const int reused = dict.shared(w) >= maxDepth ? previous : -1;
+                previous = -1;
+                // columns beyond what this word shares with the previous one are stale
+                depth = std::min(depth, dict.shared(w));
+                if (depth < dead) {
+                    dead = SIZE_MAX;
+                }
+                const size_t end = std::min({word.size(), maxDepth, dead});
+                for (; depth < end; depth++) {
+                    const auto &c = columns[depth];
+                    const uint64_t eq = peq[static_cast<unsigned char>(word[depth])];
+                    const uint64_t xv = eq | c.mv;
+                    const uint64_t xh = (((eq & c.pv) + c.pv) ^ c.pv) | eq;
+                    uint64_t ph = c.mv | ~(xh | c.pv);
+                    uint64_t mh = c.pv & xh;
+                    int score = c.score;
+                    if (ph & high) score++;
+                    else if (mh & high) score--;
+                    ph = (ph << 1) | 1;
+                    mh <<= 1;
+                    const uint64_t pv = (mh | ~(xv | ph)) & mask, mv = ph & xv & mask;
+                    columns[depth + 1] = {pv, mv, score, std::min(c.best, score)};
+                    if (score > maxEdits && lowest(pv, mv, static_cast<int>(depth) + 1, m) > maxEdits) {
+                        dead = depth + 1;
+                        depth++;
+                        break;
+                    }
+                }
+                // exact prefixes are completions, the spell module has them
+                if (columns[depth].best > maxEdits || word.compare(0, m, folded) == 0) {
+                    continue;
+                }
+                const int cost = reused >= 0 ? reused : prefixCost(input, word, maxCost);
+                previous = cost;
+                if (cost > 0 && cost <= maxCost) {
+                    found.push_back({w, cost, dict.weight(w), word.size()});
+                }
+            }
+        }
+        const auto n = std::min(limit, found.size());
+        std::partial_sort(found.begin(), found.begin() + static_cast<ptrdiff_t>(n), found.end(),
+                          [](const Scored &a, const Scored &b) {
+                              if (a.cost != b.cost) return a.cost < b.cost;
+                              if (a.weight != b.weight) return a.weight > b.weight;
+                              return a.size < b.size;
+                          });
+        result.corrections.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            result.corrections.push_back({std::string(dict.word(found[i].index)), found[i].cost, found[i].weight});
+        }
+        return result;
+    }
+
+    /**
+     * Put `corrections` among `hints` (pairs of display and commit string) by cost: one costing 1
+     * goes after the first hint, 2 after the second, and so on. Those already in `hints`
+     * are skipped; they are capitalized like `input`.
+     */
+    template<typename Hints>
+    static void merge(Hints &hints, const std::vector<Correction> &corrections, std::string_view input) {
+        const bool capitalized = !input.empty() && input[0] >= 'A' && input[0] <= 'Z';
+        Hints merged;
+        merged.reserve(hints.size() + corrections.size());
+        size_t next = 0;
+        for (const auto &c: corrections) {
+            const auto slot = std::min(hints.size(), static_cast<size_t>(c.cost));
+            while (next < slot) merged.push_back(std::move(hints[next++]));
+            auto word = c.word;
+            if (capitalized && !word.empty() && word[0] >= 'a' && word[0] <= 'z') {
+                word[0] = static_cast<char>(word[0] - 'a' + 'A');
+            }
+            const auto same = [&word](const auto &h) { return h.second == word; };
+            if (std::none_of(hints.begin(), hints.end(), same) && std::none_of(merged.begin(), merged.end(), same)) {
+                merged.emplace_back(word, word);
+            }
+        }
+        while (next < hints.size()) merged.push_back(std::move(hints[next++]));
+        hints = std::move(merged);
+    }
+
+private:
+    static char fold(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+    // first bytes of words, `first` and keys next to it before the others
+    static std::array<unsigned char, 256> scanOrder(unsigned char first) {
+        std::array<unsigned char, 256> order{};
+        std::array<bool, 256> taken{};
+        size_t n = 0;
+        auto take = [&](unsigned char c) {
+            if (!taken[c]) {
+                taken[c] = true;
+                order[n++] = c;
+            }
+        };
+        take(first);
+        for (unsigned char k = 'a'; k <= 'z'; k++) {
+            if (neighbours()[first] >> (k - 'a') & 1) take(k);
+        }
+        for (size_t c = 0; c < order.size(); c++) {
+            take(static_cast<unsigned char>(c));
+        }
+        return order;
+    }
+
+    // lowest distance in a column, from its top and vertical deltas
+    static int lowest(uint64_t pv, uint64_t mv, int top, size_t m) {
+        int v = top, low = top;
+        for (size_t i = 0; i < m; i++) {
+            v += static_cast<int>(pv >> i & 1) - static_cast<int>(mv >> i & 1);
+            low = std::min(low, v);
+        }
+        return low;
+    }
+
+    // bit k - 'a' is set for keys k next to each lower case letter on QWERTY
+    static const std::array<uint32_t, 256> &neighbours() {
+        static const std::array<uint32_t, 256> table = [] {
+            const char *rows[] = {"qwertyuiop", "asdfghjkl", "zxcvbnm"};
+            std::array<uint32_t, 256> t{};
+            auto link = [&t](char a, char b) {
+                t[static_cast<unsigned char>(a)] |= uint32_t(1) << (b - 'a');
+                t[static_cast<unsigned char>(b)] |= uint32_t(1) << (a - 'a');
+            };
+            for (int r = 0; r < 3; r++) {
+                const auto len = static_cast<int>(std::strlen(rows[r]));
+                for (int c = 0; c < len; c++) {
+                    if (c + 1 < len) link(rows[r][c], rows[r][c + 1]);
+                    // rows are staggered by half a key: below are c - 1 and c
+                    if (r < 2) {
+                        const auto below = static_cast<int>(std::strlen(rows[r + 1]));
+                        if (c - 1 >= 0 && c - 1 < below) link(rows[r][c], rows[r + 1][c - 1]);
+                        if (c < below) link(rows[r][c], rows[r + 1][c]);
+                    }
+                }
+            }
+            return t;
+        }();
+        return table;
+    }
+};
+
+#endif //FCITX5_ANDROID_FUZZYMATCHER_H
@@ -0,0 +1,101 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_HINTWORKER_H
+#define FCITX5_ANDROID_HINTWORKER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct HintWorkerStats {
+    // jobs run to completion
+    uint64_t completed = 0;
+    // jobs replaced by a newer one before they started
+    uint64_t superseded = 0;
+};
+
+/**
+ * One background thread running the latest submitted job.
+ *
+ * Only the newest job waits to run: submitting while another one is pending replaces it, so a
+ * burst of keys costs at most the lookup in progress plus the last one. A job already running
+ * is not interrupted; its owner tells stale results apart when they are posted back.
+ */
+class HintWorker {
+public:
+    HintWorker() : thread_([this] { run(); }) {}
+
+    HintWorker(const HintWorker &) = delete;
+
+    HintWorker &operator=(const HintWorker &) = delete;
+
+    // waits for the job in progress, pending one is dropped
+    ~HintWorker() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+            if (pending_) {
+                pending_ = nullptr;
+                stats_.superseded++;
+            }
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard lock(mutex_);
+            if (pending_) {
+                stats_.superseded++;
+            }
+            pending_ = std::move(job);
+        }
+        cv_.notify_one();
+    }
+
+    // no job pending or running
+    [[nodiscard]] bool idle() {
+        std::lock_guard lock(mutex_);
+        return !pending_ && !running_;
+    }
+
+    [[nodiscard]] HintWorkerStats stats() {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::function<void()> pending_;
+    bool running_ = false;
+    bool stopping_ = false;
+    HintWorkerStats stats_;
+    // last member, started after the others are initialized
+    std::thread thread_;
+
+    void run() {
+        std::unique_lock lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return stopping_ || pending_; });
+            if (stopping_) {
+                return;
+            }
+            auto job = std::move(pending_);
+            pending_ = nullptr;
+            running_ = true;
+            lock.unlock();
+            job();
+            lock.lock();
+            running_ = false;
+            stats_.completed++;
+        }
+    }
+};
+
+#endif //FCITX5_ANDROID_HINTWORKER_H
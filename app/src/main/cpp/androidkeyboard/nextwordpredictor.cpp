@@ -0,0 +1,108 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <fcitx-utils/log.h>
+#include <fcitx-utils/standardpaths.h>
+#include <libime/core/datrie.h>
+#include <libime/core/languagemodel.h>
+#include <libime/core/lattice.h>
+
+#include "nextwordpredictor.h"
+#include "predictionbudget.h"
+
+namespace fcitx {
+
+namespace {
+
+// language models are built from lower case text
+std::string foldCase(std::string word) {
+    for (auto &c: word) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return word;
+}
+
+} // namespace
+
+NextWordPredictor::NextWordPredictor() = default;
+
+NextWordPredictor::~NextWordPredictor() = default;
+
+std::filesystem::path NextWordPredictor::modelPath(const std::string &language) {
+    // "en_US", then "en"
+    auto path = StandardPaths::global().locate(StandardPathsType::Data, "libime/" + language + ".lm");
+    if (path.empty()) {
+        const auto pos = language.find('_');
+        if (pos != std::string::npos) {
+            path = StandardPaths::global().locate(StandardPathsType::Data, "libime/" + language.substr(0, pos) + ".lm");
+        }
+    }
+    return path;
+}
+
+std::unique_ptr<libime::LanguageModel> NextWordPredictor::open(const std::filesystem::path &path) {
+    try {
+        // StaticLanguageModelFile also reads "<path>.predict" next to it
+        auto file = std::make_shared<libime::StaticLanguageModelFile>(path.c_str());
+        return std::make_unique<libime::LanguageModel>(std::move(file));
+    } catch (const std::exception &e) {
+        FCITX_WARN() << "Cannot load language model " << path << ": " << e.what();
+    }
+    return nullptr;
+}
+
+libime::LanguageModel *NextWordPredictor::model(const std::string &language) {
+    auto it = models_.find(language);
+    if (it == models_.end()) {
+        const auto path = modelPath(language);
+        it = models_.emplace(language, path.empty() ? nullptr : open(path)).first;
+    }
+    return it->second.get();
+}
+
+bool NextWordPredictor::load(const std::string &language, const std::filesystem::path &path) {
+    auto &lm = models_[language];
+    lm = open(path);
+    return lm != nullptr;
+}
+
+NextWordPredictor::Predictions NextWordPredictor::predict(const std::string &language,
+                                                          const std::vector<std::string> &history,
+                                                          size_t size,
+                                                          std::chrono::steady_clock::duration budget) {
+    auto *lm = model(language);
+    if (!lm || size == 0) {
+        return {};
+    }
+    stats_.predictions++;
+    PredictionBudget timer(budget);
+    libime::State state = lm->nullState(), out;
+    for (const auto &word: history) {
+        const auto folded = foldCase(word);
+        lm->score(state, libime::WordNode(folded, lm->index(folded)), out);
+        state = out;
+    }
+    // successors of a word are stored as "<word>|<successor>"
+    auto lookup = history.empty() ? std::string("<s>") : foldCase(history.back());
+    lookup.push_back('|');
+    const auto &trie = lm->languageModelFile()->predictionTrie();
+    TopPredictions top(size);
+    std::string word;
+    trie.foreach(lookup, [&](float, size_t len, libime::DATrie<float>::position_type pos) {
+        if (!timer.step()) {
+            return false;
+        }
+        stats_.candidates++;
+        trie.suffix(word, len, pos);
+        const float score = lm->score(state, libime::WordNode(word, lm->index(word)), out);
+        top.offer(word, score);
+        return true;
+    });
+    if (timer.exhausted()) {
+        stats_.exhausted++;
+    }
+    return top.take();
+}
+
+} // namespace fcitx
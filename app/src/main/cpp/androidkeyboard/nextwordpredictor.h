@@ -0,0 +1,77 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_NEXTWORDPREDICTOR_H
+#define FCITX5_ANDROID_NEXTWORDPREDICTOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libime {
+class LanguageModel;
+}
+
+namespace fcitx {
+
+struct NextWordPredictorStats {
+    uint64_t predictions = 0;
+    // predictions cut short by the time budget
+    uint64_t exhausted = 0;
+    // successors read from prediction tries
+    uint64_t candidates = 0;
+};
+
+/**
+ * Next word prediction from libime language models, the kenlm binary `libime/<language>.lm`
+ * and its `.predict` trie of successors, as pinyin uses `libime/sc.lm`.
+ *
+ * kenlm maps the model file instead of parsing it into heap, so its pages are shared and can be
+ * dropped by the kernel under memory pressure. Models are opened on first use of a language,
+ * which takes a while for large ones; call it off the fcitx thread. Not thread safe.
+ *
+ * Not used by AndroidKeyboardEngine yet, as no model of a keyboard language is included;
+ * only host/benchprediction builds it.
+ */
+class NextWordPredictor {
+public:
+    using Predictions = std::vector<std::pair<std::string, float>>;
+
+    NextWordPredictor();
+
+    ~NextWordPredictor();
+
+    /**
+     * @param history words committed before, most recent last
+     * @param budget successors not looked at by then are skipped
+     * @return at most `size` words, most probable first
+     */
+    Predictions predict(const std::string &language, const std::vector<std::string> &history,
+                        size_t size, std::chrono::steady_clock::duration budget);
+
+    // use the model at `path` for `language` instead of looking in data directories
+    bool load(const std::string &language, const std::filesystem::path &path);
+
+    [[nodiscard]] const NextWordPredictorStats &stats() const { return stats_; }
+
+    static std::filesystem::path modelPath(const std::string &language);
+
+private:
+    // null if there is no model for that language
+    std::unordered_map<std::string, std::unique_ptr<libime::LanguageModel>> models_;
+    NextWordPredictorStats stats_;
+
+    libime::LanguageModel *model(const std::string &language);
+
+    static std::unique_ptr<libime::LanguageModel> open(const std::filesystem::path &path);
+};
+
+} // namespace fcitx
+
+#endif //FCITX5_ANDROID_NEXTWORDPREDICTOR_H
@@ -0,0 +1,104 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_PREDICTIONBUDGET_H
+#define FCITX5_ANDROID_PREDICTIONBUDGET_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Time limit of one prediction, checked every `interval` steps so that reading the clock
+ * does not cost more than the steps themselves.
+ */
+class PredictionBudget {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit PredictionBudget(Clock::duration budget, uint32_t interval = 32)
+            : deadline_(Clock::now() + budget), interval_(interval < 1 ? 1 : interval) {}
+
+    // call once per step, false once time is up
+    bool step() {
+        if (exhausted_) {
+            return false;
+        }
+        if (++steps_ % interval_ == 0 && Clock::now() >= deadline_) {
+            exhausted_ = true;
+        }
+        return !exhausted_;
+    }
+
+    [[nodiscard]] bool exhausted() const { return exhausted_; }
+
+    [[nodiscard]] uint64_t steps() const { return steps_; }
+
+private:
+    Clock::time_point deadline_;
+    uint32_t interval_;
+    uint64_t steps_ = 0;
+    bool exhausted_ = false;
+};
+
+/**
+ * Best `size` words by score, higher first; equal scores keep the order they were offered in.
+ */
+class TopPredictions {
+public:
+    explicit TopPredictions(size_t size) : size_(size) { heap_.reserve(size + 1); }
+
+    void offer(std::string word, float score) {
+        if (size_ == 0) {
+            return;
+        }
+        if (heap_.size() == size_ && !better({score, offered_}, heap_.front().first)) {
+            offered_++;
+            return;
+        }
+        heap_.push_back({{score, offered_++}, std::move(word)});
+        std::push_heap(heap_.begin(), heap_.end(), worseFirst);
+        if (heap_.size() > size_) {
+            std::pop_heap(heap_.begin(), heap_.end(), worseFirst);
+            heap_.pop_back();
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return heap_.size(); }
+
+    // words and scores, best first; leaves it empty
+    std::vector<std::pair<std::string, float>> take() {
+        std::sort_heap(heap_.begin(), heap_.end(), worseFirst);
+        std::vector<std::pair<std::string, float>> result;
+        result.reserve(heap_.size());
+        for (auto &e: heap_) {
+            result.emplace_back(std::move(e.second), e.first.first);
+        }
+        heap_.clear();
+        return result;
+    }
+
+private:
+    // score, then order of offer
+    using Rank = std::pair<float, uint64_t>;
+    using Entry = std::pair<Rank, std::string>;
+
+    size_t size_;
+    uint64_t offered_ = 0;
+    // the worst kept entry on top
+    std::vector<Entry> heap_;
+
+    static bool better(const Rank &a, const Rank &b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    }
+
+    static bool worseFirst(const Entry &a, const Entry &b) {
+        return better(a.first, b.first);
+    }
+};
+
+#endif //FCITX5_ANDROID_PREDICTIONBUDGET_H
@@ -0,0 +1,452 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_USERLEXICON_H
+#define FCITX5_ANDROID_USERLEXICON_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct UserLexiconStats {
+    // words appended to the log
+    uint64_t logged = 0;
+    uint64_t compactions = 0;
+};
+
+/**
+ * How often the user committed each word of one language, to rank word hints with.
+ *
+ * Commits are appended to `<name>.log` as "<sequence> <word>" lines, and merged from time to
+ * time into `<name>.idx`, fixed size records sorted by word, which is mapped instead of read.
+ * All file operations happen on a thread of its own: record() only queues the word, and the
+ * count of a word becomes visible once it's logged.
+ *
+ * Compaction is crash safe: the new index is written beside the old one, synced and renamed
+ * over it, with the last sequence it includes in its header, so log lines that survive a crash
+ * before the log is truncated are skipped on next load instead of counted twice. Memory it
+ * takes is bounded by the words logged since the previous one, the index is merged as a stream.
+ */
+class UserLexicon {
+public:
+    // longer words are not recorded
+    static constexpr size_t MaxWordSize = 31;
+    // log lines before they are merged into the index
+    static constexpr size_t CompactThreshold = 512;
+
+    explicit UserLexicon(std::filesystem::path base, size_t compactThreshold = CompactThreshold)
+            : base_(std::move(base)), compactThreshold_(compactThreshold),
+              thread_([this] { run(); }) {}
+
+    UserLexicon(const UserLexicon &) = delete;
+
+    UserLexicon &operator=(const UserLexicon &) = delete;
+
+    // queued words are logged before it returns
+    ~UserLexicon() {
+        {
+            std::lock_guard lock(queueMutex_);
+            stopping_ = true;
+        }
+        queueCv_.notify_one();
+        thread_.join();
+        unmap();
+    }
+
+    // count one commit of `word`, case insensitive; never waits for file operations
+    void record(std::string_view word) {
+        if (word.empty() || word.size() > MaxWordSize) {
+            return;
+        }
+        for (const char c: word) {
+            if (static_cast<unsigned char>(c) <= ' ') return;
+        }
+        {
+            std::lock_guard lock(queueMutex_);
+            queue_.push_back(fold(word));
+            queued_++;
+        }
+        queueCv_.notify_one();
+    }
+
+    [[nodiscard]] uint32_t count(std::string_view word) {
+        if (word.empty() || word.size() > MaxWordSize) {
+            return 0;
+        }
+        const auto folded = fold(word);
+        std::lock_guard lock(mutex_);
+        uint64_t total = indexCount(folded);
+        if (auto it = delta_.find(folded); it != delta_.end()) {
+            total += it->second;
+        }
+        return static_cast<uint32_t>(std::min<uint64_t>(total, UINT32_MAX));
+    }
+
+    /**
+     * Move words up by `weight` places per doubling of their count, keeping the order of
+     * `hints` otherwise. `hints` are pairs of display and commit string, as from ISpell.
+     */
+    template<typename Hints>
+    void rank(Hints &hints, double weight = 4) {
+        std::vector<std::pair<double, size_t>> keys;
+        keys.reserve(hints.size());
+        bool boosted = false;
+        for (size_t i = 0; i < hints.size(); i++) {
+            const auto n = count(hints[i].second);
+            boosted = boosted || n > 0;
+            keys.emplace_back(static_cast<double>(i) - weight * std::log2(1.0 + n), i);
+        }
+        if (!boosted) {
+            return;
+        }
+        std::stable_sort(keys.begin(), keys.end(),
+                         [](const auto &a, const auto &b) { return a.first < b.first; });
+        Hints ranked;
+        ranked.reserve(hints.size());
+        for (const auto &key: keys) {
+            ranked.push_back(std::move(hints[key.second]));
+        }
+        hints = std::move(ranked);
+    }
+
+    // wait until files are loaded, and words recorded so far are logged and merged if due
+    void sync() {
+        std::unique_lock lock(queueMutex_);
+        const auto target = queued_;
+        doneCv_.wait(lock, [this, target] { return loaded_ && processed_ >= target; });
+    }
+
+    [[nodiscard]] UserLexiconStats stats() {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+private:
+    static constexpr char Magic[4] = {'F', 'X', 'U', 'L'};
+    static constexpr uint32_t Version = 1;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        // last log sequence included
+        uint64_t sequence;
+        uint64_t records;
+    };
+
+    struct Record {
+        uint8_t size;
+        char word[MaxWordSize];
+        uint32_t count;
+
+        [[nodiscard]] std::string_view view() const { return {word, std::min<size_t>(size, MaxWordSize)}; }
+    };
+
+    std::filesystem::path base_;
+    size_t compactThreshold_;
+
+    // guards delta_, the mapped index and stats_; held only briefly by the writer
+    std::mutex mutex_;
+    const Record *records_ = nullptr;
+    size_t recordCount_ = 0;
+    void *mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    // logged since the last compaction
+    std::unordered_map<std::string, uint64_t> delta_;
+    UserLexiconStats stats_;
+
+    std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    std::condition_variable doneCv_;
+    std::deque<std::string> queue_;
+    uint64_t queued_ = 0;
+    uint64_t processed_ = 0;
+    bool loaded_ = false;
+    bool stopping_ = false;
+
+    // writer thread only
+    uint64_t sequence_ = 0;
+    uint64_t indexSequence_ = 0;
+    size_t logLines_ = 0;
+    FILE *log_ = nullptr;
+
+    // last member, started after the others are initialized
+    std::thread thread_;
+
+    static std::string fold(std::string_view word) {
+        std::string folded(word);
+        for (auto &c: folded) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        return folded;
+    }
+
+    [[nodiscard]] std::filesystem::path logPath() const { return std::filesystem::path(base_) += ".log"; }
+
+    [[nodiscard]] std::filesystem::path indexPath() const { return std::filesystem::path(base_) += ".idx"; }
+
+    uint64_t indexCount(std::string_view word) const {
+        const auto *end = records_ + recordCount_;
+        const auto *it = std::lower_bound(records_, end, word,
+                                          [](const Record &r, std::string_view w) { return r.view() < w; });
+        return it != end && it->view() == word ? it->count : 0;
+    }
+
+    void unmap() {
+        if (mapped_) {
+            munmap(mapped_, mappedSize_);
+        }
+        mapped_ = nullptr;
+        mappedSize_ = 0;
+        records_ = nullptr;
+        recordCount_ = 0;
+    }
+
+    struct Mapping {
+        void *mapped = nullptr;
+        size_t size = 0;
+        uint64_t sequence = 0;
+        uint64_t records = 0;
+    };
+
+    // map index file without touching the one in use; an unreadable or malformed one counts as empty
+    Mapping openIndex() const {
+        Mapping m;
+        const int fd = open(indexPath().c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st{};
+        if (fd >= 0 && fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(Header)) {
+            m.size = static_cast<size_t>(st.st_size);
+            m.mapped = mmap(nullptr, m.size, PROT_READ, MAP_SHARED, fd, 0);
+            if (m.mapped == MAP_FAILED) {
+                m.mapped = nullptr;
+            }
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (m.mapped) {
+            Header header{};
+            std::memcpy(&header, m.mapped, sizeof(Header));
+            if (std::memcmp(header.magic, Magic, sizeof(Magic)) == 0 && header.version == Version &&
+                m.size == sizeof(Header) + header.records * sizeof(Record)) {
+                m.sequence = header.sequence;
+                m.records = header.records;
+            } else {
+                munmap(m.mapped, m.size);
+                m.mapped = nullptr;
+            }
+        }
+        if (!m.mapped) {
+            m.size = 0;
+        }
+        return m;
+    }
+
+    // replace the index in use; with mutex_ held
+    void install(const Mapping &m) {
+        unmap();
+        if (m.mapped) {
+            mapped_ = m.mapped;
+            mappedSize_ = m.size;
+            records_ = reinterpret_cast<const Record *>(static_cast<const char *>(m.mapped) + sizeof(Header));
+            recordCount_ = m.records;
+        }
+        indexSequence_ = m.sequence;
+    }
+
+    void mapIndex() {
+        const auto m = openIndex();
+        std::lock_guard lock(mutex_);
+        install(m);
+    }
+
+    void syncDirectory() const {
+        const auto dir = base_.has_parent_path() ? base_.parent_path() : std::filesystem::path(".");
+        const int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+    }
+
+    // count log lines the index does not include yet
+    void replayLog() {
+        sequence_ = indexSequence_;
+        FILE *f = std::fopen(logPath().c_str(), "r");
+        if (!f) {
+            return;
+        }
+        std::unordered_map<std::string, uint64_t> replayed;
+        char line[64];
+        while (std::fgets(line, sizeof(line), f)) {
+            unsigned long long seq = 0;
+            char word[MaxWordSize + 1];
+            // a torn last line fails to parse, or has no newline
+            if (!std::strchr(line, '\n') || std::sscanf(line, "%llu %31s", &seq, word) != 2) {
+                continue;
+            }
+            sequence_ = std::max<uint64_t>(sequence_, seq);
+            if (seq > indexSequence_) {
+                replayed[word]++;
+                logLines_++;
+            }
+        }
+        std::fclose(f);
+        std::lock_guard lock(mutex_);
+        delta_ = std::move(replayed);
+    }
+
+    void append(const std::vector<std::string> &words) {
+        if (!log_) {
+            log_ = std::fopen(logPath().c_str(), "a");
+            if (!log_) {
+                return;
+            }
+        }
+        for (const auto &word: words) {
+            std::fprintf(log_, "%llu %s\n", static_cast<unsigned long long>(++sequence_), word.c_str());
+        }
+        std::fflush(log_);
+        fdatasync(fileno(log_));
+        logLines_ += words.size();
+        std::lock_guard lock(mutex_);
+        for (const auto &word: words) {
+            delta_[word]++;
+        }
+        stats_.logged += words.size();
+    }
+
+    static bool writeAll(FILE *f, const void *data, size_t size) {
+        return std::fwrite(data, 1, size, f) == size;
+    }
+
+    void compact() {
+        std::vector<std::pair<std::string, uint64_t>> merged;
+        {
+            std::lock_guard lock(mutex_);
+            merged.assign(delta_.begin(), delta_.end());
+        }
+        std::sort(merged.begin(), merged.end());
+        const auto tmpPath = std::filesystem::path(indexPath()) += ".tmp";
+        FILE *f = std::fopen(tmpPath.c_str(), "wb");
+        if (!f) {
+            return;
+        }
+        // the old index is immutable while mapped, read it without the lock
+        const Record *old = records_;
+        const size_t oldCount = recordCount_;
+        Header header{};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.sequence = sequence_;
+        bool ok = writeAll(f, &header, sizeof(header));
+        uint64_t records = 0;
+        auto write = [&](std::string_view word, uint64_t count) {
+            Record r{};
+            r.size = static_cast<uint8_t>(word.size());
+            std::memcpy(r.word, word.data(), word.size());
+            r.count = static_cast<uint32_t>(std::min<uint64_t>(count, UINT32_MAX));
+            ok = ok && writeAll(f, &r, sizeof(r));
+            records++;
+        };
+        size_t i = 0, j = 0;
+        while (i < oldCount || j < merged.size()) {
+            if (j == merged.size() || (i < oldCount && old[i].view() < merged[j].first)) {
+                write(old[i].view(), old[i].count);
+                i++;
+            } else if (i == oldCount || merged[j].first < old[i].view()) {
+                write(merged[j].first, merged[j].second);
+                j++;
+            } else {
+                write(old[i].view(), old[i].count + merged[j].second);
+                i++;
+                j++;
+            }
+        }
+        header.records = records;
+        ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && writeAll(f, &header, sizeof(header));
+        ok = ok && std::fflush(f) == 0 && fsync(fileno(f)) == 0;
+        std::fclose(f);
+        std::error_code ec;
+        if (!ok || (std::filesystem::rename(tmpPath, indexPath(), ec), ec)) {
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+        // the rename must be durable before the log it replaces is truncated
+        syncDirectory();
+        // new index includes every logged line, so the log can go; if this is lost in a crash
+        // its lines are skipped by sequence
+        if (log_) {
+            std::fclose(log_);
+            log_ = nullptr;
+        }
+        std::filesystem::resize_file(logPath(), 0, ec);
+        logLines_ = 0;
+        const auto compacted = sequence_;
+        const auto m = openIndex();
+        // readers see either the old index with delta_ or the new one without, never both
+        std::lock_guard lock(mutex_);
+        if (m.sequence == compacted) {
+            install(m);
+            delta_.clear();
+        } else if (m.mapped) {
+            // keep counting with the old index and delta_
+            munmap(m.mapped, m.size);
+        }
+        stats_.compactions++;
+    }
+
+    void run() {
+        std::error_code ec;
+        std::filesystem::create_directories(base_.parent_path(), ec);
+        mapIndex();
+        replayLog();
+        std::unique_lock lock(queueMutex_);
+        loaded_ = true;
+        doneCv_.notify_all();
+        while (true) {
+            queueCv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            std::vector<std::string> words(std::make_move_iterator(queue_.begin()),
+                                           std::make_move_iterator(queue_.end()));
+            queue_.clear();
+            const bool stopping = stopping_;
+            lock.unlock();
+            if (!words.empty()) {
+                append(words);
+            }
+            if (logLines_ >= compactThreshold_ && !stopping) {
+                compact();
+            }
+            lock.lock();
+            processed_ += words.size();
+            doneCv_.notify_all();
+            if (stopping && queue_.empty()) {
+                break;
+            }
+        }
+        lock.unlock();
+        if (log_) {
+            std::fclose(log_);
+            log_ = nullptr;
+        }
+    }
+};
+
+#endif //FCITX5_ANDROID_USERLEXICON_H
@@ -0,0 +1,165 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_WORDHINTCACHE_H
+#define FCITX5_ANDROID_WORDHINTCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct WordHintCacheStats {
+    // hints of exactly the same input, eg. after backspace
+    uint64_t hits = 0;
+    // hints filtered from those of a prefix, only for prefix ranked dictionaries
+    uint64_t derived = 0;
+    // lookups in the spell dictionary
+    uint64_t misses = 0;
+    // hints looked up off the fcitx thread after the input changed again, not shown
+    uint64_t discarded = 0;
+};
+
+/**
+ * Word hints of recent inputs of one input context, keyed on (language, input).
+ *
+ * Spell dictionaries rank hints by a fuzzy distance to the whole input and may return words it is
+ * not a prefix of, so in general only the same input is served from here: backspace and retyping a
+ * prefix go back to entries already looked up. That saves about one lookup in nine while typing
+ * (benchwordhint: 12.27 lookups per word without, 10.88 with). Hints of a prefix still make a fair
+ * guess to show until a lookup is done, see provisional().
+ *
+ * A dictionary that returns every completion of the input by a score of each word alone, up to a
+ * limit, is prefix ranked: hints of a longer input are those of a prefix that start with it, as
+ * long as the prefix had fewer than the limit. Given that limit, find() derives them instead of
+ * missing.
+ */
+class WordHintCache {
+public:
+    // display string and commit string, as returned by ISpell::hintForDisplay
+    using Hints = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @param prefixRankedLimit number of hints asked for if the dictionary is prefix ranked, 0 if
+     * it's not
+     */
+    explicit WordHintCache(WordHintCacheStats &stats, size_t capacity = 32, size_t prefixRankedLimit = 0)
+            : stats_(stats), capacity_(capacity < 1 ? 1 : capacity), prefixRankedLimit_(prefixRankedLimit) {}
+
+    // @return hints of `input` if it was looked up recently, or derived; valid until the next call
+    const Hints *find(const std::string &language, const std::string &input) {
+        if (auto *entry = findEntry(language, input)) {
+            stats_.hits++;
+            return &touch(entry)->hints;
+        }
+        if (prefixRankedLimit_ == 0) {
+            return nullptr;
+        }
+        for (size_t n = input.size(); n-- > 1;) {
+            const auto *prefix = findEntry(language, input.substr(0, n));
+            if (!prefix) {
+                continue;
+            }
+            // completions beyond the limit were never seen
+            if (prefix->hints.size() >= prefixRankedLimit_) {
+                return nullptr;
+            }
+            auto hints = completions(prefix->hints, input);
+            stats_.derived++;
+            return &insert(language, input, std::move(hints))->hints;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Hints of the longest prefix of `input` looked up, those it's a prefix of, to show while
+     * `input` is looked up; not the same as its own unless the dictionary is prefix ranked
+     */
+    [[nodiscard]] Hints provisional(const std::string &language, const std::string &input) const {
+        for (size_t n = input.size(); n-- > 1;) {
+            for (const auto &e: entries_) {
+                if (e.language == language && e.input.size() == n && input.starts_with(e.input)) {
+                    return completions(e.hints, input);
+                }
+            }
+        }
+        return {};
+    }
+
+    /**
+     * Store hints of `input` looked up in the spell module
+     * @return stored hints, valid until the next call
+     */
+    const Hints &put(const std::string &language, const std::string &input, Hints hints) {
+        stats_.misses++;
+        return insert(language, input, std::move(hints))->hints;
+    }
+
+    /**
+     * @param lookup called as `Hints lookup()` on miss, asking the spell module
+     * @return hints of `input`, valid until the next call
+     */
+    template<typename Lookup>
+    const Hints &get(const std::string &language, const std::string &input, Lookup &&lookup) {
+        if (const auto *hints = find(language, input)) {
+            return *hints;
+        }
+        return put(language, input, lookup());
+    }
+
+    void clear() { entries_.clear(); }
+
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        std::string language;
+        std::string input;
+        Hints hints;
+    };
+
+    WordHintCacheStats &stats_;
+    size_t capacity_;
+    size_t prefixRankedLimit_;
+    // least recently used first; a few dozen entries at most, the prefixes of recent words
+    std::vector<Entry> entries_;
+
+    Entry *findEntry(const std::string &language, const std::string &input) {
+        for (auto &e: entries_) {
+            if (e.input == input && e.language == language) return &e;
+        }
+        return nullptr;
+    }
+
+    Entry *insert(const std::string &language, const std::string &input, Hints hints) {
+        if (auto *entry = findEntry(language, input)) {
+            entry->hints = std::move(hints);
+            return touch(entry);
+        }
+        if (entries_.size() >= capacity_) {
+            entries_.erase(entries_.begin());
+        }
+        entries_.push_back({language, input, std::move(hints)});
+        return &entries_.back();
+    }
+
+    static Hints completions(const Hints &hints, const std::string &input) {
+        Hints result;
+        for (const auto &h: hints) {
+            if (h.second.starts_with(input)) result.push_back(h);
+        }
+        return result;
+    }
+
+    Entry *touch(Entry *entry) {
+        if (entry != &entries_.back()) {
+            Entry moved = std::move(*entry);
+            entries_.erase(entries_.begin() + (entry - entries_.data()));
+            entries_.push_back(std::move(moved));
+        }
+        return &entries_.back();
+    }
+};
+
+#endif //FCITX5_ANDROID_WORDHINTCACHE_H
@@ -0,0 +1,221 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_CANDIDATE_CURSOR_H
+#define FCITX5_ANDROID_CANDIDATE_CURSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+struct CandidateCursorStats {
+    uint64_t reads = 0;
+    // reads rejected because the list they were opened on has been replaced
+    uint64_t stale = 0;
+    // entries served from cache / fetched from the list
+    uint64_t hits = 0;
+    uint64_t fetched = 0;
+    uint64_t readaheads = 0;
+};
+
+/**
+ * Windowed reader of one candidate list instance.
+ *
+ * open() tags the list with a generation; reads carrying another generation are rejected,
+ * so a client can never page through a list that has been replaced.
+ * Fetched entries are cached as one contiguous range, and after each read the next window
+ * may be fetched ahead with readahead(), so scrolling forward costs one window per page no
+ * matter how deep the list is. Entries already converted elsewhere can be handed over with
+ * prime(), with the window after them fetched by the next readahead().
+ *
+ * `Fetch` is called as `bool fetch(int index, T &out)`, returning false past the end.
+ */
+template<typename T>
+class CandidateCursor {
+public:
+    explicit CandidateCursor(size_t maxCached = 256) : maxCached_(maxCached) {}
+
+    /**
+     * Start reading a new list, `total` is -1 if unknown
+     * @return generation of the list, never 0
+     */
+    uint32_t open(int total) {
+        if (++generationCounter_ == 0) {
+            generationCounter_ = 1;
+        }
+        generation_ = generationCounter_;
+        total_ = total;
+        // total may be unknown, in which case the end is found by fetch()
+        end_ = total < 0 ? -1 : total;
+        cache_.clear();
+        begin_ = 0;
+        readaheadOffset_ = -1;
+        return generation_;
+    }
+
+    // list is gone, reject all reads until next open()
+    void close() {
+        generation_ = 0;
+        cache_.clear();
+        readaheadOffset_ = -1;
+    }
+
+    [[nodiscard]] uint32_t generation() const { return generation_; }
+
+    [[nodiscard]] int total() const { return total_; }
+
+    [[nodiscard]] bool valid(uint32_t generation) const {
+        return generation != 0 && generation == generation_;
+    }
+
+    /**
+     * Read [offset, offset + limit) into `out`, fewer if the list ends earlier
+     * @return false if `generation` is stale
+     */
+    template<typename Fetch>
+    bool read(uint32_t generation, int offset, int limit, std::vector<T> &out, Fetch &&fetch) {
+        out.clear();
+        stats_.reads++;
+        if (!valid(generation)) {
+            stats_.stale++;
+            return false;
+        }
+        if (offset < 0 || limit <= 0) {
+            return true;
+        }
+        const auto fetched = stats_.fetched;
+        const int last = fill(offset, offset + limit, fetch);
+        out.reserve(last - offset);
+        for (int i = offset; i < last; i++) {
+            out.push_back(cache_[i - begin_]);
+        }
+        stats_.hits += (last - offset) - (stats_.fetched - fetched);
+        scheduleReadahead(last < offset + limit ? -1 : last, limit);
+        return true;
+    }
+
+    /**
+     * Cache `first`, entries [0, first.size()) of the open list, and schedule readahead of
+     * the next `limit` entries
+     */
+    void prime(const std::vector<T> &first, int limit) {
+        if (generation_ == 0) {
+            return;
+        }
+        cache_.assign(first.begin(), first.end());
+        begin_ = 0;
+        scheduleReadahead(limit <= 0 ? -1 : static_cast<int>(first.size()), limit);
+    }
+
+    // false when the window after the last read is already cached, or past the end
+    [[nodiscard]] bool readaheadPending() const { return readaheadOffset_ >= 0; }
+
+    // fetch the window after the last read, if it has not been done yet
+    template<typename Fetch>
+    void readahead(Fetch &&fetch) {
+        if (readaheadOffset_ < 0 || generation_ == 0) {
+            return;
+        }
+        const int offset = readaheadOffset_;
+        readaheadOffset_ = -1;
+        const auto before = stats_.fetched;
+        fill(offset, offset + readaheadLimit_, fetch);
+        if (stats_.fetched != before) {
+            stats_.readaheads++;
+        }
+    }
+
+    [[nodiscard]] const CandidateCursorStats &stats() const { return stats_; }
+
+    void resetStats() { stats_ = {}; }
+
+private:
+    size_t maxCached_;
+    uint32_t generationCounter_ = 0;
+    // 0 if no list is open
+    uint32_t generation_ = 0;
+    int total_ = -1;
+    // one past the last entry, -1 if not known yet
+    int end_ = -1;
+    // cache_ holds entries [begin_, begin_ + cache_.size())
+    std::deque<T> cache_;
+    int begin_ = 0;
+    int readaheadOffset_ = -1;
+    int readaheadLimit_ = 0;
+    CandidateCursorStats stats_;
+
+    [[nodiscard]] int cacheEnd() const { return begin_ + static_cast<int>(cache_.size()); }
+
+    // -1 or a window that would need no fetch leaves nothing to read ahead
+    void scheduleReadahead(int offset, int limit) {
+        readaheadLimit_ = limit;
+        int last = offset + limit;
+        if (end_ >= 0 && last > end_) {
+            last = end_;
+        }
+        const bool cached = offset >= begin_ && last <= cacheEnd();
+        readaheadOffset_ = offset < 0 || offset >= last || cached ? -1 : offset;
+    }
+
+    /**
+     * Make [offset, last) cached, as far as the list goes
+     * @return end of the available range, at most `last`
+     */
+    template<typename Fetch>
+    int fill(int offset, int last, Fetch &fetch) {
+        if (end_ >= 0 && last > end_) {
+            last = end_;
+        }
+        if (offset >= last) {
+            return offset;
+        }
+        if (offset < begin_ && last >= begin_ && !cache_.empty()) {
+            // scrolling back, prepend the missing part
+            std::vector<T> front;
+            for (int i = offset; i < begin_; i++) {
+                T value;
+                if (!fetch(i, value)) {
+                    // list is shorter than it used to be, should not happen within a generation
+                    cache_.clear();
+                    break;
+                }
+                front.push_back(std::move(value));
+                stats_.fetched++;
+            }
+            if (!cache_.empty()) {
+                cache_.insert(cache_.begin(), std::make_move_iterator(front.begin()), std::make_move_iterator(front.end()));
+                begin_ = offset;
+            }
+        }
+        if (offset < begin_ || offset > cacheEnd()) {
+            // not adjacent to what we have, start a new range
+            cache_.clear();
+            begin_ = offset;
+        }
+        while (cacheEnd() < last) {
+            T value;
+            if (!fetch(cacheEnd(), value)) {
+                end_ = cacheEnd();
+                last = end_;
+                break;
+            }
+            cache_.push_back(std::move(value));
+            stats_.fetched++;
+        }
+        // keep the requested window, drop entries farthest from it
+        while (cache_.size() > maxCached_ && begin_ < offset) {
+            cache_.pop_front();
+            begin_++;
+        }
+        while (cache_.size() > maxCached_ && cacheEnd() > last) {
+            cache_.pop_back();
+        }
+        return last;
+    }
+};
+
+#endif //FCITX5_ANDROID_CANDIDATE_CURSOR_H
@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_CANDIDATE_DELTA_H
+#define FCITX5_ANDROID_CANDIDATE_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Encode a candidate list against the previously pushed one.
+ *
+ * Ops are pairs of int32:
+ *   (start, length) keep `length` entries of the previous list starting at `start`
+ *   (Insert, count) take next `count` entries from the inserted ones
+ *
+ * Keep in sync with org.fcitx.fcitx5.android.core.CandidateDelta
+ */
+namespace candidate_delta {
+
+constexpr int32_t Insert = -1;
+
+/**
+ * @param inserted receives indices into `next` of entries that must be sent
+ * @return ops; empty if the delta, an op pair or an inserted entry each, is no smaller than
+ * `next`, in which case a full push is cheaper
+ */
+template<typename T>
+std::vector<int32_t> encode(const std::vector<T> &prev, const std::vector<T> &next,
+                            std::vector<size_t> &inserted) {
+    std::vector<int32_t> ops;
+    inserted.clear();
+    if (prev.empty() || next.empty()) {
+        return ops;
+    }
+    size_t kept = 0;
+    // previous index matched by the last entry, to extend a run without searching
+    size_t lastMatch = SIZE_MAX;
+    const auto append = [&ops](int32_t first, int32_t second) {
+        ops.push_back(first);
+        ops.push_back(second);
+    };
+    for (size_t i = 0; i < next.size(); i++) {
+        size_t match = SIZE_MAX;
+        if (lastMatch != SIZE_MAX && lastMatch + 1 < prev.size() && prev[lastMatch + 1] == next[i]) {
+            match = lastMatch + 1;
+        } else {
+            for (size_t j = 0; j < prev.size(); j++) {
+                if (prev[j] == next[i]) {
+                    match = j;
+                    break;
+                }
+            }
+        }
+        const size_t opsSize = ops.size();
+        if (match == SIZE_MAX) {
+            inserted.push_back(i);
+            if (opsSize > 0 && ops[opsSize - 2] == Insert) {
+                ops[opsSize - 1]++;
+            } else {
+                append(Insert, 1);
+            }
+        } else {
+            kept++;
+            if (opsSize > 0 && ops[opsSize - 2] != Insert && lastMatch != SIZE_MAX && match == lastMatch + 1) {
+                ops[opsSize - 1]++;
+            } else {
+                append(static_cast<int32_t>(match), 1);
+            }
+        }
+        lastMatch = match;
+    }
+    if (kept == 0 || ops.size() / 2 + inserted.size() >= next.size()) {
+        ops.clear();
+        inserted.clear();
+    }
+    return ops;
+}
+
+/**
+ * Rebuild the list from previous list, inserted entries and ops, for tests.
+ * @return false if ops don't match the inputs
+ */
+template<typename T>
+bool apply(const std::vector<T> &prev, const std::vector<T> &inserted,
+           const std::vector<int32_t> &ops, std::vector<T> &out) {
+    out.clear();
+    size_t next = 0;
+    for (size_t i = 0; i + 1 < ops.size(); i += 2) {
+        const auto first = ops[i];
+        const auto second = ops[i + 1];
+        if (second < 0) return false;
+        if (first == Insert) {
+            if (next + second > inserted.size()) return false;
+            out.insert(out.end(), inserted.begin() + next, inserted.begin() + next + second);
+            next += second;
+        } else {
+            if (first < 0 || static_cast<size_t>(first) + second > prev.size()) return false;
+            out.insert(out.end(), prev.begin() + first, prev.begin() + first + second);
+        }
+    }
+    return next == inserted.size();
+}
+
+} // namespace candidate_delta
+
+#endif //FCITX5_ANDROID_CANDIDATE_DELTA_H
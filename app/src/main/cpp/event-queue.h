@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_EVENT_QUEUE_H
+#define FCITX5_ANDROID_EVENT_QUEUE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+struct EventQueueStats {
+    uint64_t delivered = 0;
+    // events posted while the queue already held HighWater events; they are still queued
+    uint64_t overflowed = 0;
+    uint64_t batches = 0;
+    size_t peakDepth = 0;
+    int64_t maxAgeNanos = 0;
+    int64_t totalAgeNanos = 0;
+};
+
+/**
+ * Deferred UI events: produced by frontend callbacks while fcitx is processing input,
+ * delivered in order by drain() once the event loop iteration is done.
+ * Not thread safe, both sides run on the thread that drives the event loop.
+ * There is no limit on depth; HighWater only marks where posting counts as overflow.
+ */
+template<size_t HighWater = 256, typename Clock = std::chrono::steady_clock>
+class EventQueue {
+public:
+    using Dispatch = std::function<void()>;
+
+    void post(Dispatch dispatch) {
+        if (pending_.size() >= HighWater) {
+            stats_.overflowed++;
+        }
+        pending_.push_back({std::move(dispatch), Clock::now()});
+        if (pending_.size() > stats_.peakDepth) {
+            stats_.peakDepth = pending_.size();
+        }
+    }
+
+    // returns number of events delivered; events posted by handlers are delivered in the same drain
+    size_t drain() {
+        size_t count = 0;
+        while (!pending_.empty()) {
+            // keep both buffers around, so that steady state does not allocate
+            delivering_.swap(pending_);
+            for (auto &entry: delivering_) {
+                const auto age = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - entry.enqueued).count();
+                stats_.totalAgeNanos += age;
+                if (age > stats_.maxAgeNanos) {
+                    stats_.maxAgeNanos = age;
+                }
+                entry.dispatch();
+                count++;
+            }
+            delivering_.clear();
+        }
+        if (count > 0) {
+            stats_.delivered += count;
+            stats_.batches++;
+        }
+        return count;
+    }
+
+    [[nodiscard]] size_t depth() const { return pending_.size(); }
+
+    [[nodiscard]] const EventQueueStats &stats() const { return stats_; }
+
+    void resetStats() { stats_ = {}; }
+
+private:
+    struct Entry {
+        Dispatch dispatch;
+        typename Clock::time_point enqueued;
+    };
+
+    std::vector<Entry> pending_;
+    std::vector<Entry> delivering_;
+    EventQueueStats stats_;
+};
+
+#endif //FCITX5_ANDROID_EVENT_QUEUE_H
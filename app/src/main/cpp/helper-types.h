@@ -12,8 +12,49 @@
 #include <fcitx/inputmethodengine.h>
 #include <fcitx/inputmethodentry.h>
 #include <fcitx/candidatelist.h>
+#include <fcitx/text.h>
 
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
+
+#include "utf16-utils.h"
+
+/**
+ * Running FNV-1a digest, for telling whether UI state already sent to JVM has changed
+ * without keeping a copy of it
+ */
+class Digest {
+public:
+    Digest &add(const std::string &s) {
+        add(static_cast<uint64_t>(s.size()));
+        for (const char c: s) {
+            mix(static_cast<uint8_t>(c));
+        }
+        return *this;
+    }
+
+    Digest &add(uint64_t v) {
+        for (int i = 0; i < 8; i++) {
+            mix(static_cast<uint8_t>(v >> (i * 8)));
+        }
+        return *this;
+    }
+
+    [[nodiscard]] uint64_t value() const { return value_; }
+
+private:
+    uint64_t value_ = 14695981039346656037ull;
+
+    void mix(uint8_t b) {
+        value_ ^= b;
+        value_ *= 1099511628211ull;
+    }
+};
 
 class InputMethodStatus {
 public:
@@ -46,6 +87,12 @@ public:
         subModeLabel = engine->subModeLabel(*entry, *ic);
         subModeIcon = engine->subModeIcon(*entry, *ic);
     }
+
+    void addTo(Digest &digest) const {
+        digest.add(uniqueName).add(name).add(nativeName).add(icon).add(label)
+                .add(languageCode).add(addon).add(static_cast<uint64_t>(configurable))
+                .add(subMode).add(subModeLabel).add(subModeIcon);
+    }
 };
 
 class AddonStatus {
@@ -68,6 +115,8 @@ public:
     std::string icon;
     std::string shortText;
     std::string longText;
+    // submenus are not converted along with the action, an empty one only tells that the
+    // action has a menu, which JVM asks for by id when needed; see menuOf
     std::optional<std::vector<ActionEntity>> menu;
 
     ActionEntity(fcitx::Action *act, fcitx::InputContext *ic) :
@@ -79,13 +128,29 @@ public:
             icon(act->icon(ic)),
             shortText(act->shortText(ic)),
             longText(act->longText(ic)) {
-        const auto m = act->menu();
-        if (m) {
+        if (act->menu()) {
             menu = std::vector<ActionEntity>();
+        }
+    }
+
+    // entries of the menu of `act`, one level deep
+    static std::vector<ActionEntity> menuOf(fcitx::Action *act, fcitx::InputContext *ic) {
+        std::vector<ActionEntity> entries;
+        if (const auto m = act->menu()) {
             for (auto a: m->actions()) {
-                menu->emplace_back(ActionEntity(a, ic));
+                entries.emplace_back(a, ic);
             }
         }
+        return entries;
+    }
+
+    void addTo(Digest &digest) const {
+        digest.add(static_cast<uint64_t>(id))
+                .add((isSeparator ? 1u : 0u) | (isCheckable ? 2u : 0u) | (isChecked ? 4u : 0u) | (menu ? 8u : 0u))
+                .add(name)
+                .add(icon)
+                .add(shortText)
+                .add(longText);
     }
 };
 
@@ -126,6 +191,11 @@ public:
             text(std::move(text)),
             comment(std::move(comment)),
             spaceBetweenComment(spaceBetweenComment) {}
+
+    bool operator==(const CandidateEntity &other) const {
+        return spaceBetweenComment == other.spaceBetweenComment && text == other.text &&
+               comment == other.comment && label == other.label;
+    }
 };
 
 class PagedCandidateEntity {
@@ -157,4 +227,185 @@ private:
 
 PagedCandidateEntity PagedCandidateEntity::Empty = PagedCandidateEntity();
 
+/**
+ * Candidate list serialized into a single reusable byte buffer, so that it can be handed to
+ * JVM as one direct ByteBuffer instead of one CandidateWord object per candidate.
+ *
+ * Layout (native byte order):
+ *   int32 count
+ *   int32 position of offsets table
+ *   entries: uint16 flags, then label, text, comment as (uint16 length, char16_t[length])
+ *   int32 offsets[count], position of each entry, 4-byte aligned
+ *
+ * Keep in sync with org.fcitx.fcitx5.android.core.CandidateBuffer
+ */
+class CandidateBuffer {
+public:
+    static constexpr uint16_t SpaceBetweenComment = 1;
+
+    CandidateBuffer() { clear(); }
+
+    void clear() {
+        data_.resize(HeaderSize);
+        offsets_.clear();
+        put<int32_t>(0, 0);
+        put<int32_t>(sizeof(int32_t), HeaderSize);
+    }
+
+    void append(const CandidateEntity &c) {
+        offsets_.push_back(static_cast<int32_t>(data_.size()));
+        appendValue<uint16_t>(c.spaceBetweenComment ? SpaceBetweenComment : 0);
+        appendString(c.label);
+        appendString(c.text);
+        appendString(c.comment);
+    }
+
+    // write count and offsets table; must be called before handing data() out
+    void finish() {
+        data_.resize((data_.size() + 3) & ~static_cast<size_t>(3));
+        const auto table = data_.size();
+        const auto count = offsets_.size();
+        data_.resize(table + count * sizeof(int32_t));
+        if (count > 0) {
+            std::memcpy(data_.data() + table, offsets_.data(), count * sizeof(int32_t));
+        }
+        put<int32_t>(0, static_cast<int32_t>(count));
+        put<int32_t>(sizeof(int32_t), static_cast<int32_t>(table));
+    }
+
+    [[nodiscard]] int count() const { return static_cast<int>(offsets_.size()); }
+
+    [[nodiscard]] const uint8_t *data() const { return data_.data(); }
+
+    [[nodiscard]] size_t size() const { return data_.size(); }
+
+    // the storage is reused across pushes, its address only changes when it grows
+    [[nodiscard]] size_t capacity() const { return data_.capacity(); }
+
+private:
+    static constexpr size_t HeaderSize = 2 * sizeof(int32_t);
+    static constexpr size_t MaxStringLength = UINT16_MAX;
+
+    std::vector<uint8_t> data_;
+    std::vector<int32_t> offsets_;
+
+    template<typename T>
+    void put(size_t pos, T value) {
+        std::memcpy(data_.data() + pos, &value, sizeof(T));
+    }
+
+    template<typename T>
+    void appendValue(T value) {
+        const auto pos = data_.size();
+        data_.resize(pos + sizeof(T));
+        put<T>(pos, value);
+    }
+
+    void appendString(const std::string &str) {
+        const auto pos = data_.size();
+        // UTF-16 never needs more code units than UTF-8 bytes
+        data_.resize(pos + sizeof(uint16_t) + str.size() * sizeof(char16_t));
+        auto *units = reinterpret_cast<char16_t *>(data_.data() + pos + sizeof(uint16_t));
+        auto length = utf16::fromUtf8(str.data(), str.size(), units);
+        if (length > MaxStringLength) {
+            length = MaxStringLength;
+        }
+        put<uint16_t>(pos, static_cast<uint16_t>(length));
+        data_.resize(pos + sizeof(uint16_t) + length * sizeof(char16_t));
+    }
+};
+
+/**
+ * UI changes of the active input context, collected while fcitx handles one key or one
+ * event loop iteration, and delivered to JVM at once.
+ * Commits, surrounding text deletions and forwarded keys are kept in order; for client preedit,
+ * input panel, candidates and status area only the latest state is kept.
+ *
+ * Keep `Action` in sync with org.fcitx.fcitx5.android.core.Fcitx.handleUITransactionEvent
+ */
+class UITransaction {
+public:
+    enum class Action : int32_t {
+        // cursor; text in strings
+        CommitString = 0,
+        // before, after
+        DeleteSurrounding = 1,
+        // sym, states, unicode, up, timestamp
+        ForwardKey = 2
+    };
+    // action type followed by 5 arguments
+    static constexpr size_t ActionStride = 6;
+
+    struct InputPanel {
+        fcitx::Text preedit;
+        fcitx::Text auxUp;
+        fcitx::Text auxDown;
+        std::vector<CandidateActionEntity> tabs;
+    };
+
+    struct Candidates {
+        // 0 for bulk, otherwise paged
+        int pagingMode = 0;
+        // total for bulk, cursorIndex for paged
+        int total = 0;
+        fcitx::CandidateLayoutHint layoutHint = fcitx::CandidateLayoutHint::NotSet;
+        bool hasPrev = false;
+        bool hasNext = false;
+        // bulk only, identifies the list so that the next push can be a delta against it
+        uint32_t generation = 0;
+        // generation `delta` applies to; 0 for a full push
+        uint32_t baseGeneration = 0;
+        // see candidate-delta.h; candidateBuffer only contains inserted entries if not empty
+        std::vector<int32_t> delta;
+    };
+
+    struct StatusArea {
+        std::vector<ActionEntity> actions;
+        InputMethodStatus status;
+    };
+
+    std::vector<int32_t> actions;
+    std::vector<std::string> strings;
+    std::optional<fcitx::Text> clientPreedit;
+    std::optional<InputPanel> inputPanel;
+    std::optional<Candidates> candidates;
+    // content of `candidates`, reused across transactions
+    CandidateBuffer candidateBuffer;
+    std::optional<StatusArea> statusArea;
+
+    void commitString(const std::string &text, int cursor) {
+        appendAction(Action::CommitString, {cursor});
+        strings.emplace_back(text);
+    }
+
+    void deleteSurrounding(int before, int after) {
+        appendAction(Action::DeleteSurrounding, {before, after});
+    }
+
+    void forwardKey(int sym, uint32_t states, uint32_t unicode, bool up, int timestamp) {
+        appendAction(Action::ForwardKey, {sym, static_cast<int32_t>(states),
+                                          static_cast<int32_t>(unicode), up ? 1 : 0, timestamp});
+    }
+
+    [[nodiscard]] bool empty() const {
+        return actions.empty() && !clientPreedit && !inputPanel && !candidates && !statusArea;
+    }
+
+    void clear() {
+        actions.clear();
+        strings.clear();
+        clientPreedit.reset();
+        inputPanel.reset();
+        candidates.reset();
+        statusArea.reset();
+    }
+
+private:
+    void appendAction(Action type, std::initializer_list<int32_t> args) {
+        actions.push_back(static_cast<int32_t>(type));
+        actions.insert(actions.end(), args);
+        actions.resize(actions.size() + ActionStride - 1 - args.size(), 0);
+    }
+};
+
 #endif //FCITX5_ANDROID_HELPER_TYPES_H
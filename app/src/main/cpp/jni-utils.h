@@ -7,7 +7,17 @@
 
 #include <jni.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utf16-utils.h"
 
 void throwJavaException(JNIEnv *env, const char *msg) {
     jclass c = env->FindClass("java/lang/Exception");
@@ -54,6 +64,23 @@ public:
     T operator*() { return ref_; }
 };
 
+/**
+ * Create Java string from standard UTF-8. NewStringUTF expects modified UTF-8, which rejects
+ * 4-byte sequences (emoji, CJK extension B) and decodes byte by byte.
+ */
+jstring newJStringFromUtf8(JNIEnv *env, const char *chars, size_t length) {
+    constexpr size_t StackSize = 256;
+    char16_t stack[StackSize];
+    std::unique_ptr<char16_t[]> heap;
+    char16_t *units = stack;
+    if (length > StackSize) {
+        heap = std::make_unique<char16_t[]>(length);
+        units = heap.get();
+    }
+    const auto size = utf16::fromUtf8(chars, length, units);
+    return env->NewString(reinterpret_cast<const jchar *>(units), static_cast<jsize>(size));
+}
+
 class JString {
 private:
     JNIEnv *env_;
@@ -61,10 +88,10 @@ private:
 
 public:
     JString(JNIEnv *env, const char *chars)
-            : env_(env), jstring_(env->NewStringUTF(chars)) {}
+            : env_(env), jstring_(newJStringFromUtf8(env, chars, std::strlen(chars))) {}
 
     JString(JNIEnv *env, const std::string &string)
-            : JString(env, string.c_str()) {}
+            : env_(env), jstring_(newJStringFromUtf8(env, string.data(), string.size())) {}
 
     ~JString() {
         env_->DeleteLocalRef(jstring_);
@@ -75,6 +102,36 @@ public:
     jstring operator*() { return jstring_; }
 };
 
+/**
+ * Native memory exposed to JVM as a direct ByteBuffer. The memory and the global reference
+ * to the ByteBuffer are reused, a new ByteBuffer is only created when the memory grows.
+ */
+class JDirectByteBuffer {
+private:
+    std::vector<uint8_t> storage_;
+    jobject buffer_ = nullptr;
+
+public:
+    // returned reference is owned by this object, don't delete it
+    jobject assign(JNIEnv *env, const uint8_t *data, size_t size) {
+        if (size > storage_.size()) {
+            storage_.resize(std::max(size, storage_.size() * 2));
+            if (buffer_) {
+                env->DeleteGlobalRef(buffer_);
+                buffer_ = nullptr;
+            }
+        }
+        if (size > 0) {
+            std::memcpy(storage_.data(), data, size);
+        }
+        if (!buffer_) {
+            auto local = JRef(env, env->NewDirectByteBuffer(storage_.data(), static_cast<jlong>(storage_.size())));
+            buffer_ = env->NewGlobalRef(local);
+        }
+        return buffer_;
+    }
+};
+
 class JEnv {
 private:
     JNIEnv *env = nullptr;
@@ -91,6 +148,102 @@ public:
     JNIEnv *operator->() { return env; }
 };
 
+struct JStringPoolStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t size;
+    size_t bytes;
+};
+
+/**
+ * Global references to Java strings that recur on every UI update, keyed by content:
+ * candidate labels, icon names, input method and action names.
+ * Least recently used strings are released once the estimated memory exceeds `maxBytes`.
+ */
+class JStringPool {
+public:
+    // longer strings are unlikely to recur, and would evict many short ones
+    static constexpr size_t MaxLength = 64;
+
+    explicit JStringPool(size_t maxBytes = 64 * 1024) : maxBytes_(maxBytes) {}
+
+    /**
+     * @return new local reference to the interned string, which stays valid even if the string
+     * is evicted later; or nullptr if `str` is not worth interning
+     */
+    jstring get(JNIEnv *env, const std::string &str) {
+        if (str.size() > MaxLength) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = map_.find(str);
+        if (it != map_.end()) {
+            hits_++;
+            lru_.splice(lru_.begin(), lru_, it->second.node);
+            return reinterpret_cast<jstring>(env->NewLocalRef(it->second.ref));
+        }
+        misses_++;
+        auto local = newJStringFromUtf8(env, str.data(), str.size());
+        auto ref = reinterpret_cast<jstring>(env->NewGlobalRef(local));
+        it = map_.emplace(str, Entry{ref, {}}).first;
+        lru_.push_front(&it->first);
+        it->second.node = lru_.begin();
+        bytes_ += entryBytes(str);
+        while (bytes_ > maxBytes_ && lru_.size() > 1) {
+            evict(env);
+        }
+        return local;
+    }
+
+    // release all strings, e.g. when they may have changed after reloading config
+    void clear(JNIEnv *env) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &[_, entry]: map_) {
+            env->DeleteGlobalRef(entry.ref);
+        }
+        map_.clear();
+        lru_.clear();
+        bytes_ = 0;
+    }
+
+    JStringPoolStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {hits_, misses_, evictions_, map_.size(), bytes_};
+    }
+
+private:
+    struct Entry {
+        jstring ref;
+        std::list<const std::string *>::iterator node;
+    };
+
+    // key, Java chars, and bookkeeping
+    static size_t entryBytes(const std::string &str) {
+        return str.size() * 3 + 64;
+    }
+
+    void evict(JNIEnv *env) {
+        const auto *key = lru_.back();
+        lru_.pop_back();
+        auto it = map_.find(*key);
+        bytes_ -= entryBytes(it->first);
+        env->DeleteGlobalRef(it->second.ref);
+        map_.erase(it);
+        evictions_++;
+    }
+
+    std::mutex mutex_;
+    size_t maxBytes_;
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+    // node keys point to map keys, which are stable
+    std::unordered_map<std::string, Entry> map_;
+    std::list<const std::string *> lru_;
+};
+
 class GlobalRefSingleton {
 public:
     JavaVM *jvm;
@@ -108,6 +261,20 @@ public:
     jclass Fcitx;
     jmethodID ShowToast;
     jmethodID HandleFcitxEvent;
+    jmethodID HandleCandidateListEvent;
+    jmethodID HandleCommitStringEvent;
+    jmethodID HandleClientPreeditEvent;
+    jmethodID HandleInputPanelEvent;
+    jmethodID HandleReadyEvent;
+    jmethodID HandleKeyEvent;
+    jmethodID HandleIMChangeEvent;
+    jmethodID HandleStatusAreaEvent;
+    jmethodID HandleDeleteSurroundingEvent;
+    jmethodID HandlePagedCandidateEvent;
+    jmethodID HandleSwitchInputMethodEvent;
+    jmethodID HandleCandidateBufferEvent;
+    jmethodID HandlePagedCandidateBufferEvent;
+    jmethodID HandleUITransactionEvent;
 
     jclass InputMethodEntry;
     jmethodID InputMethodEntryInit;
@@ -130,7 +297,7 @@ public:
     jmethodID KeyInit;
 
     jclass FormattedText;
-    jmethodID FormattedTextFromByteCursor;
+    jmethodID FormattedTextInit;
 
     jclass PinyinCustomPhrase;
     jmethodID PinyinCustomPhraseInit;
@@ -161,6 +328,20 @@ public:
         Fcitx = reinterpret_cast<jclass>(env->NewGlobalRef(env->FindClass("org/fcitx/fcitx5/android/core/Fcitx")));
         ShowToast = env->GetStaticMethodID(Fcitx, "showToast", "(Ljava/lang/String;)V");
         HandleFcitxEvent = env->GetStaticMethodID(Fcitx, "handleFcitxEvent", "(I[Ljava/lang/Object;)V");
+        HandleCandidateListEvent = env->GetStaticMethodID(Fcitx, "handleCandidateListEvent", "(I[Lorg/fcitx/fcitx5/android/core/CandidateWord;)V");
+        HandleCommitStringEvent = env->GetStaticMethodID(Fcitx, "handleCommitStringEvent", "(Ljava/lang/String;I)V");
+        HandleClientPreeditEvent = env->GetStaticMethodID(Fcitx, "handleClientPreeditEvent", "(Lorg/fcitx/fcitx5/android/core/FormattedText;)V");
+        HandleInputPanelEvent = env->GetStaticMethodID(Fcitx, "handleInputPanelEvent", "(Lorg/fcitx/fcitx5/android/core/FormattedText;Lorg/fcitx/fcitx5/android/core/FormattedText;Lorg/fcitx/fcitx5/android/core/FormattedText;[Lorg/fcitx/fcitx5/android/core/CandidateAction;)V");
+        HandleReadyEvent = env->GetStaticMethodID(Fcitx, "handleReadyEvent", "()V");
+        HandleKeyEvent = env->GetStaticMethodID(Fcitx, "handleKeyEvent", "(IIIZI)V");
+        HandleIMChangeEvent = env->GetStaticMethodID(Fcitx, "handleIMChangeEvent", "(Lorg/fcitx/fcitx5/android/core/InputMethodEntry;)V");
+        HandleStatusAreaEvent = env->GetStaticMethodID(Fcitx, "handleStatusAreaEvent", "([Lorg/fcitx/fcitx5/android/core/Action;Lorg/fcitx/fcitx5/android/core/InputMethodEntry;)V");
+        HandleDeleteSurroundingEvent = env->GetStaticMethodID(Fcitx, "handleDeleteSurroundingEvent", "(II)V");
+        HandlePagedCandidateEvent = env->GetStaticMethodID(Fcitx, "handlePagedCandidateEvent", "([Lorg/fcitx/fcitx5/android/core/CandidateWord;IIZZ)V");
+        HandleSwitchInputMethodEvent = env->GetStaticMethodID(Fcitx, "handleSwitchInputMethodEvent", "(ILjava/lang/String;)V");
+        HandleCandidateBufferEvent = env->GetStaticMethodID(Fcitx, "handleCandidateBufferEvent", "(ILjava/nio/ByteBuffer;I)V");
+        HandlePagedCandidateBufferEvent = env->GetStaticMethodID(Fcitx, "handlePagedCandidateBufferEvent", "(Ljava/nio/ByteBuffer;IIIZZ)V");
+        HandleUITransactionEvent = env->GetStaticMethodID(Fcitx, "handleUITransactionEvent", "([I[Ljava/lang/String;Lorg/fcitx/fcitx5/android/core/FormattedText;[Lorg/fcitx/fcitx5/android/core/FormattedText;[Lorg/fcitx/fcitx5/android/core/CandidateAction;Ljava/nio/ByteBuffer;I[I[I[Lorg/fcitx/fcitx5/android/core/Action;Lorg/fcitx/fcitx5/android/core/InputMethodEntry;)V");
 
         InputMethodEntry = reinterpret_cast<jclass>(env->NewGlobalRef(env->FindClass("org/fcitx/fcitx5/android/core/InputMethodEntry")));
         InputMethodEntryInit = env->GetMethodID(InputMethodEntry, "<init>", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Z)V");
@@ -183,7 +364,7 @@ public:
         KeyInit = env->GetMethodID(Key, "<init>", "(IILjava/lang/String;Ljava/lang/String;)V");
 
         FormattedText = reinterpret_cast<jclass>(env->NewGlobalRef(env->FindClass("org/fcitx/fcitx5/android/core/FormattedText")));
-        FormattedTextFromByteCursor = env->GetStaticMethodID(FormattedText, "fromByteCursor", "([Ljava/lang/String;[II)Lorg/fcitx/fcitx5/android/core/FormattedText;");
+        FormattedTextInit = env->GetMethodID(FormattedText, "<init>", "([Ljava/lang/String;[I[II)V");
 
         PinyinCustomPhrase = reinterpret_cast<jclass>(env->NewGlobalRef(env->FindClass("org/fcitx/fcitx5/android/data/pinyin/customphrase/PinyinCustomPhrase")));
         PinyinCustomPhraseInit = env->GetMethodID(PinyinCustomPhrase, "<init>", "(Ljava/lang/String;ILjava/lang/String;)V");
@@ -198,9 +379,38 @@ public:
         CandidateInit = env->GetMethodID(Candidate, "<init>", "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;Z)V");
     }
 
+    JStringPool StringPool;
+
     [[nodiscard]] JEnv AttachEnv() const { return JEnv(jvm); }
 };
 
 extern GlobalRefSingleton *GlobalRef;
 
+/**
+ * Like JString, but takes the string from GlobalRef->StringPool when possible
+ */
+class JInternedString {
+private:
+    JNIEnv *env_;
+    jstring jstring_;
+
+public:
+    JInternedString(JNIEnv *env, const std::string &string)
+            : env_(env), jstring_(GlobalRef->StringPool.get(env, string)) {
+        if (!jstring_) {
+            jstring_ = newJStringFromUtf8(env, string.data(), string.size());
+        }
+    }
+
+    JInternedString(const JInternedString &) = delete;
+
+    ~JInternedString() {
+        env_->DeleteLocalRef(jstring_);
+    }
+
+    operator jstring() { return jstring_; }
+
+    jstring operator*() { return jstring_; }
+};
+
 #endif //FCITX5_ANDROID_JNI_UTILS_H
@@ -6,12 +6,11 @@
 
 #include <sys/stat.h>
 
+#include <atomic>
 #include <memory>
 #include <future>
 #include <fstream>
 
-#include <android/log.h>
-
 #include <uv.h>
 
 #include <fcitx/instance.h>
@@ -42,10 +41,13 @@
 
 #include "androidaddonloader/androidaddonloader.h"
 #include "androidfrontend/androidfrontend_public.h"
+#include "androidkeyboard/androidkeyboard_public.h"
 #include "jni-utils.h"
 #include "nativestreambuf.h"
 #include "helper-types.h"
 #include "object-conversion.h"
+#include "event-queue.h"
+#include "trace-event.h"
 
 
 class Fcitx {
@@ -78,10 +80,46 @@ public:
     }
 
     int loopOnce() {
-        return uv_run(get_event_base(), UV_RUN_ONCE);
+        // includes time blocked waiting for events, nested spans show the work
+        TraceSpan span("loopOnce", "loop");
+        // JVM jobs scheduled from now on run right after this iteration
+        inputScheduled_.store(false, std::memory_order_relaxed);
+        // deliver events produced by JNI calls since last iteration, before uv_run blocks
+        flushEvents();
+        const bool prefetch = p_frontend && p_frontend->call<fcitx::IAndroidFrontend::candidatePrefetchPending>();
+        if (prefetch) {
+            // don't block while a candidate window is waiting, wake up as soon as the loop is idle
+            p_dispatcher->schedule(nullptr);
+        }
+        const int r = uv_run(get_event_base(), UV_RUN_ONCE);
+        // an iteration that produced events, or input waiting in JVM, means the loop is busy;
+        // the window is then left to the next iteration, which schedules the wakeup again
+        const bool busy = flushEvents() > 0 || inputScheduled_.load(std::memory_order_relaxed);
+        if (prefetch && !busy) {
+            TraceSpan prefetchSpan("prefetchCandidates", "loop");
+            p_frontend->call<fcitx::IAndroidFrontend::prefetchCandidates>();
+        }
+        return r;
+    }
+
+    /**
+     * Defer an event to JVM until current event loop iteration finishes,
+     * so that fcitx never waits for Java handlers while processing input.
+     */
+    void postEvent(std::function<void()> dispatch) {
+        events_.post(std::move(dispatch));
+    }
+
+    const EventQueueStats &eventQueueStats() {
+        return events_.stats();
+    }
+
+    size_t eventQueueDepth() {
+        return events_.depth();
     }
 
     void startup(const std::function<void(fcitx::AddonInstance *)> &setupCallback) {
+        TraceSpan span("startup", "lifecycle");
         p_instance = std::make_unique<fcitx::Instance>(0, nullptr);
         p_instance->addonManager().registerLoader(std::make_unique<fcitx::AndroidSharedLibraryLoader>());
         p_dispatcher = std::make_unique<fcitx::EventDispatcher>();
@@ -92,10 +130,14 @@ public:
         p_quickphrase = addonMgr.addon("quickphrase");
         p_unicode = addonMgr.addon("unicode");
         p_clipboard = addonMgr.addon("clipboard", true);
+        p_tracer = p_frontend->call<fcitx::IAndroidFrontend::keystrokeTracer>();
         setupCallback(p_frontend);
     }
 
     void reloadConfig() {
+        TraceSpan span("reloadConfig", "config");
+        // names and icons of input methods and actions may change
+        GlobalRef->StringPool.clear(GlobalRef->AttachEnv());
         p_instance->reloadConfig();
         p_instance->refresh();
         auto &addonManager = p_instance->addonManager();
@@ -109,12 +151,35 @@ public:
                 p_instance->reloadAddonConfig(name);
             }
         }
+        resetOutputFilterCache();
     }
 
     void sendKey(fcitx::Key key, bool up, int timestamp) {
+        if (!up && p_tracer && p_tracer->enabled()) {
+            // timestamp of the press identifies spans of this keystroke
+            p_tracer->beginKeystroke(timestamp, KeystrokeTracer::now());
+        }
+        KeystrokeSpan span(p_tracer, KeystrokeStage::Jni);
+        TraceSpan traceSpan("sendKey", "input");
         p_frontend->call<fcitx::IAndroidFrontend::keyEvent>(key, up, timestamp);
     }
 
+    KeystrokeTracer *keystrokeTracer() {
+        return p_tracer;
+    }
+
+    // results are kept after tracing is turned off, and dropped when it's turned on again
+    void setKeystrokeTracing(bool enabled) {
+        if (enabled && !p_tracer->enabled()) {
+            p_tracer->reset();
+        }
+        p_tracer->setEnabled(enabled);
+    }
+
+    KeystrokeLatency keystrokeLatency() {
+        return p_tracer->latency();
+    }
+
     bool select(int idx) {
         return p_frontend->call<fcitx::IAndroidFrontend::selectCandidate>(idx);
     }
@@ -204,8 +269,10 @@ public:
     void setGlobalConfig(const fcitx::RawConfig &config) {
         p_instance->globalConfig().load(config, true);
         if (p_instance->globalConfig().safeSave()) {
+            TraceSpan span("reloadConfig", "config", "global");
             p_instance->reloadConfig();
         }
+        resetOutputFilterCache();
     }
 
     fcitx::AddonInstance *getAddonInstance(const std::string &addon) {
@@ -233,7 +300,10 @@ public:
         if (!addonInstance) {
             return;
         }
+        TraceSpan span("setAddonConfig", "config", addonName);
         addonInstance->setConfig(config);
+        // eg. chttrans conversion engine
+        resetOutputFilterCache();
     }
 
     std::unique_ptr<fcitx::RawConfig> getAddonSubConfig(const std::string &addonName, const std::string &path) {
@@ -253,7 +323,9 @@ public:
         if (!addonInstance) {
             return;
         }
+        TraceSpan span("setAddonSubConfig", "config", addonName + "/" + path);
         addonInstance->setSubConfig(path, config);
+        resetOutputFilterCache();
     }
 
     std::unique_ptr<fcitx::RawConfig> getInputMethodConfig(const std::string &imName) {
@@ -344,6 +416,7 @@ public:
         globalConfig.setEnabledAddons({enabledSet.begin(), enabledSet.end()});
         globalConfig.setDisabledAddons({disabledSet.begin(), disabledSet.end()});
         globalConfig.safeSave();
+        TraceSpan span("reloadConfig", "config", "addons");
         p_instance->reloadConfig();
     }
 
@@ -414,6 +487,57 @@ public:
         return p_frontend->call<fcitx::IAndroidFrontend::getCandidates>(offset, limit);
     }
 
+    uint32_t openCandidateCursor() {
+        return p_frontend->call<fcitx::IAndroidFrontend::openCandidateCursor>();
+    }
+
+    bool readCandidates(uint32_t generation, int offset, int limit, std::vector<CandidateEntity> &candidates) {
+        return p_frontend->call<fcitx::IAndroidFrontend::readCandidates>(generation, offset, limit, candidates);
+    }
+
+    void setInputContextCacheCapacity(int capacity) {
+        p_frontend->call<fcitx::IAndroidFrontend::setInputContextCacheCapacity>(capacity);
+    }
+
+    InputContextCacheStats inputContextCacheStats() {
+        return p_frontend->call<fcitx::IAndroidFrontend::inputContextCacheStats>();
+    }
+
+    void resetOutputFilterCache() {
+        if (!p_frontend) return;
+        p_frontend->call<fcitx::IAndroidFrontend::resetOutputFilterCache>();
+    }
+
+    OutputFilterCacheStats outputFilterCacheStats() {
+        return p_frontend->call<fcitx::IAndroidFrontend::outputFilterCacheStats>();
+    }
+
+    std::vector<ActionEntity> statusAreaMenu(int id) {
+        return p_frontend->call<fcitx::IAndroidFrontend::statusAreaMenu>(id);
+    }
+
+    StatusAreaStats statusAreaStats() {
+        return p_frontend->call<fcitx::IAndroidFrontend::statusAreaStats>();
+    }
+
+    // word hints of androidkeyboard are shown, nothing is left on its worker; true if it's not loaded
+    bool keyboardIdle() {
+        auto *keyboard = p_instance->addonManager().addon("androidkeyboard");
+        return !keyboard || keyboard->call<fcitx::IAndroidKeyboardEngine::idle>();
+    }
+
+    void setUIFrameBudget(int micros) {
+        p_frontend->call<fcitx::IAndroidFrontend::setUIFrameBudget>(micros);
+    }
+
+    FrameSchedulerStats uiFrameStats() {
+        return p_frontend->call<fcitx::IAndroidFrontend::uiFrameStats>();
+    }
+
+    void setCandidateWindowSize(int size) {
+        p_frontend->call<fcitx::IAndroidFrontend::setCandidateWindowSize>(size);
+    }
+
     std::vector<CandidateActionEntity> getCandidateActions(int idx) {
         auto actions = std::vector<CandidateActionEntity>();
         for (const auto &a: p_frontend->call<fcitx::IAndroidFrontend::getCandidateActions>(idx)) {
@@ -438,11 +562,16 @@ public:
         return p_frontend->call<fcitx::IAndroidFrontend::triggerCandidateListTabAction>(id);
     }
 
+    void resyncCandidates() {
+        p_frontend->call<fcitx::IAndroidFrontend::resyncCandidates>();
+    }
+
     void save() {
         p_instance->save();
     }
 
     void exit() {
+        TraceSpan span("exit", "lifecycle");
         // Make sure that the exec doesn't get blocked
         uv_stop(get_event_base());
         // Normally, we would use exec to drive the event loop.
@@ -452,10 +581,13 @@ public:
         p_instance->eventLoop().exec();
         p_dispatcher->detach();
         p_instance->exit();
+        events_.drain();
         resetGlobalPointers();
     }
 
+    // called from JVM threads when a job is queued for the fcitx thread
     void scheduleEmpty() {
+        inputScheduled_.store(true, std::memory_order_relaxed);
         p_dispatcher->schedule(nullptr);
     }
 
@@ -463,14 +595,28 @@ private:
     std::unique_ptr<fcitx::Instance> p_instance;
     std::unique_ptr<fcitx::EventDispatcher> p_dispatcher;
     fcitx::AddonInstance *p_frontend = nullptr;
+    KeystrokeTracer *p_tracer = nullptr;
     fcitx::AddonInstance *p_quickphrase = nullptr;
     fcitx::AddonInstance *p_unicode = nullptr;
     fcitx::AddonInstance *p_clipboard = nullptr;
+    EventQueue<> events_;
+    std::atomic<bool> inputScheduled_{false};
+
+    // returns number of events delivered
+    size_t flushEvents() {
+        TraceSpan span("flushEvents", "loop");
+        if (p_frontend) {
+            // UI changes of this iteration become a single event
+            p_frontend->call<fcitx::IAndroidFrontend::flushUITransaction>();
+        }
+        return events_.drain();
+    }
 
     void resetGlobalPointers() {
         p_instance.reset();
         p_dispatcher.reset();
         p_frontend = nullptr;
+        p_tracer = nullptr;
         p_quickphrase = nullptr;
         p_unicode = nullptr;
         p_clipboard = nullptr;
@@ -505,6 +651,17 @@ Java_org_fcitx_fcitx5_android_core_Fcitx_setupLogStream(JNIEnv *env, jclass claz
     Fcitx::setLogStream(stream, verbose);
 }
 
+/**
+ * Wrap a frontend callback so that its arguments are copied into the event queue,
+ * and it's called after current event loop iteration finishes.
+ */
+template<typename F>
+auto deferred(F callback) {
+    return [callback](const auto &...args) {
+        Fcitx::Instance().postEvent([callback, args...]() { callback(args...); });
+    };
+}
+
 extern "C"
 JNIEXPORT void JNICALL
 Java_org_fcitx_fcitx5_android_core_Fcitx_startupFcitx(
@@ -596,118 +753,166 @@ Java_org_fcitx_fcitx5_android_core_Fcitx_startupFcitx(
         auto candidatesArray = JRef<jobjectArray>(env, env->NewObjectArray(static_cast<int>(candidates.size()), GlobalRef->Candidate, nullptr));
         int i = 0;
         for (const auto &candidate: candidates) {
-            env->SetObjectArrayElement(candidatesArray, i++, candidateEntityToObject(env, candidate));
+            auto obj = JRef(env, candidateEntityToObject(env, candidate));
+            env->SetObjectArrayElement(candidatesArray, i++, obj);
         }
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(2, GlobalRef->Object, nullptr));
-        auto candidatesCount = JRef(env, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, total));
-        env->SetObjectArrayElement(vararg, 0, *candidatesCount);
-        env->SetObjectArrayElement(vararg, 1, *candidatesArray);
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 0, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleCandidateListEvent, total, *candidatesArray);
     };
     auto commitStringCallback = [](const std::string &str, const int cursor) {
         auto env = GlobalRef->AttachEnv();
-        auto stringCursor = JRef(env, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, cursor));
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(2, GlobalRef->Object, nullptr));
-        env->SetObjectArrayElement(vararg, 0, JString(env, str));
-        env->SetObjectArrayElement(vararg, 1, stringCursor);
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 1, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleCommitStringEvent, *JString(env, str), cursor);
     };
     auto preeditCallback = [](const fcitx::Text &clientPreedit) {
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(1, GlobalRef->FormattedText, nullptr));
-        env->SetObjectArrayElement(vararg, 0, fcitxTextToJObject(env, clientPreedit));
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 2, *vararg);
+        auto preedit = JRef(env, fcitxTextToJObject(env, clientPreedit));
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleClientPreeditEvent, *preedit);
     };
     auto inputPanelCallback = [](const fcitx::Text &preedit, const fcitx::Text &auxUp, const fcitx::Text &auxDown, const std::vector<CandidateActionEntity> &tabs) {
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(4, GlobalRef->Object, nullptr));
-        env->SetObjectArrayElement(vararg, 0, fcitxTextToJObject(env, preedit));
-        env->SetObjectArrayElement(vararg, 1, fcitxTextToJObject(env, auxUp));
-        env->SetObjectArrayElement(vararg, 2, fcitxTextToJObject(env, auxDown));
+        auto preeditObj = JRef(env, fcitxTextToJObject(env, preedit));
+        auto auxUpObj = JRef(env, fcitxTextToJObject(env, auxUp));
+        auto auxDownObj = JRef(env, fcitxTextToJObject(env, auxDown));
         auto tabsArray = JRef<jobjectArray>(env, env->NewObjectArray(static_cast<int>(tabs.size()), GlobalRef->CandidateAction, nullptr));
         int i = 0;
         for (const auto &tab: tabs) {
-            env->SetObjectArrayElement(tabsArray, i++, fcitxCandidateActionToObject(env, tab));
+            auto obj = JRef(env, fcitxCandidateActionToObject(env, tab));
+            env->SetObjectArrayElement(tabsArray, i++, obj);
         }
-        env->SetObjectArrayElement(vararg, 3, *tabsArray);
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 3, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleInputPanelEvent, *preeditObj, *auxUpObj, *auxDownObj, *tabsArray);
     };
     auto readyCallback = []() {
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(0, GlobalRef->Object, nullptr));
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 4, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleReadyEvent);
     };
     auto keyEventCallback = [](const int sym, const uint32_t states, const uint32_t unicode, const bool up, const int timestamp) {
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(5, GlobalRef->Object, nullptr));
-        env->SetObjectArrayElement(vararg, 0, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, sym));
-        env->SetObjectArrayElement(vararg, 1, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, states));
-        env->SetObjectArrayElement(vararg, 2, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, unicode));
-        env->SetObjectArrayElement(vararg, 3, env->NewObject(GlobalRef->Boolean, GlobalRef->BooleanInit, up));
-        env->SetObjectArrayElement(vararg, 4, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, timestamp));
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 5, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleKeyEvent,
+                                  sym,
+                                  static_cast<jint>(states),
+                                  static_cast<jint>(unicode),
+                                  static_cast<jboolean>(up),
+                                  timestamp);
     };
     auto imChangeCallback = [](const InputMethodStatus &status) {
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(2, GlobalRef->Object, nullptr));
         auto obj = JRef(env, fcitxInputMethodStatusToJObject(env, status));
-        env->SetObjectArrayElement(vararg, 0, obj);
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 6, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleIMChangeEvent, *obj);
     };
     auto statusAreaUpdateCallback = [](const std::vector<ActionEntity> &actions, const InputMethodStatus &status) {
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(2, GlobalRef->Object, nullptr));
-        auto actionArray = JRef<jobjectArray>(env, env->NewObjectArray(static_cast<int>(actions.size()), GlobalRef->Action, nullptr));
-        int i = 0;
-        for (const auto &a: actions) {
-            auto obj = JRef(env, fcitxActionToJObject(env, a));
-            env->SetObjectArrayElement(actionArray, i++, obj);
-        }
-        env->SetObjectArrayElement(vararg, 0, actionArray);
+        auto actionArray = JRef<jobjectArray>(env, fcitxActionsToJObjectArray(env, actions));
         auto statusObj = JRef(env, fcitxInputMethodStatusToJObject(env, status));
-        env->SetObjectArrayElement(vararg, 1, statusObj);
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 7, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleStatusAreaEvent, *actionArray, *statusObj);
     };
     auto deleteSurroundingCallback = [](const int before, const int after) {
-        std::array<int, 2> arr{before, after};
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(1, GlobalRef->Object, nullptr));
-        auto intArray = JRef<jintArray>(env, env->NewIntArray(2));
-        env->SetIntArrayRegion(intArray, 0, 2, arr.data());
-        env->SetObjectArrayElement(vararg, 0, intArray);
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 8, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleDeleteSurroundingEvent, before, after);
     };
     auto pagedCandidateCallback = [](const PagedCandidateEntity &paged) {
         auto env = GlobalRef->AttachEnv();
         const int size = static_cast<int>(paged.candidates.size());
-        if (size == 0) {
-            auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(0, GlobalRef->Object, nullptr));
-            env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 9, *vararg);
-            return;
-        }
         auto candidatesArray = JRef<jobjectArray>(env, env->NewObjectArray(size, GlobalRef->Candidate, nullptr));
         for (int i = 0; i < size; ++i) {
-            env->SetObjectArrayElement(candidatesArray, i, candidateEntityToObject(env, paged.candidates[i]));
+            auto obj = JRef(env, candidateEntityToObject(env, paged.candidates[i]));
+            env->SetObjectArrayElement(candidatesArray, i, obj);
         }
-        auto cursorIndex = JRef(env, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, paged.cursorIndex));
-        auto layoutHint = JRef(env, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, static_cast<int>(paged.layoutHint)));
-        auto hasPrev = JRef(env, env->NewObject(GlobalRef->Boolean, GlobalRef->BooleanInit, paged.hasPrev));
-        auto hasNext = JRef(env, env->NewObject(GlobalRef->Boolean, GlobalRef->BooleanInit, paged.hasNext));
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(5, GlobalRef->Object, nullptr));
-        env->SetObjectArrayElement(vararg, 0, candidatesArray);
-        env->SetObjectArrayElement(vararg, 1, cursorIndex);
-        env->SetObjectArrayElement(vararg, 2, layoutHint);
-        env->SetObjectArrayElement(vararg, 3, hasPrev);
-        env->SetObjectArrayElement(vararg, 4, hasNext);
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 9, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandlePagedCandidateEvent,
+                                  *candidatesArray,
+                                  paged.cursorIndex,
+                                  static_cast<int>(paged.layoutHint),
+                                  static_cast<jboolean>(paged.hasPrev),
+                                  static_cast<jboolean>(paged.hasNext));
     };
     auto switchInputMethodCallback = [](const int reason, const std::string &oldIM) {
         auto env = GlobalRef->AttachEnv();
-        auto vararg = JRef<jobjectArray>(env, env->NewObjectArray(2, GlobalRef->Object, nullptr));
-        auto reasonInteger = JRef(env, env->NewObject(GlobalRef->Integer, GlobalRef->IntegerInit, reason));
-        env->SetObjectArrayElement(vararg, 0, reasonInteger);
-        env->SetObjectArrayElement(vararg, 1, JString(env, oldIM));
-        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleFcitxEvent, 10, *vararg);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleSwitchInputMethodEvent, reason, *JString(env, oldIM));
+    };
+    auto candidateBufferCallback = [](const CandidateBuffer &buffer, const int total) {
+        static JDirectByteBuffer byteBuffer;
+        auto env = GlobalRef->AttachEnv();
+        auto jBuffer = byteBuffer.assign(env, buffer.data(), buffer.size());
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleCandidateBufferEvent,
+                                  total, jBuffer, static_cast<jint>(buffer.size()));
+    };
+    auto pagedCandidateBufferCallback = [](const CandidateBuffer &buffer, const int cursorIndex, const fcitx::CandidateLayoutHint layoutHint, const bool hasPrev, const bool hasNext) {
+        static JDirectByteBuffer byteBuffer;
+        auto env = GlobalRef->AttachEnv();
+        auto jBuffer = byteBuffer.assign(env, buffer.data(), buffer.size());
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandlePagedCandidateBufferEvent,
+                                  jBuffer,
+                                  static_cast<jint>(buffer.size()),
+                                  cursorIndex,
+                                  static_cast<int>(layoutHint),
+                                  static_cast<jboolean>(hasPrev),
+                                  static_cast<jboolean>(hasNext));
+    };
+    auto uiTransactionCallback = [](const UITransaction &t) {
+        auto *tracer = Fcitx::Instance().keystrokeTracer();
+        KeystrokeSpan span(tracer, KeystrokeStage::Callback);
+        TraceSpan traceSpan("uiTransaction", "ui");
+        static JDirectByteBuffer byteBuffer;
+        auto env = GlobalRef->AttachEnv();
+        const auto actionsSize = static_cast<jsize>(t.actions.size());
+        auto actions = JRef<jintArray>(env, env->NewIntArray(actionsSize));
+        env->SetIntArrayRegion(actions, 0, actionsSize, t.actions.data());
+        auto strings = JRef<jobjectArray>(env, env->NewObjectArray(static_cast<jsize>(t.strings.size()), GlobalRef->String, nullptr));
+        for (size_t i = 0; i < t.strings.size(); i++) {
+            env->SetObjectArrayElement(strings, static_cast<jsize>(i), JString(env, t.strings[i]));
+        }
+        // fields that have not changed are passed as null
+        auto clientPreedit = JRef(env, t.clientPreedit ? fcitxTextToJObject(env, *t.clientPreedit) : nullptr);
+        auto inputPanel = JRef<jobjectArray>(env, [&]() -> jobject {
+            if (!t.inputPanel) return nullptr;
+            auto array = env->NewObjectArray(3, GlobalRef->FormattedText, nullptr);
+            env->SetObjectArrayElement(array, 0, JRef(env, fcitxTextToJObject(env, t.inputPanel->preedit)));
+            env->SetObjectArrayElement(array, 1, JRef(env, fcitxTextToJObject(env, t.inputPanel->auxUp)));
+            env->SetObjectArrayElement(array, 2, JRef(env, fcitxTextToJObject(env, t.inputPanel->auxDown)));
+            return array;
+        }());
+        auto tabs = JRef<jobjectArray>(env, [&]() -> jobject {
+            if (!t.inputPanel) return nullptr;
+            const auto &entities = t.inputPanel->tabs;
+            auto array = env->NewObjectArray(static_cast<int>(entities.size()), GlobalRef->CandidateAction, nullptr);
+            int i = 0;
+            for (const auto &tab: entities) {
+                auto obj = JRef(env, fcitxCandidateActionToObject(env, tab));
+                env->SetObjectArrayElement(array, i++, obj);
+            }
+            return array;
+        }());
+        jobject candidates = nullptr;
+        jint candidatesSize = 0;
+        auto candidatesInfo = JRef<jintArray>(env, [&]() -> jobject {
+            if (!t.candidates) return nullptr;
+            const auto &c = *t.candidates;
+            const jint info[] = {c.pagingMode, c.total, static_cast<jint>(c.layoutHint), c.hasPrev, c.hasNext,
+                                 static_cast<jint>(c.generation), static_cast<jint>(c.baseGeneration)};
+            constexpr jsize size = sizeof(info) / sizeof(jint);
+            auto array = env->NewIntArray(size);
+            env->SetIntArrayRegion(array, 0, size, info);
+            return array;
+        }());
+        if (t.candidates) {
+            candidates = byteBuffer.assign(env, t.candidateBuffer.data(), t.candidateBuffer.size());
+            candidatesSize = static_cast<jint>(t.candidateBuffer.size());
+        }
+        auto candidatesDelta = JRef<jintArray>(env, [&]() -> jobject {
+            if (!t.candidates || t.candidates->delta.empty()) return nullptr;
+            const auto &delta = t.candidates->delta;
+            const auto size = static_cast<jsize>(delta.size());
+            auto array = env->NewIntArray(size);
+            env->SetIntArrayRegion(array, 0, size, delta.data());
+            return array;
+        }());
+        auto statusActions = JRef<jobjectArray>(env, t.statusArea ? fcitxActionsToJObjectArray(env, t.statusArea->actions) : nullptr);
+        auto imStatus = JRef(env, t.statusArea ? fcitxInputMethodStatusToJObject(env, t.statusArea->status) : nullptr);
+        env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleUITransactionEvent,
+                                  *actions, *strings, *clientPreedit, *inputPanel, *tabs,
+                                  candidates, candidatesSize, *candidatesInfo, *candidatesDelta,
+                                  *statusActions, *imStatus);
+        if (tracer && tracer->enabled()) {
+            tracer->endKeystroke(KeystrokeTracer::now());
+        }
     };
     auto toastCallback = [](const std::string &s) {
         auto env = GlobalRef->AttachEnv();
@@ -719,18 +924,23 @@ Java_org_fcitx_fcitx5_android_core_Fcitx_startupFcitx(
 
     Fcitx::Instance().startup([&](auto *androidfrontend) {
         FCITX_INFO() << "Setting up callback";
-        readyCallback();
-        androidfrontend->template call<fcitx::IAndroidFrontend::setCandidateListCallback>(candidateListCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setCommitStringCallback>(commitStringCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setPreeditCallback>(preeditCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setInputPanelCallback>(inputPanelCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setKeyEventCallback>(keyEventCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setInputMethodChangeCallback>(imChangeCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setStatusAreaUpdateCallback>(statusAreaUpdateCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setDeleteSurroundingCallback>(deleteSurroundingCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setPagedCandidateCallback>(pagedCandidateCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setSwitchInputMethodCallback>(switchInputMethodCallback);
-        androidfrontend->template call<fcitx::IAndroidFrontend::setToastCallback>(toastCallback);
+        // every event is batched per event loop iteration, in the order fcitx produced them
+        Fcitx::Instance().postEvent(readyCallback);
+        androidfrontend->template call<fcitx::IAndroidFrontend::setCandidateListCallback>(deferred(candidateListCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setCommitStringCallback>(deferred(commitStringCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setPreeditCallback>(deferred(preeditCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setInputPanelCallback>(deferred(inputPanelCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setKeyEventCallback>(deferred(keyEventCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setInputMethodChangeCallback>(deferred(imChangeCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setStatusAreaUpdateCallback>(deferred(statusAreaUpdateCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setDeleteSurroundingCallback>(deferred(deleteSurroundingCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setPagedCandidateCallback>(deferred(pagedCandidateCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setSwitchInputMethodCallback>(deferred(switchInputMethodCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setToastCallback>(deferred(toastCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setCandidateBufferCallback>(deferred(candidateBufferCallback));
+        androidfrontend->template call<fcitx::IAndroidFrontend::setPagedCandidateBufferCallback>(deferred(pagedCandidateBufferCallback));
+        // commit, preedit, input panel, candidates and status area of one key in one JNI call
+        androidfrontend->template call<fcitx::IAndroidFrontend::setUITransactionCallback>(deferred(uiTransactionCallback));
     });
     FCITX_INFO() << "Finishing startup";
 }
@@ -739,7 +949,7 @@ extern "C"
 JNIEXPORT jstring JNICALL
 Java_org_fcitx_fcitx5_android_core_Fcitx_getFcitxTranslation(JNIEnv *env, jclass clazz, jstring domain, jstring str) {
     const char *t = fcitx::translateDomain(*CString(env, domain), *CString(env, str));
-    return env->NewStringUTF(t);
+    return newJStringFromUtf8(env, t, std::strlen(t));
 }
 
 extern "C"
@@ -1041,13 +1251,15 @@ JNIEXPORT jobjectArray JNICALL
 Java_org_fcitx_fcitx5_android_core_Fcitx_getFcitxStatusAreaActions(JNIEnv *env, jclass clazz) {
     RETURN_VALUE_IF_NOT_RUNNING(nullptr)
     const auto actions = Fcitx::Instance().statusAreaActions();
-    int size = static_cast<int>(actions.size());
-    jobjectArray array = env->NewObjectArray(size, GlobalRef->Action, nullptr);
-    for (int i = 0; i < size; i++) {
-        auto obj = JRef(env, fcitxActionToJObject(env, actions[i]));
-        env->SetObjectArrayElement(array, i, obj);
-    }
-    return array;
+    return fcitxActionsToJObjectArray(env, actions);
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getFcitxStatusAreaMenu(JNIEnv *env, jclass clazz, jint id) {
+    RETURN_VALUE_IF_NOT_RUNNING(nullptr)
+    const auto actions = Fcitx::Instance().statusAreaMenu(static_cast<int>(id));
+    return fcitxActionsToJObjectArray(env, actions);
 }
 
 extern "C"
@@ -1062,13 +1274,32 @@ JNIEXPORT jobjectArray JNICALL
 Java_org_fcitx_fcitx5_android_core_Fcitx_getFcitxCandidates(JNIEnv *env, jclass clazz, jint offset, jint limit) {
     RETURN_VALUE_IF_NOT_RUNNING(nullptr)
     auto candidates = Fcitx::Instance().getCandidates(static_cast<int>(offset), static_cast<int>(limit));
-    int size = static_cast<int>(candidates.size());
-    jobjectArray array = env->NewObjectArray(size, GlobalRef->Candidate, nullptr);
-    for (int i = 0; i < size; i++) {
-        auto obj = JRef(env, candidateEntityToObject(env, candidates[i]));
-        env->SetObjectArrayElement(array, i, obj);
+    return candidateEntitiesToObjectArray(env, candidates);
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_openFcitxCandidateCursor(JNIEnv *env, jclass clazz) {
+    RETURN_VALUE_IF_NOT_RUNNING(0)
+    return static_cast<jint>(Fcitx::Instance().openCandidateCursor());
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_readFcitxCandidates(JNIEnv *env, jclass clazz, jint generation, jint offset, jint limit) {
+    RETURN_VALUE_IF_NOT_RUNNING(nullptr)
+    std::vector<CandidateEntity> candidates;
+    if (!Fcitx::Instance().readCandidates(static_cast<uint32_t>(generation), offset, limit, candidates)) {
+        return nullptr;
     }
-    return array;
+    return candidateEntitiesToObjectArray(env, candidates);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_setFcitxCandidateWindowSize(JNIEnv *env, jclass clazz, jint size) {
+    RETURN_IF_NOT_RUNNING
+    Fcitx::Instance().setCandidateWindowSize(size);
 }
 
 extern "C"
@@ -1125,6 +1356,195 @@ Java_org_fcitx_fcitx5_android_core_Fcitx_scheduleEmpty(JNIEnv *env, jclass clazz
     Fcitx::Instance().scheduleEmpty();
 }
 
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getEventQueueStats(JNIEnv *env, jclass clazz) {
+    const auto &stats = Fcitx::Instance().eventQueueStats();
+    const jlong values[] = {
+            static_cast<jlong>(stats.delivered),
+            static_cast<jlong>(stats.overflowed),
+            static_cast<jlong>(stats.batches),
+            static_cast<jlong>(stats.peakDepth),
+            stats.maxAgeNanos,
+            stats.totalAgeNanos,
+            static_cast<jlong>(Fcitx::Instance().eventQueueDepth())
+    };
+    constexpr jsize size = sizeof(values) / sizeof(jlong);
+    jlongArray array = env->NewLongArray(size);
+    env->SetLongArrayRegion(array, 0, size, values);
+    return array;
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getStringPoolStats(JNIEnv *env, jclass clazz) {
+    const auto stats = GlobalRef->StringPool.stats();
+    const jlong values[] = {
+            static_cast<jlong>(stats.hits),
+            static_cast<jlong>(stats.misses),
+            static_cast<jlong>(stats.evictions),
+            static_cast<jlong>(stats.size),
+            static_cast<jlong>(stats.bytes)
+    };
+    constexpr jsize size = sizeof(values) / sizeof(jlong);
+    jlongArray array = env->NewLongArray(size);
+    env->SetLongArrayRegion(array, 0, size, values);
+    return array;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_resyncCandidates(JNIEnv *env, jclass clazz) {
+    RETURN_IF_NOT_RUNNING
+    Fcitx::Instance().resyncCandidates();
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_setFcitxInputContextCacheCapacity(JNIEnv *env, jclass clazz, jint capacity) {
+    RETURN_IF_NOT_RUNNING
+    Fcitx::Instance().setInputContextCacheCapacity(capacity);
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getInputContextCacheStats(JNIEnv *env, jclass clazz) {
+    RETURN_VALUE_IF_NOT_RUNNING(nullptr)
+    const auto stats = Fcitx::Instance().inputContextCacheStats();
+    const jlong values[] = {
+            static_cast<jlong>(stats.counters.hits),
+            static_cast<jlong>(stats.counters.misses),
+            static_cast<jlong>(stats.counters.insertions),
+            static_cast<jlong>(stats.counters.evictions),
+            static_cast<jlong>(stats.size),
+            static_cast<jlong>(stats.capacity),
+            static_cast<jlong>(stats.activations.cold),
+            static_cast<jlong>(stats.activations.coldNanos),
+            static_cast<jlong>(stats.activations.warm),
+            static_cast<jlong>(stats.activations.warmNanos)
+    };
+    constexpr jsize size = sizeof(values) / sizeof(jlong);
+    jlongArray array = env->NewLongArray(size);
+    env->SetLongArrayRegion(array, 0, size, values);
+    return array;
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getOutputFilterCacheStats(JNIEnv *env, jclass clazz) {
+    RETURN_VALUE_IF_NOT_RUNNING(nullptr)
+    const auto stats = Fcitx::Instance().outputFilterCacheStats();
+    const jlong values[] = {
+            static_cast<jlong>(stats.hits),
+            static_cast<jlong>(stats.misses),
+            static_cast<jlong>(stats.evictions),
+            static_cast<jlong>(stats.invalidations)
+    };
+    constexpr jsize size = sizeof(values) / sizeof(jlong);
+    jlongArray array = env->NewLongArray(size);
+    env->SetLongArrayRegion(array, 0, size, values);
+    return array;
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getStatusAreaStats(JNIEnv *env, jclass clazz) {
+    RETURN_VALUE_IF_NOT_RUNNING(nullptr)
+    const auto stats = Fcitx::Instance().statusAreaStats();
+    const jlong values[] = {
+            static_cast<jlong>(stats.flushes),
+            static_cast<jlong>(stats.suppressed),
+            static_cast<jlong>(stats.menus)
+    };
+    constexpr jsize size = sizeof(values) / sizeof(jlong);
+    jlongArray array = env->NewLongArray(size);
+    env->SetLongArrayRegion(array, 0, size, values);
+    return array;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_isKeyboardIdle(JNIEnv *env, jclass clazz) {
+    RETURN_VALUE_IF_NOT_RUNNING(JNI_TRUE)
+    return Fcitx::Instance().keyboardIdle() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_setFcitxUIFrameBudget(JNIEnv *env, jclass clazz, jint micros) {
+    RETURN_IF_NOT_RUNNING
+    Fcitx::Instance().setUIFrameBudget(micros);
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getUIFrameStats(JNIEnv *env, jclass clazz) {
+    RETURN_VALUE_IF_NOT_RUNNING(nullptr)
+    const auto stats = Fcitx::Instance().uiFrameStats();
+    const jlong values[] = {
+            static_cast<jlong>(stats.delivered),
+            static_cast<jlong>(stats.dropped),
+            static_cast<jlong>(stats.immediate)
+    };
+    constexpr jsize size = sizeof(values) / sizeof(jlong);
+    jlongArray array = env->NewLongArray(size);
+    env->SetLongArrayRegion(array, 0, size, values);
+    return array;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_setFcitxKeystrokeTracing(JNIEnv *env, jclass clazz, jboolean enabled) {
+    RETURN_IF_NOT_RUNNING
+    Fcitx::Instance().setKeystrokeTracing(enabled);
+}
+
+extern "C"
+JNIEXPORT jlongArray JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_getKeystrokeLatency(JNIEnv *env, jclass clazz) {
+    RETURN_VALUE_IF_NOT_RUNNING(nullptr)
+    const auto latency = Fcitx::Instance().keystrokeLatency();
+    // count, p50, p95, p99 of each stage, then dropped spans
+    jlong values[KeystrokeStageCount * 4 + 1];
+    jsize size = 0;
+    for (const auto &s: latency.stages) {
+        values[size++] = static_cast<jlong>(s.count);
+        values[size++] = static_cast<jlong>(s.p50);
+        values[size++] = static_cast<jlong>(s.p95);
+        values[size++] = static_cast<jlong>(s.p99);
+    }
+    values[size++] = static_cast<jlong>(latency.dropped);
+    jlongArray array = env->NewLongArray(size);
+    env->SetLongArrayRegion(array, 0, size, values);
+    return array;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_startFcitxTrace(JNIEnv *env, jclass clazz) {
+    traceRecorder().start();
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_stopFcitxTrace(JNIEnv *env, jclass clazz) {
+    traceRecorder().stop();
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_org_fcitx_fcitx5_android_core_Fcitx_dumpFcitxTrace(JNIEnv *env, jclass clazz) {
+    // user StandardPath::Type::Cache, set on startup
+    const char *cacheHome = getenv("XDG_CACHE_HOME");
+    if (!cacheHome) return nullptr;
+    const auto path = fcitx::stringutils::joinPath(cacheHome, "fcitx5-trace.json");
+    if (!traceRecorder().dump(path)) {
+        FCITX_WARN() << "Failed to write trace to " << path;
+        return nullptr;
+    }
+    return newJStringFromUtf8(env, path.data(), path.size());
+}
+
 extern "C"
 JNIEXPORT jobject JNICALL
 Java_org_fcitx_fcitx5_android_core_Key_parse(JNIEnv *env, jclass clazz, jstring raw) {
@@ -1158,6 +1578,7 @@ extern "C"
 JNIEXPORT void JNICALL
 Java_org_fcitx_fcitx5_android_data_pinyin_PinyinDictManager_pinyinDictConv(JNIEnv *env, jclass clazz, jstring src, jstring dest, jboolean mode) {
     using namespace libime;
+    TraceSpan span("pinyinDictConv", "dictionary", *CString(env, src));
     PinyinDictionary dict;
     try {
         dict.load(PinyinDictionary::SystemDict, *CString(env, src),
@@ -1175,6 +1596,7 @@ extern "C"
 JNIEXPORT void JNICALL
 Java_org_fcitx_fcitx5_android_data_table_TableManager_tableDictConv(JNIEnv *env, jclass clazz, jstring src, jstring dest, jboolean mode) {
     using namespace libime;
+    TraceSpan span("tableDictConv", "dictionary", *CString(env, src));
     TableBasedDictionary dict;
     try {
         dict.load(*CString(env, src), mode == JNI_TRUE ? TableFormat::Binary : TableFormat::Text);
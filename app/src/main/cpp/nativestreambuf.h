@@ -8,7 +8,21 @@
 #include <array>
 #include <streambuf>
 
+#ifdef __ANDROID__
 #include <android/log.h>
+#else
+#include <cstdio>
+
+// host builds log to stderr, with the same priorities as android log
+enum android_LogPriority {
+    ANDROID_LOG_VERBOSE = 2,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL
+};
+#endif
 
 template<std::size_t SIZE = 128>
 class native_streambuf : public std::streambuf {
@@ -96,7 +110,16 @@ private:
     }
 
     void write_log(const char_type *text) const {
+#ifdef __ANDROID__
         __android_log_write(prio, "fcitx5", text + (should_offset ? 1 : 0));
+#else
+        // a "line" may be written in several parts, only the first one gets the tag
+        if (should_offset) {
+            static constexpr char Tags[] = "VDIWEF";
+            std::fprintf(stderr, "%c/fcitx5: ", Tags[prio - ANDROID_LOG_VERBOSE]);
+        }
+        std::fputs(text + (should_offset ? 1 : 0), stderr);
+#endif
     }
 };
 
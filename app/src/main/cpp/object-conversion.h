@@ -11,6 +11,7 @@
 
 #include "jni-utils.h"
 #include "helper-types.h"
+#include "utf16-utils.h"
 
 jobject fcitxInputMethodEntryToJObject(JNIEnv *env, const fcitx::InputMethodEntry *entry) {
     return env->NewObject(GlobalRef->InputMethodEntry, GlobalRef->InputMethodEntryInit,
@@ -37,17 +38,17 @@ jobjectArray fcitxInputMethodEntriesToJObjectArray(JNIEnv *env, const std::vecto
 
 jobject fcitxInputMethodStatusToJObject(JNIEnv *env, const InputMethodStatus &status) {
     return env->NewObject(GlobalRef->InputMethodEntry, GlobalRef->InputMethodEntryInitWithSubMode,
-                          *JString(env, status.uniqueName),
-                          *JString(env, status.name),
-                          *JString(env, status.icon),
-                          *JString(env, status.nativeName),
-                          *JString(env, status.label),
-                          *JString(env, status.languageCode),
-                          *JString(env, status.addon),
+                          *JInternedString(env, status.uniqueName),
+                          *JInternedString(env, status.name),
+                          *JInternedString(env, status.icon),
+                          *JInternedString(env, status.nativeName),
+                          *JInternedString(env, status.label),
+                          *JInternedString(env, status.languageCode),
+                          *JInternedString(env, status.addon),
                           status.configurable,
-                          *JString(env, status.subMode),
-                          *JString(env, status.subModeLabel),
-                          *JString(env, status.subModeIcon)
+                          *JInternedString(env, status.subMode),
+                          *JInternedString(env, status.subModeLabel),
+                          *JInternedString(env, status.subModeIcon)
     );
 }
 
@@ -117,22 +118,18 @@ jobject fcitxAddonStatusToJObject(JNIEnv *env, const AddonStatus &status) {
     );
 }
 
+jobjectArray fcitxActionsToJObjectArray(JNIEnv *env, const std::vector<ActionEntity> &actions);
+
 jobject fcitxActionToJObject(JNIEnv *env, const ActionEntity &act) {
-    jobjectArray menu = nullptr;
-    if (act.menu) {
-        const int size = static_cast<int>(act.menu->size());
-        menu = env->NewObjectArray(size, GlobalRef->Action, nullptr);
-        for (int i = 0; i < size; i++) {
-            env->SetObjectArrayElement(menu, i, fcitxActionToJObject(env, act.menu->at(i)));
-        }
-    }
+    // empty but not null if the menu is left to be fetched by id
+    jobjectArray menu = act.menu ? fcitxActionsToJObjectArray(env, *act.menu) : nullptr;
     auto obj = env->NewObject(GlobalRef->Action, GlobalRef->ActionInit,
                               act.id,
                               act.isSeparator,
                               act.isCheckable,
                               act.isChecked,
-                              *JString(env, act.name),
-                              *JString(env, act.icon),
+                              *JInternedString(env, act.name),
+                              *JInternedString(env, act.icon),
                               *JString(env, act.shortText),
                               *JString(env, act.longText),
                               menu
@@ -143,22 +140,45 @@ jobject fcitxActionToJObject(JNIEnv *env, const ActionEntity &act) {
     return obj;
 }
 
+jobjectArray fcitxActionsToJObjectArray(JNIEnv *env, const std::vector<ActionEntity> &actions) {
+    jobjectArray array = env->NewObjectArray(static_cast<int>(actions.size()), GlobalRef->Action, nullptr);
+    int i = 0;
+    for (const auto &a: actions) {
+        auto obj = JRef(env, fcitxActionToJObject(env, a));
+        env->SetObjectArrayElement(array, i++, obj);
+    }
+    return array;
+}
+
 jobject fcitxTextToJObject(JNIEnv *env, const fcitx::Text &text) {
     const int size = static_cast<int>(text.size());
     auto str = JRef<jobjectArray>(env, env->NewObjectArray(size, GlobalRef->String, nullptr));
-    auto fmt = JRef<jintArray>(env, env->NewIntArray(size));
-    int flag = static_cast<int>(fcitx::TextFormatFlag::NoFlag);
+    std::vector<jint> flags(size);
+    // UTF-16 start of each segment, then total length
+    std::vector<jint> offsets(size + 1);
+    thread_local std::vector<char16_t> units;
+    // fcitx counts cursor in UTF-8 bytes, Java in UTF-16 units
+    utf16::CursorFromUtf8 cursor(text.cursor());
+    jint length = 0;
     for (int i = 0; i < size; i++) {
-        env->SetObjectArrayElement(str, i, *JString(env, text.stringAt(i)));
-        flag = text.formatAt(i).toInteger();
-        env->SetIntArrayRegion(fmt, i, 1, &flag);
+        const auto &s = text.stringAt(i);
+        if (units.size() < s.size()) {
+            units.resize(s.size());
+        }
+        cursor.segment(s.data(), s.size(), length, units.data());
+        const auto n = utf16::fromUtf8(s.data(), s.size(), units.data());
+        auto jstr = JRef<jstring>(env, env->NewString(reinterpret_cast<const jchar *>(units.data()), static_cast<jsize>(n)));
+        env->SetObjectArrayElement(str, i, jstr);
+        flags[i] = text.formatAt(i).toInteger();
+        offsets[i] = length;
+        length += static_cast<jint>(n);
     }
-    auto obj = env->CallStaticObjectMethod(GlobalRef->FormattedText, GlobalRef->FormattedTextFromByteCursor,
-                                           *str,
-                                           *fmt,
-                                           text.cursor()
-    );
-    return obj;
+    offsets[size] = length;
+    auto fmt = JRef<jintArray>(env, env->NewIntArray(size));
+    env->SetIntArrayRegion(fmt, 0, size, flags.data());
+    auto off = JRef<jintArray>(env, env->NewIntArray(size + 1));
+    env->SetIntArrayRegion(off, 0, size + 1, offsets.data());
+    return env->NewObject(GlobalRef->FormattedText, GlobalRef->FormattedTextInit, *str, *fmt, *off, cursor.cursor(length));
 }
 
 jobject fcitxCandidateActionToObject(JNIEnv *env, const CandidateActionEntity &act) {
@@ -175,7 +195,7 @@ jobject fcitxCandidateActionToObject(JNIEnv *env, const CandidateActionEntity &a
 
 jobject candidateEntityToObject(JNIEnv *env, const CandidateEntity &c) {
     auto obj = env->NewObject(GlobalRef->Candidate, GlobalRef->CandidateInit,
-                              *JString(env, c.label),
+                              *JInternedString(env, c.label),
                               *JString(env, c.text),
                               *JString(env, c.comment),
                               c.spaceBetweenComment
@@ -183,4 +203,24 @@ jobject candidateEntityToObject(JNIEnv *env, const CandidateEntity &c) {
     return obj;
 }
 
+jobjectArray candidateEntitiesToObjectArray(JNIEnv *env, const std::vector<CandidateEntity> &candidates) {
+    const int size = static_cast<int>(candidates.size());
+    jobjectArray array = env->NewObjectArray(size, GlobalRef->Candidate, nullptr);
+    // release local refs chunk by chunk, so that a long range can't overflow the local reference table
+    constexpr int Chunk = 64;
+    for (int start = 0; start < size; start += Chunk) {
+        if (env->PushLocalFrame(Chunk + 4) < 0) {
+            // OutOfMemoryError is pending
+            env->DeleteLocalRef(array);
+            return nullptr;
+        }
+        const int end = std::min(size, start + Chunk);
+        for (int i = start; i < end; i++) {
+            env->SetObjectArrayElement(array, i, candidateEntityToObject(env, candidates[i]));
+        }
+        env->PopLocalFrame(nullptr);
+    }
+    return array;
+}
+
 #endif //FCITX5_ANDROID_OBJECT_CONVERSION_H
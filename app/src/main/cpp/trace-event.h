@@ -0,0 +1,215 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_TRACE_EVENT_H
+#define FCITX5_ANDROID_TRACE_EVENT_H
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct TraceEvent {
+    // string literals, never copied
+    const char *name = "";
+    const char *category = "";
+    // steady clock nanoseconds
+    uint64_t begin = 0;
+    uint64_t duration = 0;
+    uint32_t tid = 0;
+    // shown as args.detail, empty to omit
+    std::string detail;
+};
+
+/**
+ * Flight recorder of complete ("X") trace events, written as Chrome trace-event JSON that
+ * Perfetto UI and chrome://tracing can open.
+ *
+ * Events go to a ring of fixed size, overwriting the oldest ones, so it can stay armed for a
+ * long time and be dumped when something was slow. Recording takes a mutex, so only coarse
+ * spans (event loop iterations, addon loading, config reloads...) should be traced.
+ */
+class TraceRecorder {
+public:
+    explicit TraceRecorder(size_t capacity = 8192) : events_(capacity ? capacity : 1) {}
+
+    TraceRecorder(const TraceRecorder &) = delete;
+
+    TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    [[nodiscard]] bool armed() const { return armed_.load(std::memory_order_relaxed); }
+
+    // start recording; events from the previous session are kept until overwritten or cleared
+    void start() { armed_.store(true, std::memory_order_relaxed); }
+
+    void stop() { armed_.store(false, std::memory_order_relaxed); }
+
+    void record(TraceEvent &&event) {
+        std::lock_guard lock(mutex_);
+        events_[next_ % events_.size()] = std::move(event);
+        next_++;
+    }
+
+    void clear() {
+        std::lock_guard lock(mutex_);
+        next_ = 0;
+    }
+
+    [[nodiscard]] size_t size() {
+        std::lock_guard lock(mutex_);
+        return std::min<uint64_t>(next_, events_.size());
+    }
+
+    // events recorded since last clear(), including overwritten ones
+    [[nodiscard]] uint64_t total() {
+        std::lock_guard lock(mutex_);
+        return next_;
+    }
+
+    void writeJson(std::ostream &out) {
+        std::lock_guard lock(mutex_);
+        const uint64_t count = std::min<uint64_t>(next_, events_.size());
+        const auto pid = static_cast<long>(::getpid());
+        out << R"({"displayTimeUnit":"ms","otherData":{"overwritten":)" << next_ - count
+            << R"(},"traceEvents":[)";
+        // oldest first
+        for (uint64_t i = next_ - count; i < next_; i++) {
+            const auto &e = events_[i % events_.size()];
+            if (i != next_ - count) out << ',';
+            out << R"({"ph":"X","name":)";
+            writeString(out, e.name);
+            out << R"(,"cat":)";
+            writeString(out, e.category);
+            out << R"(,"pid":)" << pid << R"(,"tid":)" << e.tid
+                << R"(,"ts":)" << micros(e.begin) << R"(,"dur":)" << micros(e.duration);
+            if (!e.detail.empty()) {
+                out << R"(,"args":{"detail":)";
+                writeString(out, e.detail);
+                out << '}';
+            }
+            out << '}';
+        }
+        out << "]}";
+    }
+
+    // write JSON to `path` through a temporary file, so readers never see a partial trace
+    bool dump(const std::string &path) {
+        const auto tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::out | std::ios::trunc);
+            if (!out) return false;
+            writeJson(out);
+            out.flush();
+            if (!out) {
+                std::remove(tmp.c_str());
+                return false;
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    static uint32_t currentThread() {
+        static thread_local const auto tid = static_cast<uint32_t>(::gettid());
+        return tid;
+    }
+
+private:
+    std::atomic<bool> armed_{false};
+    std::mutex mutex_;
+    std::vector<TraceEvent> events_;
+    // events ever recorded, the next one goes to next_ % capacity
+    uint64_t next_ = 0;
+
+    // trace-event timestamps are microseconds, fractions keep nanosecond precision
+    static std::string micros(uint64_t nanos) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%llu.%03u",
+                      static_cast<unsigned long long>(nanos / 1000), static_cast<unsigned>(nanos % 1000));
+        return buf;
+    }
+
+    static void writeString(std::ostream &out, std::string_view s) {
+        out << '"';
+        for (const char c: s) {
+            switch (c) {
+                case '"':
+                    out << "\\\"";
+                    break;
+                case '\\':
+                    out << "\\\\";
+                    break;
+                case '\n':
+                    out << "\\n";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buf[8];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                        out << buf;
+                    } else {
+                        out << c;
+                    }
+            }
+        }
+        out << '"';
+    }
+};
+
+// process wide recorder of native-lib
+inline TraceRecorder &traceRecorder() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+/**
+ * Records the enclosing scope to `recorder` if it's armed when the scope is entered
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char *name, const char *category, std::string_view detail = {},
+              TraceRecorder &recorder = traceRecorder())
+            : recorder_(recorder.armed() ? &recorder : nullptr) {
+        if (!recorder_) return;
+        event_.name = name;
+        event_.category = category;
+        event_.detail = detail;
+        event_.tid = TraceRecorder::currentThread();
+        event_.begin = TraceRecorder::now();
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    ~TraceSpan() {
+        if (!recorder_) return;
+        event_.duration = TraceRecorder::now() - event_.begin;
+        recorder_->record(std::move(event_));
+    }
+
+private:
+    TraceRecorder *recorder_;
+    TraceEvent event_;
+};
+
+#endif //FCITX5_ANDROID_TRACE_EVENT_H
@@ -0,0 +1,194 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_UTF16_UTILS_H
+#define FCITX5_ANDROID_UTF16_UTILS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FCITX5_ANDROID_UTF16_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FCITX5_ANDROID_UTF16_SSE2
+#endif
+
+namespace utf16 {
+
+constexpr char16_t ReplacementChar = 0xfffd;
+
+namespace detail {
+
+/**
+ * Decode one code point starting at `s`, write it to `d`.
+ * An ill-formed sequence is replaced by one U+FFFD per maximal subpart, as recommended by
+ * Unicode (and done by Java's decoder): bytes are only consumed while they can still form a
+ * valid sequence.
+ * @return pointer past the consumed bytes; `d` is advanced past the written code units
+ */
+inline const uint8_t *decodeOne(const uint8_t *s, const uint8_t *end, char16_t *&d) {
+    const uint8_t c = *s;
+    if (c < 0x80) {
+        *d++ = c;
+        return s + 1;
+    }
+    uint32_t cp;
+    int extra;
+    // valid range of the second byte, rules out overlong forms, surrogates and > U+10FFFF
+    uint8_t lo = 0x80;
+    uint8_t hi = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf) {
+        cp = c & 0x1f;
+        extra = 1;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        cp = c & 0x0f;
+        extra = 2;
+        if (c == 0xe0) lo = 0xa0;
+        else if (c == 0xed) hi = 0x9f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        cp = c & 0x07;
+        extra = 3;
+        if (c == 0xf0) lo = 0x90;
+        else if (c == 0xf4) hi = 0x8f;
+    } else {
+        *d++ = ReplacementChar;
+        return s + 1;
+    }
+    const uint8_t *p = s + 1;
+    for (int i = 0; i < extra; i++, p++) {
+        if (p >= end || *p < lo || *p > hi) {
+            *d++ = ReplacementChar;
+            return p;
+        }
+        cp = (cp << 6) | (*p & 0x3f);
+        lo = 0x80;
+        hi = 0xbf;
+    }
+    if (cp >= 0x10000) {
+        cp -= 0x10000;
+        *d++ = static_cast<char16_t>(0xd800 | (cp >> 10));
+        *d++ = static_cast<char16_t>(0xdc00 | (cp & 0x3ff));
+    } else {
+        *d++ = static_cast<char16_t>(cp);
+    }
+    return p;
+}
+
+/**
+ * Widen 16 bytes to `d` if all of them are ASCII.
+ * @return false if any byte is not ASCII, nothing is written in that case
+ */
+inline bool asciiBlock16(const uint8_t *s, char16_t *d) {
+#if defined(FCITX5_ANDROID_UTF16_NEON)
+    const uint8x16_t v = vld1q_u8(s);
+    const uint8x8_t folded = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+    if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) & 0x8080808080808080ULL) {
+        return false;
+    }
+    auto *out = reinterpret_cast<uint16_t *>(d);
+    vst1q_u16(out, vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(out + 8, vmovl_u8(vget_high_u8(v)));
+    return true;
+#elif defined(FCITX5_ANDROID_UTF16_SSE2)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    if (_mm_movemask_epi8(v) != 0) {
+        return false;
+    }
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(d), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(d + 8), _mm_unpackhi_epi8(v, zero));
+    return true;
+#else
+    uint64_t lo, hi;
+    __builtin_memcpy(&lo, s, sizeof(lo));
+    __builtin_memcpy(&hi, s + 8, sizeof(hi));
+    if ((lo | hi) & 0x8080808080808080ULL) {
+        return false;
+    }
+    for (int i = 0; i < 16; i++) {
+        d[i] = s[i];
+    }
+    return true;
+#endif
+}
+
+} // namespace detail
+
+/**
+ * Byte by byte decoder, reference for fromUtf8
+ */
+inline size_t fromUtf8Scalar(const char *src, size_t len, char16_t *dst) {
+    const auto *s = reinterpret_cast<const uint8_t *>(src);
+    const auto *end = s + len;
+    char16_t *d = dst;
+    while (s < end) {
+        s = detail::decodeOne(s, end, d);
+    }
+    return d - dst;
+}
+
+/**
+ * Decode UTF-8 bytes in [src, src + len) into UTF-16 code units.
+ * `dst` must have room for at least `len` code units; malformed sequences become U+FFFD.
+ * ASCII runs are widened 16 bytes at a time with NEON or SSE2 when available.
+ * @return number of UTF-16 code units written
+ */
+inline size_t fromUtf8(const char *src, size_t len, char16_t *dst) {
+    const auto *s = reinterpret_cast<const uint8_t *>(src);
+    const auto *end = s + len;
+    char16_t *d = dst;
+    while (s < end) {
+        if (*s >= 0x80) {
+            s = detail::decodeOne(s, end, d);
+            continue;
+        }
+        // only try a block where ASCII starts, CJK and emoji text rarely has 16 ASCII bytes in a row
+        if (end - s >= 16 && detail::asciiBlock16(s, d)) {
+            s += 16;
+            d += 16;
+            continue;
+        }
+        *d++ = *s++;
+    }
+    return d - dst;
+}
+
+/**
+ * UTF-16 cursor of a UTF-8 byte cursor in text decoded one segment at a time, as fcitx::Text.
+ * A negative byte cursor is no cursor and stays -1; one past the end of text goes to its end.
+ */
+class CursorFromUtf8 {
+public:
+    explicit CursorFromUtf8(int byteCursor)
+            : byteCursor_(byteCursor), cursor_(byteCursor < 0 ? -1 : 0), found_(byteCursor < 0) {}
+
+    /**
+     * Call for each segment in order, before decoding it.
+     * @param start UTF-16 units before the segment
+     * @param dst room for at least `len` code units, overwritten
+     */
+    void segment(const char *src, size_t len, int start, char16_t *dst) {
+        if (!found_ && static_cast<size_t>(byteCursor_) - bytes_ <= len) {
+            // decoding only the prefix counts its UTF-16 units, even if cursor splits a character
+            cursor_ = start + static_cast<int>(fromUtf8(src, byteCursor_ - bytes_, dst));
+            found_ = true;
+        }
+        bytes_ += len;
+    }
+
+    // @param length UTF-16 units of the whole text
+    [[nodiscard]] int cursor(int length) const { return found_ ? cursor_ : length; }
+
+private:
+    int byteCursor_;
+    int cursor_;
+    bool found_;
+    size_t bytes_ = 0;
+};
+
+} // namespace utf16
+
+#endif //FCITX5_ANDROID_UTF16_UTILS_H
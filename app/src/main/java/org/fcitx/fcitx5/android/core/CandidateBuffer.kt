@@ -0,0 +1,70 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+package org.fcitx.fcitx5.android.core
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Candidate list serialized by native-lib, decoded on demand.
+ *
+ * Layout (native byte order):
+ * - int32 count
+ * - int32 position of offsets table
+ * - entries: uint16 flags, then label, text, comment as (uint16 length, char[length])
+ * - int32 offsets[count]
+ *
+ * see `CandidateBuffer` in helper-types.h
+ */
+class CandidateBuffer(private val data: ByteBuffer) {
+
+    val size: Int = data.getInt(0)
+
+    private val table: Int = data.getInt(Int.SIZE_BYTES)
+
+    private val decoded = arrayOfNulls<CandidateWord>(size)
+
+    operator fun get(index: Int): CandidateWord {
+        if (index !in 0..<size) throw IndexOutOfBoundsException("index=$index, size=$size")
+        decoded[index]?.let { return it }
+        var pos = data.getInt(table + index * Int.SIZE_BYTES)
+        val flags = data.getChar(pos).code
+        pos += Char.SIZE_BYTES
+        val label = readString(pos)
+        pos += Char.SIZE_BYTES * (label.length + 1)
+        val text = readString(pos)
+        pos += Char.SIZE_BYTES * (text.length + 1)
+        val comment = readString(pos)
+        return CandidateWord(label, text, comment, flags and SPACE_BETWEEN_COMMENT != 0)
+            .also { decoded[index] = it }
+    }
+
+    fun toArray(): Array<CandidateWord> = Array(size) { get(it) }
+
+    private fun readString(pos: Int): String {
+        val length = data.getChar(pos).code
+        if (length == 0) return ""
+        val chars = CharArray(length)
+        val start = pos + Char.SIZE_BYTES
+        for (i in 0 until length) {
+            chars[i] = data.getChar(start + i * Char.SIZE_BYTES)
+        }
+        return String(chars)
+    }
+
+    companion object {
+        private const val SPACE_BETWEEN_COMMENT = 1
+
+        /**
+         * [src] is owned and reused by native-lib, so its content must be copied out
+         * before returning to native code.
+         */
+        fun copyOf(src: ByteBuffer, length: Int): CandidateBuffer {
+            val bytes = ByteArray(length)
+            src.duplicate().apply { clear() }.get(bytes, 0, length)
+            return CandidateBuffer(ByteBuffer.wrap(bytes).order(ByteOrder.nativeOrder()))
+        }
+    }
+}
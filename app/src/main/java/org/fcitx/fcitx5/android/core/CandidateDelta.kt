@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+package org.fcitx.fcitx5.android.core
+
+/**
+ * Candidate list encoded against the previously pushed one.
+ *
+ * `ops` are pairs of ints:
+ * - `(start, length)` keep `length` candidates of the previous list starting at `start`
+ * - `(INSERT, count)` take next `count` candidates from the inserted ones
+ *
+ * see `candidate-delta.h`
+ */
+object CandidateDelta {
+    const val INSERT = -1
+
+    /**
+     * @return rebuilt list, or null if [ops] don't match [previous] and [inserted]
+     */
+    fun apply(
+        previous: Array<CandidateWord>,
+        inserted: CandidateBuffer,
+        ops: IntArray
+    ): Array<CandidateWord>? {
+        if (ops.size % 2 != 0) return null
+        var size = 0
+        for (i in ops.indices step 2) {
+            val start = ops[i]
+            val length = ops[i + 1]
+            if (length < 0) return null
+            if (start != INSERT && (start < 0 || start + length > previous.size)) return null
+            size += length
+        }
+        val result = arrayOfNulls<CandidateWord>(size)
+        var pos = 0
+        var next = 0
+        for (i in ops.indices step 2) {
+            val start = ops[i]
+            val length = ops[i + 1]
+            if (start == INSERT) {
+                if (next + length > inserted.size) return null
+                repeat(length) { result[pos++] = inserted[next++] }
+            } else {
+                previous.copyInto(result, pos, start, start + length)
+                pos += length
+            }
+        }
+        if (next != inserted.size) return null
+        @Suppress("UNCHECKED_CAST")
+        return result as Array<CandidateWord>
+    }
+}
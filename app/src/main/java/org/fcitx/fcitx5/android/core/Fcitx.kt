@@ -18,11 +18,13 @@ import org.fcitx.fcitx5.android.R
 import org.fcitx.fcitx5.android.core.data.DataManager
 import org.fcitx.fcitx5.android.data.clipboard.ClipboardManager
 import org.fcitx.fcitx5.android.data.prefs.AppPrefs
+import org.fcitx.fcitx5.android.data.prefs.ManagedPreference
 import org.fcitx.fcitx5.android.utils.ImmutableGraph
 import org.fcitx.fcitx5.android.utils.Locales
 import org.fcitx.fcitx5.android.utils.appContext
 import org.fcitx.fcitx5.android.utils.toast
 import timber.log.Timber
+import java.nio.ByteBuffer
 import java.util.concurrent.CopyOnWriteArrayList
 
 /**
@@ -75,6 +77,12 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
 
     override fun translate(str: String, domain: String) = getFcitxTranslation(domain, str)
 
+    override fun startTrace() = startFcitxTrace()
+
+    override fun stopTrace() = stopFcitxTrace()
+
+    override fun dumpTrace() = dumpFcitxTrace()
+
     override suspend fun save() = withFcitxContext { saveFcitxState() }
     override suspend fun reloadConfig() = withFcitxContext { reloadFcitxConfig() }
 
@@ -175,12 +183,29 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
     override suspend fun statusArea(): Array<Action> =
         withFcitxContext { getFcitxStatusAreaActions() ?: emptyArray() }
 
+    override suspend fun statusAreaMenu(id: Int): Array<Action> =
+        withFcitxContext { getFcitxStatusAreaMenu(id) ?: emptyArray() }
+
+    override suspend fun statusAreaStats(): StatusAreaStats =
+        withFcitxContext {
+            StatusAreaStats.fromArray(getStatusAreaStats() ?: LongArray(StatusAreaStats.SIZE))
+        }
+
     override suspend fun activateAction(id: Int) =
         withFcitxContext { activateUserInterfaceAction(id) }
 
     override suspend fun getCandidates(offset: Int, limit: Int): Array<CandidateWord> =
         withFcitxContext { getFcitxCandidates(offset, limit) ?: emptyArray() }
 
+    override suspend fun openCandidateCursor(): Int =
+        withFcitxContext { openFcitxCandidateCursor() }
+
+    override suspend fun readCandidates(generation: Int, offset: Int, limit: Int) =
+        withFcitxContext { readFcitxCandidates(generation, offset, limit) }
+
+    override suspend fun setCandidateWindowSize(size: Int) =
+        withFcitxContext { setFcitxCandidateWindowSize(size) }
+
     override suspend fun getCandidateActions(idx: Int): Array<CandidateAction> =
         withFcitxContext { getFcitxCandidateActions(idx) ?: emptyArray() }
 
@@ -196,6 +221,41 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
     override suspend fun triggerCandidateListTabAction(id: Int) =
         withFcitxContext { triggerFcitxCandidateListTabAction(id) }
 
+    override suspend fun eventQueueStats(): EventQueueStats =
+        withFcitxContext { EventQueueStats.fromArray(getEventQueueStats()) }
+
+    override suspend fun stringPoolStats(): StringPoolStats =
+        withFcitxContext { StringPoolStats.fromArray(getStringPoolStats()) }
+
+    override suspend fun setInputContextCacheCapacity(capacity: Int) =
+        withFcitxContext { setFcitxInputContextCacheCapacity(capacity) }
+
+    override suspend fun inputContextCacheStats(): InputContextCacheStats =
+        withFcitxContext {
+            InputContextCacheStats.fromArray(getInputContextCacheStats() ?: LongArray(InputContextCacheStats.SIZE))
+        }
+
+    override suspend fun outputFilterCacheStats(): OutputFilterCacheStats =
+        withFcitxContext {
+            OutputFilterCacheStats.fromArray(getOutputFilterCacheStats() ?: LongArray(OutputFilterCacheStats.SIZE))
+        }
+
+    override suspend fun setUIFrameBudget(micros: Int) =
+        withFcitxContext { setFcitxUIFrameBudget(micros) }
+
+    override suspend fun uiFrameStats(): UIFrameStats =
+        withFcitxContext {
+            UIFrameStats.fromArray(getUIFrameStats() ?: LongArray(UIFrameStats.SIZE))
+        }
+
+    override suspend fun setKeystrokeTracing(enabled: Boolean) =
+        withFcitxContext { setFcitxKeystrokeTracing(enabled) }
+
+    override suspend fun keystrokeLatency(): KeystrokeLatency =
+        withFcitxContext {
+            KeystrokeLatency.fromArray(getKeystrokeLatency() ?: LongArray(KeystrokeLatency.SIZE))
+        }
+
     init {
         if (lifecycle.currentState != FcitxLifecycle.State.STOPPED)
             throw IllegalAccessException("Fcitx5 has already been created!")
@@ -362,12 +422,34 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
         @JvmStatic
         external fun getFcitxStatusAreaActions(): Array<Action>?
 
+        @JvmStatic
+        external fun getFcitxStatusAreaMenu(id: Int): Array<Action>?
+
+        @JvmStatic
+        external fun getStatusAreaStats(): LongArray?
+
+        /**
+         * word hints of keyboard input methods are computed off the fcitx thread;
+         * false while some are still on their way
+         */
+        @JvmStatic
+        external fun isKeyboardIdle(): Boolean
+
         @JvmStatic
         external fun activateUserInterfaceAction(id: Int)
 
         @JvmStatic
         external fun getFcitxCandidates(offset: Int, limit: Int): Array<CandidateWord>?
 
+        @JvmStatic
+        external fun openFcitxCandidateCursor(): Int
+
+        @JvmStatic
+        external fun readFcitxCandidates(generation: Int, offset: Int, limit: Int): Array<CandidateWord>?
+
+        @JvmStatic
+        external fun setFcitxCandidateWindowSize(size: Int)
+
         @JvmStatic
         external fun getFcitxCandidateActions(idx: Int): Array<CandidateAction>?
 
@@ -389,13 +471,360 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
         @JvmStatic
         external fun scheduleEmpty()
 
+        @JvmStatic
+        external fun getEventQueueStats(): LongArray
+
+        @JvmStatic
+        external fun resyncCandidates()
+
+        @JvmStatic
+        external fun getStringPoolStats(): LongArray
+
+        @JvmStatic
+        external fun setFcitxInputContextCacheCapacity(capacity: Int)
+
+        @JvmStatic
+        external fun getInputContextCacheStats(): LongArray?
+
+        @JvmStatic
+        external fun getOutputFilterCacheStats(): LongArray?
+
+        @JvmStatic
+        external fun setFcitxUIFrameBudget(micros: Int)
+
+        @JvmStatic
+        external fun getUIFrameStats(): LongArray?
+
+        @JvmStatic
+        external fun setFcitxKeystrokeTracing(enabled: Boolean)
+
+        @JvmStatic
+        external fun getKeystrokeLatency(): LongArray?
+
+        @JvmStatic
+        external fun startFcitxTrace()
+
+        @JvmStatic
+        external fun stopFcitxTrace()
+
+        @JvmStatic
+        external fun dumpFcitxTrace(): String?
+
         /**
-         * Called from native-lib
+         * Legacy entry point that decodes boxed parameters with [FcitxEvent.create].
+         * native-lib now calls the typed `handle*Event` functions below; this one is kept
+         * for callers that still build `Array<Any>` params.
          */
         @Suppress("unused")
         @JvmStatic
         fun handleFcitxEvent(type: Int, params: Array<Any>) {
-            val event = FcitxEvent.create(type, params)
+            dispatchFcitxEvent(FcitxEvent.create(type, params))
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleCandidateListEvent(total: Int, candidates: Array<CandidateWord>) {
+            dispatchFcitxEvent(
+                FcitxEvent.CandidateListEvent(FcitxEvent.CandidateListEvent.Data(total, candidates))
+            )
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleCommitStringEvent(text: String, cursor: Int) {
+            dispatchFcitxEvent(
+                FcitxEvent.CommitStringEvent(FcitxEvent.CommitStringEvent.Data(text, cursor))
+            )
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleClientPreeditEvent(preedit: FormattedText) {
+            dispatchFcitxEvent(FcitxEvent.ClientPreeditEvent(preedit))
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleInputPanelEvent(
+            preedit: FormattedText,
+            auxUp: FormattedText,
+            auxDown: FormattedText,
+            tabs: Array<CandidateAction>
+        ) {
+            dispatchFcitxEvent(
+                FcitxEvent.InputPanelEvent(
+                    FcitxEvent.InputPanelEvent.Data(preedit, auxUp, auxDown, tabs)
+                )
+            )
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleReadyEvent() {
+            dispatchFcitxEvent(FcitxEvent.ReadyEvent())
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleKeyEvent(sym: Int, states: Int, unicode: Int, up: Boolean, timestamp: Int) {
+            dispatchFcitxEvent(
+                FcitxEvent.KeyEvent(
+                    FcitxEvent.KeyEvent.Data(
+                        KeySym(sym),
+                        KeyStates.of(states),
+                        unicode,
+                        up,
+                        timestamp
+                    )
+                )
+            )
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleIMChangeEvent(im: InputMethodEntry) {
+            dispatchFcitxEvent(FcitxEvent.IMChangeEvent(im))
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleStatusAreaEvent(actions: Array<Action>, im: InputMethodEntry) {
+            dispatchFcitxEvent(
+                FcitxEvent.StatusAreaEvent(FcitxEvent.StatusAreaEvent.Data(actions, im))
+            )
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleDeleteSurroundingEvent(before: Int, after: Int) {
+            dispatchFcitxEvent(
+                FcitxEvent.DeleteSurroundingEvent(
+                    FcitxEvent.DeleteSurroundingEvent.Data(before, after)
+                )
+            )
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handlePagedCandidateEvent(
+            candidates: Array<CandidateWord>,
+            cursorIndex: Int,
+            layoutHint: Int,
+            hasPrev: Boolean,
+            hasNext: Boolean
+        ) {
+            val data = if (candidates.isEmpty()) {
+                FcitxEvent.PagedCandidateEvent.Data.Empty
+            } else {
+                FcitxEvent.PagedCandidateEvent.Data(
+                    candidates,
+                    cursorIndex,
+                    FcitxEvent.PagedCandidateEvent.LayoutHint.of(layoutHint),
+                    hasPrev,
+                    hasNext
+                )
+            }
+            dispatchFcitxEvent(FcitxEvent.PagedCandidateEvent(data))
+        }
+
+        /**
+         * Called from native-lib
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleSwitchInputMethodEvent(reason: Int, oldInputMethod: String) {
+            dispatchFcitxEvent(
+                FcitxEvent.SwitchInputMethodEvent(
+                    FcitxEvent.SwitchInputMethodEvent.Data(
+                        FcitxEvent.SwitchInputMethodEvent.Reason.of(reason),
+                        oldInputMethod
+                    )
+                )
+            )
+        }
+
+        /**
+         * Called from native-lib. [buffer] is reused by native code; only its first [size] bytes
+         * are valid, and only during this call.
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleCandidateBufferEvent(total: Int, buffer: ByteBuffer, size: Int) {
+            dispatchFcitxEvent(
+                FcitxEvent.CandidateListEvent(
+                    FcitxEvent.CandidateListEvent.Data(total, CandidateBuffer.copyOf(buffer, size))
+                )
+            )
+        }
+
+        /**
+         * Called from native-lib. See [handleCandidateBufferEvent] for the lifetime of [buffer].
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handlePagedCandidateBufferEvent(
+            buffer: ByteBuffer,
+            size: Int,
+            cursorIndex: Int,
+            layoutHint: Int,
+            hasPrev: Boolean,
+            hasNext: Boolean
+        ) {
+            val candidates = CandidateBuffer.copyOf(buffer, size)
+            val data = if (candidates.size == 0) {
+                FcitxEvent.PagedCandidateEvent.Data.Empty
+            } else {
+                FcitxEvent.PagedCandidateEvent.Data(
+                    candidates,
+                    cursorIndex,
+                    FcitxEvent.PagedCandidateEvent.LayoutHint.of(layoutHint),
+                    hasPrev,
+                    hasNext
+                )
+            }
+            dispatchFcitxEvent(FcitxEvent.PagedCandidateEvent(data))
+        }
+
+        private const val UI_ACTION_COMMIT_STRING = 0
+        private const val UI_ACTION_DELETE_SURROUNDING = 1
+        private const val UI_ACTION_FORWARD_KEY = 2
+        private const val UI_ACTION_STRIDE = 6
+
+        /**
+         * Called from native-lib with all UI changes produced by one key or one event loop
+         * iteration, see `UITransaction` in helper-types.h.
+         *
+         * [actions] are ordered commits, surrounding text deletions and forwarded keys, each of
+         * them takes [UI_ACTION_STRIDE] ints; commit strings are taken from [strings] in order.
+         * Other parameters are null when unchanged. [candidatesInfo] is
+         * `[pagingMode, total or cursorIndex, layoutHint, hasPrev, hasNext, generation, baseGeneration]`,
+         * see [handleCandidateBufferEvent] for the lifetime of [candidates].
+         * When [candidatesDelta] is not null, [candidates] only contains inserted candidates,
+         * see [CandidateDelta].
+         */
+        @Suppress("unused")
+        @JvmStatic
+        fun handleUITransactionEvent(
+            actions: IntArray,
+            strings: Array<String>,
+            clientPreedit: FormattedText?,
+            inputPanel: Array<FormattedText>?,
+            tabs: Array<CandidateAction>?,
+            candidates: ByteBuffer?,
+            candidatesSize: Int,
+            candidatesInfo: IntArray?,
+            candidatesDelta: IntArray?,
+            statusActions: Array<Action>?,
+            im: InputMethodEntry?
+        ) {
+            var stringIndex = 0
+            for (i in actions.indices step UI_ACTION_STRIDE) {
+                when (actions[i]) {
+                    UI_ACTION_COMMIT_STRING ->
+                        handleCommitStringEvent(strings[stringIndex++], actions[i + 1])
+                    UI_ACTION_DELETE_SURROUNDING ->
+                        handleDeleteSurroundingEvent(actions[i + 1], actions[i + 2])
+                    UI_ACTION_FORWARD_KEY -> handleKeyEvent(
+                        actions[i + 1], actions[i + 2], actions[i + 3], actions[i + 4] != 0, actions[i + 5]
+                    )
+                }
+            }
+            if (clientPreedit != null) {
+                handleClientPreeditEvent(clientPreedit)
+            }
+            if (inputPanel != null && tabs != null) {
+                handleInputPanelEvent(inputPanel[0], inputPanel[1], inputPanel[2], tabs)
+            }
+            if (candidates != null && candidatesInfo != null) {
+                if (candidatesInfo[0] == 0) {
+                    handleBulkCandidates(
+                        candidatesInfo[1],
+                        CandidateBuffer.copyOf(candidates, candidatesSize),
+                        candidatesInfo[5],
+                        candidatesInfo[6],
+                        candidatesDelta
+                    )
+                } else {
+                    handlePagedCandidateBufferEvent(
+                        candidates,
+                        candidatesSize,
+                        candidatesInfo[1],
+                        candidatesInfo[2],
+                        candidatesInfo[3] != 0,
+                        candidatesInfo[4] != 0
+                    )
+                }
+            }
+            if (statusActions != null && im != null) {
+                handleStatusAreaEvent(statusActions, im)
+            }
+        }
+
+        /**
+         * Bulk candidate list last dispatched, and its generation assigned by native-lib
+         */
+        private var lastCandidates: FcitxEvent.CandidateListEvent.Data? = null
+        private var lastCandidatesGeneration = 0
+
+        private fun handleBulkCandidates(
+            total: Int,
+            buffer: CandidateBuffer,
+            generation: Int,
+            baseGeneration: Int,
+            delta: IntArray?
+        ) {
+            val data = if (delta == null) {
+                FcitxEvent.CandidateListEvent.Data(total, buffer)
+            } else {
+                val last = lastCandidates
+                val applied = if (last != null && baseGeneration == lastCandidatesGeneration) {
+                    CandidateDelta.apply(last.candidates, buffer, delta)
+                } else null
+                if (applied == null) {
+                    Timber.w("Rejected candidate delta $baseGeneration -> $generation, last=$lastCandidatesGeneration")
+                    lastCandidatesGeneration = 0
+                    // ask for a full push
+                    resyncCandidates()
+                    return
+                }
+                FcitxEvent.CandidateListEvent.Data(total, applied)
+            }
+            lastCandidates = data
+            lastCandidatesGeneration = generation
+            dispatchFcitxEvent(FcitxEvent.CandidateListEvent(data))
+        }
+
+        private fun dispatchFcitxEvent(event: FcitxEvent<*>) {
             Timber.d("Handling $event")
             fcitxEventHandlers.forEach { it.invoke(event) }
             eventFlow_.tryEmit(event)
@@ -456,6 +885,9 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
                     extDomains.toTypedArray()
                 )
             }
+            lifecycle.launchWhenReady {
+                setInputContextCacheCapacity(inputContextCacheCapacity.getValue())
+            }
             if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.UPSIDE_DOWN_CAKE) {
                 lifecycle.launchWhenReady {
                     SubtypeManager.syncWith(enabledIme())
@@ -487,6 +919,14 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
         lifecycle.launchWhenReady { setClipboard(it.text, it.sensitive) }
     }
 
+    private val inputContextCacheCapacity = AppPrefs.getInstance().advanced.inputContextCacheCapacity
+
+    @Keep
+    private val onInputContextCacheCapacityChange =
+        ManagedPreference.OnChangeListener<Int> { _, value ->
+            lifecycle.launchWhenReady { setInputContextCacheCapacity(value) }
+        }
+
     private fun computeAddonGraph() = runBlocking {
         addons().flatMap { a ->
             a.dependencies.map {
@@ -540,6 +980,7 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
         registerFcitxEventHandler(::handleFcitxEvent)
         lifecycleRegistry.postEvent(FcitxLifecycle.Event.ON_START)
         ClipboardManager.addOnUpdateListener(onClipboardUpdate)
+        inputContextCacheCapacity.registerOnChangeListener(onInputContextCacheCapacityChange)
         DataManager.addOnNextSyncedCallback {
             FcitxPluginServices.connectAll()
         }
@@ -555,6 +996,7 @@ class Fcitx(private val context: Context) : FcitxAPI, FcitxLifecycleOwner {
         lifecycleRegistry.postEvent(FcitxLifecycle.Event.ON_STOP)
         Timber.i("Fcitx stop()")
         ClipboardManager.removeOnUpdateListener(onClipboardUpdate)
+        inputContextCacheCapacity.unregisterOnChangeListener(onInputContextCacheCapacityChange)
         FcitxPluginServices.disconnectAll()
         dispatcher.stop().let {
             if (it.isNotEmpty())
@@ -40,6 +40,21 @@ interface FcitxAPI {
 
     fun translate(str: String, domain: String = "fcitx5"): String
 
+    /**
+     * Record native trace events (event loop, addon loading, config reloads, dictionary
+     * conversions, UI pushes) into a bounded ring, keeping the latest ones. Works whether
+     * fcitx is running or not.
+     */
+    fun startTrace()
+
+    fun stopTrace()
+
+    /**
+     * Write recorded events as Chrome trace-event JSON, which Perfetto UI can open
+     * @return path of the file under cache dir, or null if it could not be written
+     */
+    fun dumpTrace(): String?
+
     suspend fun save()
 
     suspend fun reloadConfig()
@@ -98,10 +113,34 @@ interface FcitxAPI {
 
     suspend fun statusArea(): Array<Action>
 
+    /**
+     * Entries of the menu of status area action [id]; their own menus are left empty as well
+     */
+    suspend fun statusAreaMenu(id: Int): Array<Action>
+
+    suspend fun statusAreaStats(): StatusAreaStats
+
     suspend fun activateAction(id: Int)
 
     suspend fun getCandidates(offset: Int, limit: Int): Array<CandidateWord>
 
+    /**
+     * Open a cursor on current candidate list
+     * @return generation of the list, 0 if there is none
+     */
+    suspend fun openCandidateCursor(): Int
+
+    /**
+     * Read candidates of the list opened by [openCandidateCursor]
+     * @return null if the list of [generation] has been replaced
+     */
+    suspend fun readCandidates(generation: Int, offset: Int, limit: Int): Array<CandidateWord>?
+
+    /**
+     * Number of bulk candidates in the first push, and in each window prefetched after it
+     */
+    suspend fun setCandidateWindowSize(size: Int)
+
     suspend fun getCandidateActions(idx: Int): Array<CandidateAction>
     suspend fun triggerCandidateAction(idx: Int, actionIdx: Int)
 
@@ -110,4 +149,33 @@ interface FcitxAPI {
 
     suspend fun triggerCandidateListTabAction(id: Int)
 
+    suspend fun eventQueueStats(): EventQueueStats
+
+    suspend fun stringPoolStats(): StringPoolStats
+
+    /**
+     * Input contexts of least recently used apps are destroyed beyond [capacity]
+     */
+    suspend fun setInputContextCacheCapacity(capacity: Int)
+
+    suspend fun inputContextCacheStats(): InputContextCacheStats
+
+    suspend fun outputFilterCacheStats(): OutputFilterCacheStats
+
+    /**
+     * Minimum interval in microseconds between UI pushes while keys arrive faster than that;
+     * commits are never held. 0 pushes every change.
+     */
+    suspend fun setUIFrameBudget(micros: Int)
+
+    suspend fun uiFrameStats(): UIFrameStats
+
+    /**
+     * Time each stage of key presses, from JNI entry to the UI callback. Turning it on drops
+     * results collected before; they are kept after turning it off.
+     */
+    suspend fun setKeystrokeTracing(enabled: Boolean)
+
+    suspend fun keystrokeLatency(): KeystrokeLatency
+
 }
\ No newline at end of file
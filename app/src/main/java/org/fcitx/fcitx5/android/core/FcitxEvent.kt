@@ -13,10 +13,36 @@ sealed class FcitxEvent<T>(open val data: T) {
 
         override val eventType = EventType.Candidate
 
-        data class Data(val total: Int = -1, val candidates: Array<CandidateWord> = emptyArray()) {
+        class Data private constructor(
+            val total: Int,
+            private val buffer: CandidateBuffer?,
+            array: Array<CandidateWord>?
+        ) {
+            constructor(total: Int = -1, candidates: Array<CandidateWord> = emptyArray()) :
+                    this(total, null, candidates)
+
+            /**
+             * candidates in [buffer] are decoded on first access of [candidates]
+             */
+            constructor(total: Int, buffer: CandidateBuffer) : this(total, buffer, null)
+
+            private val lazyCandidates = lazy { array ?: buffer!!.toArray() }
+
+            val candidates: Array<CandidateWord> by lazyCandidates
+
+            val size: Int
+                get() = buffer?.size ?: candidates.size
+
+            operator fun component1() = total
+
+            operator fun component2() = candidates
 
-            override fun toString(): String =
+            // don't decode candidates just for logging
+            override fun toString(): String = if (lazyCandidates.isInitialized()) {
                 "total=$total, candidates=[${candidates.joinToString(limit = 5)}]"
+            } else {
+                "total=$total, candidates=[$size encoded]"
+            }
 
             override fun equals(other: Any?): Boolean {
                 if (this === other) return true
@@ -168,18 +194,56 @@ sealed class FcitxEvent<T>(open val data: T) {
             }
         }
 
-        data class Data(
-            val candidates: Array<CandidateWord>,
+        class Data private constructor(
+            private val buffer: CandidateBuffer?,
+            array: Array<CandidateWord>?,
             val cursorIndex: Int,
             val layoutHint: LayoutHint,
             val hasPrev: Boolean,
             val hasNext: Boolean
         ) {
+            constructor(
+                candidates: Array<CandidateWord>,
+                cursorIndex: Int,
+                layoutHint: LayoutHint,
+                hasPrev: Boolean,
+                hasNext: Boolean
+            ) : this(null, candidates, cursorIndex, layoutHint, hasPrev, hasNext)
+
+            /**
+             * candidates in [buffer] are decoded on first access of [candidates]
+             */
+            constructor(
+                buffer: CandidateBuffer,
+                cursorIndex: Int,
+                layoutHint: LayoutHint,
+                hasPrev: Boolean,
+                hasNext: Boolean
+            ) : this(buffer, null, cursorIndex, layoutHint, hasPrev, hasNext)
+
+            private val lazyCandidates = lazy { array ?: buffer!!.toArray() }
+
+            val candidates: Array<CandidateWord> by lazyCandidates
+
+            val size: Int
+                get() = buffer?.size ?: candidates.size
+
             companion object {
                 @Suppress("BooleanLiteralArgument")
                 val Empty = Data(emptyArray(), -1, LayoutHint.NotSet, false, false)
             }
 
+            // don't decode candidates just for logging
+            override fun toString(): String {
+                val c = if (lazyCandidates.isInitialized()) {
+                    candidates.joinToString(limit = 5)
+                } else {
+                    "$size encoded"
+                }
+                return "Data(candidates=[$c], cursorIndex=$cursorIndex, layoutHint=$layoutHint, " +
+                        "hasPrev=$hasPrev, hasNext=$hasNext)"
+            }
+
             override fun equals(other: Any?): Boolean {
                 if (this === other) return true
                 if (javaClass != other?.javaClass) return false
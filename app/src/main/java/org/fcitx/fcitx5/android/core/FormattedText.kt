@@ -41,42 +41,29 @@ data class FormattedText(
 
     constructor() : this(arrayOf(), intArrayOf(), -1)
 
+    /**
+     * Called from native-lib, which computes [offsets] while converting [strings]:
+     * start of each string counted by Java's String length, followed by the total length.
+     */
+    @Suppress("UNUSED")
+    constructor(
+        strings: Array<String>,
+        flags: IntArray,
+        offsets: IntArray,
+        cursor: Int
+    ) : this(strings, flags, cursor) {
+        this.offsets = offsets
+    }
+
+    private var offsets: IntArray? = null
+
     companion object {
         @JvmStatic
         val Empty = FormattedText()
-
-        @JvmStatic
-        @Suppress("UNUSED") // called from JNI
-        fun fromByteCursor(
-            strings: Array<String>,
-            flags: IntArray,
-            byteCursor: Int
-        ): FormattedText {
-            val cursor = if (byteCursor <= 0) {
-                byteCursor
-            } else {
-                StringBuilder().apply {
-                    var byteSize = 0
-                    strings.forEach {
-                        val bytes = it.toByteArray()
-                        val total = byteSize + bytes.size
-                        if (total < byteCursor) {
-                            append(it)
-                            byteSize = total
-                        } else {
-                            if (total == byteCursor) append(it)
-                            else append(String(bytes.copyOfRange(0, byteCursor - byteSize)))
-                            return@apply
-                        }
-                    }
-                }.length
-            }
-            return FormattedText(strings, flags, cursor)
-        }
     }
 
     val length: Int
-        get() = strings.sumOf { it.length }
+        get() = offsets?.last() ?: strings.sumOf { it.length }
 
     override fun toString() = buildString { strings.forEach { append(it) } }
 
@@ -238,6 +238,10 @@ data class Action(
     val icon: String,
     val shortText: String,
     val longText: String,
+    /**
+     * Entries are not sent with the status area, an empty array means the action has a menu
+     * that should be fetched with [FcitxAPI.statusAreaMenu]
+     */
     val menu: Array<Action>?
 ) {
     override fun equals(other: Any?): Boolean {
@@ -272,3 +276,169 @@ data class CandidateAction(
     val isCheckable: Boolean,
     val isChecked: Boolean
 )
+
+/**
+ * Counters of the native event queue, which batches events delivered to JVM
+ * once per event loop iteration
+ */
+data class EventQueueStats(
+    val delivered: Long,
+    /**
+     * events posted while the queue was already deeper than its high-water mark,
+     * a sign that the event loop stalled; they are still delivered in order
+     */
+    val overflowed: Long,
+    val batches: Long,
+    val peakDepth: Long,
+    val maxAgeNanos: Long,
+    val totalAgeNanos: Long,
+    val currentDepth: Long
+) {
+    val averageAgeNanos: Long
+        get() = if (delivered == 0L) 0L else totalAgeNanos / delivered
+
+    companion object {
+        fun fromArray(array: LongArray) = EventQueueStats(
+            array[0], array[1], array[2], array[3], array[4], array[5], array[6]
+        )
+    }
+}
+
+/**
+ * Counters of the native pool of interned Java strings, which is cleared on config reload
+ */
+data class StringPoolStats(
+    val hits: Long,
+    val misses: Long,
+    val evictions: Long,
+    val size: Long,
+    val bytes: Long
+) {
+    companion object {
+        fun fromArray(array: LongArray) = StringPoolStats(
+            array[0], array[1], array[2], array[3], array[4]
+        )
+    }
+}
+
+/**
+ * Counters of the native cache of input contexts, keyed by uid of client app
+ */
+data class InputContextCacheStats(
+    val hits: Long,
+    val misses: Long,
+    val insertions: Long,
+    val evictions: Long,
+    val size: Long,
+    val capacity: Long,
+    /** input contexts created from scratch, and nanoseconds from activation to focus in total */
+    val coldActivations: Long,
+    val coldActivationNanos: Long,
+    /** input contexts created with state restored from the snapshot of a previous process */
+    val warmActivations: Long,
+    val warmActivationNanos: Long
+) {
+    companion object {
+        const val SIZE = 10
+
+        fun fromArray(array: LongArray) = InputContextCacheStats(
+            array[0], array[1], array[2], array[3], array[4], array[5],
+            array[6], array[7], array[8], array[9]
+        )
+    }
+}
+
+/**
+ * Counters of the native memo of output filter (eg. chttrans) results for candidates,
+ * shared by all input contexts
+ */
+data class OutputFilterCacheStats(
+    val hits: Long,
+    val misses: Long,
+    val evictions: Long,
+    /** times cached results were dropped because input method or addon state changed */
+    val invalidations: Long
+) {
+    val hitRate: Double
+        get() = if (hits + misses == 0L) 0.0 else hits.toDouble() / (hits + misses)
+
+    companion object {
+        const val SIZE = 4
+
+        fun fromArray(array: LongArray) = OutputFilterCacheStats(
+            array[0], array[1], array[2], array[3]
+        )
+    }
+}
+
+/**
+ * Counters of native UI push pacing
+ */
+data class UIFrameStats(
+    val delivered: Long,
+    /** states replaced by a newer one within the same frame, never pushed */
+    val dropped: Long,
+    /** pushes made before the frame deadline because of a commit */
+    val immediate: Long
+) {
+    companion object {
+        const val SIZE = 3
+
+        fun fromArray(array: LongArray) = UIFrameStats(array[0], array[1], array[2])
+    }
+}
+
+/**
+ * Counters of native status area updates
+ */
+data class StatusAreaStats(
+    val flushes: Long,
+    /** flushes not sent because the status area looked the same as the last one sent */
+    val suppressed: Long,
+    /** submenus fetched with [FcitxAPI.statusAreaMenu] */
+    val menus: Long
+) {
+    companion object {
+        const val SIZE = 3
+
+        fun fromArray(array: LongArray) = StatusAreaStats(array[0], array[1], array[2])
+    }
+}
+
+/**
+ * Latency percentiles of one keystroke stage, in nanoseconds
+ */
+data class StageLatency(
+    val count: Long,
+    val p50: Long,
+    val p95: Long,
+    val p99: Long
+)
+
+/**
+ * Native keystroke latency by stage, see [FcitxAPI.setKeystrokeTracing]
+ */
+data class KeystrokeLatency(
+    val jni: StageLatency,
+    val frontendKeyEvent: StageLatency,
+    val engine: StageLatency,
+    val flushUI: StageLatency,
+    val candidates: StageLatency,
+    val callback: StageLatency,
+    /** key press entering JNI until the end of the next UI callback */
+    val total: StageLatency,
+    /** spans lost because they were recorded faster than collected */
+    val dropped: Long
+) {
+    companion object {
+        const val STAGES = 7
+        const val SIZE = STAGES * 4 + 1
+
+        fun fromArray(array: LongArray): KeystrokeLatency {
+            val s = Array(STAGES) {
+                StageLatency(array[it * 4], array[it * 4 + 1], array[it * 4 + 2], array[it * 4 + 3])
+            }
+            return KeystrokeLatency(s[0], s[1], s[2], s[3], s[4], s[5], s[6], array[STAGES * 4])
+        }
+    }
+}
@@ -56,6 +56,13 @@ class AppPrefs(private val sharedPreferences: SharedPreferences) {
             "keyboard_height_percent_base",
             KeyboardHeightPercentBase.DisplayMetrics
         )
+        val inputContextCacheCapacity = int(
+            R.string.input_context_cache_capacity,
+            "input_context_cache_capacity",
+            80,
+            4,
+            512
+        )
     }
 
     inner class Keyboard : ManagedPreferenceCategory(R.string.virtual_keyboard, sharedPreferences) {
@@ -18,6 +18,7 @@ import android.os.SystemClock
 import android.text.InputType
 import android.util.LruCache
 import android.util.Size
+import android.view.Display
 import android.view.KeyCharacterMap
 import android.view.KeyEvent
 import android.view.View
@@ -68,6 +69,7 @@ import org.fcitx.fcitx5.android.input.cursor.CursorTracker
 import org.fcitx.fcitx5.android.utils.InputMethodUtil
 import org.fcitx.fcitx5.android.utils.alpha
 import org.fcitx.fcitx5.android.utils.forceShowSelf
+import org.fcitx.fcitx5.android.utils.displayManager
 import org.fcitx.fcitx5.android.utils.inputMethodManager
 import org.fcitx.fcitx5.android.utils.isTypeNull
 import org.fcitx.fcitx5.android.utils.monitorCursorAnchor
@@ -223,6 +225,11 @@ class FcitxInputMethodService : LifecycleInputMethodService() {
                 SubtypeManager.syncWith(enabledIme())
             }
         }
+        // push UI at most once per display frame when keys come in faster than that
+        val refreshRate = displayManager.getDisplay(Display.DEFAULT_DISPLAY)?.refreshRate ?: 60f
+        postFcitxJob {
+            setUIFrameBudget((1_000_000f / refreshRate).toInt())
+        }
         super.onCreate()
         decorView = window.window!!.decorView
         contentView = decorView.findViewById(android.R.id.content)
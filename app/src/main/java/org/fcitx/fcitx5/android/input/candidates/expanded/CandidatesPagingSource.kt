@@ -13,14 +13,20 @@ import timber.log.Timber
 class CandidatesPagingSource(val fcitx: FcitxConnection, val total: Int, val offset: Int) :
     PagingSource<Int, CandidateWord>() {
 
+    /**
+     * Generation of the candidate list this source reads, 0 if not opened yet
+     */
+    private var generation = 0
+
     override suspend fun load(params: LoadParams<Int>): LoadResult<Int, CandidateWord> {
         // use candidate index for key, null means load from beginning (with offset)
         val startIndex = params.key ?: offset
         val pageSize = params.loadSize
-        Timber.d("getCandidates(offset=$startIndex, limit=$pageSize)")
+        Timber.d("readCandidates(generation=$generation, offset=$startIndex, limit=$pageSize)")
         val candidates = fcitx.runOnReady {
-            getCandidates(startIndex, pageSize)
-        }
+            if (generation == 0) generation = openCandidateCursor()
+            if (generation == 0) emptyArray() else readCandidates(generation, startIndex, pageSize)
+        } ?: return LoadResult.Invalid() // candidate list has changed, let Pager create a new source
         val prevKey = if (startIndex >= pageSize) startIndex - pageSize else null
         val nextKey = if (total > 0) {
             if (startIndex + pageSize + 1 >= total) null else startIndex + pageSize
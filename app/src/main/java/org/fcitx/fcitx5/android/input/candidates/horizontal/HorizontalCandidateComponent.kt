@@ -56,6 +56,11 @@ class HorizontalCandidateComponent :
     }
 
     private var layoutMinWidth = 0
+
+    /**
+     * Candidates requested in the first push, estimated from view width
+     */
+    private var candidateWindowSize = 0
     private var layoutFlexGrow = 1f
 
     /**
@@ -152,10 +157,11 @@ class HorizontalCandidateComponent :
         object : RecyclerView(context) {
             override fun onSizeChanged(w: Int, h: Int, oldw: Int, oldh: Int) {
                 super.onSizeChanged(w, h, oldw, oldh)
+                val maxSpanCount = maxSpanCountPref.getValue()
                 if (fillStyle == AutoFillWidth) {
-                    val maxSpanCount = maxSpanCountPref.getValue()
                     layoutMinWidth = w / maxSpanCount - dividerDrawable.intrinsicWidth
                 }
+                updateCandidateWindowSize(w, maxSpanCount)
             }
         }.apply {
             id = R.id.candidate_view
@@ -166,6 +172,17 @@ class HorizontalCandidateComponent :
         }
     }
 
+    private fun updateCandidateWindowSize(width: Int, maxSpanCount: Int) {
+        if (width <= 0) return
+        // narrowest candidate is a single character with padding; keep one more row worth of
+        // candidates so that the bar still fills up after short ones are laid out
+        val fits = width / max(1, context.dp(MIN_CANDIDATE_WIDTH_DP))
+        val size = max(fits, maxSpanCount) + maxSpanCount
+        if (size == candidateWindowSize) return
+        candidateWindowSize = size
+        fcitx.launchOnReady { it.setCandidateWindowSize(size) }
+    }
+
     override fun onCandidateUpdate(data: FcitxEvent.CandidateListEvent.Data) {
         val candidates = data.candidates
         val total = data.total
@@ -195,4 +212,8 @@ class HorizontalCandidateComponent :
             refreshExpanded(0)
         }
     }
+
+    companion object {
+        private const val MIN_CANDIDATE_WIDTH_DP = 36
+    }
 }
@@ -88,52 +88,62 @@ class StatusAreaWindow : InputWindow.ExtendedInputWindow<StatusAreaWindow>(),
 
     var popupMenu: PopupMenu? = null
 
+    private fun showMenu(view: View, actions: Array<Action>) {
+        val popup = PopupMenu(context, view)
+        val menu = popup.menu
+        val hasDivider =
+            if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.P && !DeviceUtil.isHMOS && !DeviceUtil.isHonorMagicOS) {
+                menu.setGroupDividerEnabled(true)
+                true
+            } else {
+                false
+            }
+        var groupId = 0 // Menu.NONE; ungrouped
+        actions.forEach {
+            if (it.isSeparator) {
+                if (hasDivider) {
+                    groupId++
+                } else {
+                    val dividerString = buildSpannedString {
+                        color(context.styledColor(android.R.attr.colorForeground).alpha(0.4f)) {
+                            append("──────────")
+                        }
+                    }
+                    menu.add(groupId, 0, 0, dividerString).apply {
+                        isEnabled = false
+                    }
+                }
+            } else {
+                menu.add(groupId, 0, 0, it.shortText).apply {
+                    setOnMenuItemClickListener { _ ->
+                        activateAction(it)
+                        true
+                    }
+                }
+            }
+        }
+        popupMenu?.dismiss()
+        popupMenu = popup
+        popup.show()
+    }
+
     private val adapter: StatusAreaAdapter by lazy {
         object : StatusAreaAdapter() {
             override fun onItemClick(view: View, entry: StatusAreaEntry) {
                 when (entry) {
                     is StatusAreaEntry.Fcitx -> {
-                        val actions = entry.action.menu
-                        if (actions.isNullOrEmpty()) {
-                            activateAction(entry.action)
-                            return
-                        }
-                        val popup = PopupMenu(context, view)
-                        val menu = popup.menu
-                        val hasDivider =
-                            if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.P && !DeviceUtil.isHMOS && !DeviceUtil.isHonorMagicOS) {
-                                menu.setGroupDividerEnabled(true)
-                                true
-                            } else {
-                                false
-                            }
-                        var groupId = 0 // Menu.NONE; ungrouped
-                        actions.forEach {
-                            if (it.isSeparator) {
-                                if (hasDivider) {
-                                    groupId++
-                                } else {
-                                    val dividerString = buildSpannedString {
-                                        color(context.styledColor(android.R.attr.colorForeground).alpha(0.4f)) {
-                                            append("──────────")
-                                        }
-                                    }
-                                    menu.add(groupId, 0, 0, dividerString).apply {
-                                        isEnabled = false
-                                    }
-                                }
-                            } else {
-                                menu.add(groupId, 0, 0, it.shortText).apply {
-                                    setOnMenuItemClickListener { _ ->
-                                        activateAction(it)
-                                        true
-                                    }
+                        val action = entry.action
+                        when {
+                            action.menu == null -> activateAction(action)
+                            action.menu.isNotEmpty() -> showMenu(view, action.menu)
+                            // entries of menus are fetched when they are opened
+                            else -> fcitx.launchOnReady {
+                                val actions = it.statusAreaMenu(action.id)
+                                service.lifecycleScope.launch {
+                                    if (actions.isEmpty()) activateAction(action) else showMenu(view, actions)
                                 }
                             }
                         }
-                        popupMenu?.dismiss()
-                        popupMenu = popup
-                        popup.show()
                     }
                     is StatusAreaEntry.Android -> when (entry.type) {
                         InputMethod -> fcitx.runImmediately { inputMethodEntryCached }.let {
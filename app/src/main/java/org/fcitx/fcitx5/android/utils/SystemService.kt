@@ -7,6 +7,7 @@ package org.fcitx.fcitx5.android.utils
 import android.app.NotificationManager
 import android.content.ClipboardManager
 import android.content.Context
+import android.hardware.display.DisplayManager
 import android.media.AudioManager
 import android.os.UserManager
 import android.os.Vibrator
@@ -21,6 +22,9 @@ val Context.audioManager
 val Context.clipboardManager
     get() = getSystemService<ClipboardManager>()!!
 
+val Context.displayManager
+    get() = getSystemService<DisplayManager>()!!
+
 val Context.inputMethodManager
     get() = getSystemService<InputMethodManager>()!!
 
@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Replays recorded pinyin sessions and compares full candidate pushes with deltas.
+// usage: benchcandidatedelta [sessions file]
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "candidate-delta.h"
+#include "utf16-utils.h"
+
+using List = std::vector<std::string>;
+
+static std::vector<std::vector<List>> readSessions(const char *path) {
+    std::vector<std::vector<List>> sessions(1);
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.starts_with('#')) continue;
+        if (line.empty()) {
+            if (!sessions.back().empty()) sessions.emplace_back();
+            continue;
+        }
+        List list;
+        std::istringstream words(line);
+        std::string word;
+        while (words >> word) {
+            list.push_back(word);
+        }
+        sessions.back().push_back(std::move(list));
+    }
+    if (sessions.back().empty()) sessions.pop_back();
+    return sessions;
+}
+
+// size of one entry in CandidateBuffer, see helper-types.h; label and comment are empty in bulk mode
+static size_t entryBytes(const std::string &text) {
+    std::vector<char16_t> units(text.size());
+    const auto length = utf16::fromUtf8(text.data(), text.size(), units.data());
+    return sizeof(uint16_t) + 3 * sizeof(uint16_t) + length * sizeof(char16_t) + sizeof(int32_t);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 ? argv[1] : HOST_TEST_DATA_DIR "/pinyin-sessions.txt";
+    const auto sessions = readSessions(path);
+    if (sessions.empty()) {
+        std::fprintf(stderr, "no session in %s\n", path);
+        return 1;
+    }
+    constexpr size_t HeaderBytes = 2 * sizeof(int32_t);
+    // CandidateWord and its text String; empty label and comment share one String
+    constexpr size_t ObjectsPerEntry = 2;
+    size_t pushes = 0, deltaPushes = 0;
+    size_t fullBytes = 0, deltaBytes = 0;
+    size_t fullObjects = 0, deltaObjects = 0;
+    std::chrono::nanoseconds encodeTime{0};
+    std::vector<size_t> inserted;
+    for (const auto &session: sessions) {
+        const List *prev = nullptr;
+        for (const auto &next: session) {
+            pushes++;
+            size_t full = HeaderBytes;
+            for (const auto &c: next) full += entryBytes(c);
+            fullBytes += full;
+            fullObjects += ObjectsPerEntry * next.size();
+            std::vector<int32_t> ops;
+            if (prev) {
+                const auto start = std::chrono::steady_clock::now();
+                ops = candidate_delta::encode(*prev, next, inserted);
+                encodeTime += std::chrono::steady_clock::now() - start;
+            }
+            if (ops.empty()) {
+                deltaBytes += full;
+                deltaObjects += ObjectsPerEntry * next.size();
+            } else {
+                deltaPushes++;
+                size_t bytes = HeaderBytes + ops.size() * sizeof(int32_t);
+                for (const auto i: inserted) bytes += entryBytes(next[i]);
+                deltaBytes += bytes;
+                // plus the int[] carrying ops
+                deltaObjects += ObjectsPerEntry * inserted.size() + 1;
+            }
+            prev = &next;
+        }
+    }
+    std::printf("{\n"
+                "  \"sessions\": %zu,\n"
+                "  \"pushes\": %zu,\n"
+                "  \"deltaPushes\": %zu,\n"
+                "  \"fullBytes\": %zu,\n"
+                "  \"deltaBytes\": %zu,\n"
+                "  \"bytesSaved\": %zu,\n"
+                "  \"fullObjects\": %zu,\n"
+                "  \"deltaObjects\": %zu,\n"
+                "  \"objectsSaved\": %zu,\n"
+                "  \"encodeNanosPerPush\": %lld\n"
+                "}\n",
+                sessions.size(), pushes, deltaPushes,
+                fullBytes, deltaBytes, fullBytes - deltaBytes,
+                fullObjects, deltaObjects, fullObjects - deltaObjects,
+                static_cast<long long>(encodeTime.count() / static_cast<long long>(pushes)));
+    return 0;
+}
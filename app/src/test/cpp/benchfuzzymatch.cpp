@@ -0,0 +1,159 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Typo corrections of FuzzyMatcher for partial words with one mistyped key, over a generated
+// dictionary, or a spell dictionary (.fscd) if given; against scoring every word with the
+// weighted distance, which is what the screening saves.
+// usage: benchfuzzymatch [inputs] [dictionary size | path to .fscd]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "androidkeyboard/fuzzymatcher.h"
+
+// same as AndroidKeyboardEngine
+static constexpr auto CorrectionTimeBudget = std::chrono::milliseconds(2);
+static constexpr size_t CorrectionSize = 5;
+
+struct Rng {
+    uint64_t state;
+
+    uint32_t next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(state >> 33);
+    }
+
+    size_t below(size_t n) { return next() % n; }
+};
+
+static FuzzyDictionary generate(size_t size, Rng &rng) {
+    static const char *onsets[] = {"b", "c", "d", "f", "g", "h", "l", "m", "n", "p", "r", "s",
+                                   "t", "w", "st", "tr", "ch", "sh", "th", "pr", "k", "v"};
+    static const char *nuclei[] = {"a", "e", "i", "o", "u", "ea", "ou", "ai", "y"};
+    static const char *codas[] = {"", "", "n", "r", "t", "s", "ng", "ck", "ll", "m", "x"};
+    std::vector<std::pair<std::string, uint16_t>> entries;
+    std::unordered_set<std::string> seen;
+    while (entries.size() < size) {
+        std::string word;
+        const auto syllables = 1 + rng.below(4);
+        for (size_t i = 0; i < syllables; i++) {
+            word += onsets[rng.below(std::size(onsets))];
+            word += nuclei[rng.below(std::size(nuclei))];
+            word += codas[rng.below(std::size(codas))];
+        }
+        // FuzzyDictionary drops duplicates, and `size` distinct words are asked for
+        if (seen.insert(word).second) {
+            entries.emplace_back(word, static_cast<uint16_t>(rng.below(65536)));
+        }
+    }
+    FuzzyDictionary dict;
+    dict.build(std::move(entries));
+    return dict;
+}
+
+// a key next to `c` on QWERTY
+static char neighbour(char c, Rng &rng) {
+    std::vector<char> keys;
+    for (char k = 'a'; k <= 'z'; k++) {
+        if (FuzzyMatcher::adjacent(c, k)) keys.push_back(k);
+    }
+    return keys.empty() ? c : keys[rng.below(keys.size())];
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+int main(int argc, char *argv[]) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    Rng rng{20261018};
+    FuzzyDictionary dict;
+    std::string source = "generated";
+    if (argc > 2 && std::strstr(argv[2], ".fscd")) {
+        std::ifstream in(argv[2], std::ios::binary);
+        if (!dict.loadFscd(in)) {
+            std::fprintf(stderr, "cannot read %s\n", argv[2]);
+            return 1;
+        }
+        source = argv[2];
+    } else {
+        dict = generate(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000, rng);
+    }
+
+    // prefixes of 3 to 8 letters of random words, one letter replaced by a neighbour
+    std::vector<std::pair<std::string, std::string>> inputs;
+    while (inputs.size() < count) {
+        const auto word = std::string(dict.word(rng.below(dict.size())));
+        if (word.size() < 3) continue;
+        auto typed = word.substr(0, std::min<size_t>(word.size(), 3 + rng.below(6)));
+        auto &c = typed[rng.below(typed.size())];
+        const char wrong = neighbour(c, rng);
+        if (wrong == c) continue;
+        c = wrong;
+        inputs.emplace_back(typed, word);
+    }
+
+    std::vector<double> micros;
+    size_t exhausted = 0, found = 0, corrections = 0;
+    for (const auto &[typed, intended]: inputs) {
+        const int maxCost = typed.size() <= 4 ? 2 : 3;
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = FuzzyMatcher::match(dict, typed, maxCost, CorrectionSize, CorrectionTimeBudget);
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        micros.push_back(elapsed.count());
+        exhausted += result.exhausted;
+        corrections += result.corrections.size();
+        for (const auto &c: result.corrections) {
+            // the intended word, or another one sharing the typed prefix
+            if (c.word.compare(0, typed.size(), intended, 0, typed.size()) == 0) {
+                found++;
+                break;
+            }
+        }
+    }
+    std::sort(micros.begin(), micros.end());
+
+    // same inputs, weighted distance of every word
+    const size_t baselineCount = std::min<size_t>(count, 200);
+    size_t checksum = 0;
+    const auto baselineStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < baselineCount; i++) {
+        const auto &typed = inputs[i].first;
+        const int maxCost = typed.size() <= 4 ? 2 : 3;
+        for (size_t w = 0; w < dict.size(); w++) {
+            checksum += FuzzyMatcher::prefixCost(typed, dict.word(w), maxCost) <= maxCost;
+        }
+    }
+    const std::chrono::duration<double, std::micro> baseline = std::chrono::steady_clock::now() - baselineStart;
+
+    const auto n = static_cast<double>(count);
+    std::printf("{\n"
+                "  \"dictionary\": \"%s\",\n"
+                "  \"words\": %zu,\n"
+                "  \"inputs\": %zu,\n"
+                "  \"budgetMicros\": %lld,\n"
+                "  \"latencyMicros\": {\"p50\": %.1f, \"p95\": %.1f, \"p99\": %.1f, \"max\": %.1f},\n"
+                "  \"exhausted\": %zu,\n"
+                "  \"correctionsPerInput\": %.2f,\n"
+                "  \"intendedPrefixFound\": %.3f,\n"
+                "  \"unscreenedMicros\": %.1f,\n"
+                "  \"checksum\": %zu\n"
+                "}\n",
+                source.c_str(), dict.size(), count,
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(CorrectionTimeBudget).count()),
+                percentile(micros, 0.5), percentile(micros, 0.95), percentile(micros, 0.99),
+                micros.empty() ? 0 : micros.back(),
+                exhausted, static_cast<double>(corrections) / n, static_cast<double>(found) / n,
+                baseline.count() / static_cast<double>(baselineCount), checksum);
+    return 0;
+}
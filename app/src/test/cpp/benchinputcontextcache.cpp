@@ -0,0 +1,115 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Activate/deactivate churn on the input context cache, compared with the std::map +
+// std::list LRU it replaced.
+// usage: benchinputcontextcache [apps] [capacity] [switches]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "androidfrontend/slablrucache.h"
+
+struct Context {
+    int uid;
+};
+
+// previous InputContextCache, reduced to what activate/deactivate use
+class MapListCache {
+public:
+    explicit MapListCache(size_t sz) : sz_(sz) {}
+
+    std::unique_ptr<Context> *find(int key) {
+        auto i = dict_.find(key);
+        if (i == dict_.end()) return nullptr;
+        auto j = i->second.second;
+        if (j != order_.begin()) {
+            order_.splice(order_.begin(), order_, j, std::next(j));
+            i->second.second = order_.begin();
+        }
+        return &i->second.first;
+    }
+
+    std::unique_ptr<Context> *insert(int key, Context *value) {
+        if (dict_.size() >= sz_) {
+            auto i = std::prev(order_.end());
+            dict_.erase(*i);
+            order_.erase(i);
+        }
+        order_.push_front(key);
+        auto r = dict_.emplace(key, std::make_pair(std::unique_ptr<Context>(value), order_.begin()));
+        return &r.first->second.first;
+    }
+
+private:
+    std::map<int, std::pair<std::unique_ptr<Context>, std::list<int>::iterator>> dict_;
+    std::list<int> order_;
+    size_t sz_;
+};
+
+// app switches follow a Zipf distribution: a few apps are used most of the time
+static std::vector<int> makeSwitches(int apps, int count) {
+    std::vector<double> weights(apps);
+    for (int i = 0; i < apps; i++) {
+        weights[i] = 1.0 / std::pow(i + 1, 1.1);
+    }
+    std::discrete_distribution<int> dist(weights.begin(), weights.end());
+    std::mt19937 rng(7);
+    std::vector<int> uids(count);
+    for (auto &uid: uids) {
+        // app uids start from 10000
+        uid = 10000 + dist(rng);
+    }
+    return uids;
+}
+
+template<typename Cache>
+static double run(Cache &cache, const std::vector<int> &uids, size_t &misses) {
+    const auto start = std::chrono::steady_clock::now();
+    misses = 0;
+    for (const auto uid: uids) {
+        // activateInputContext
+        if (!cache.find(uid)) {
+            misses++;
+            cache.insert(uid, new Context{uid});
+        }
+        // deactivateInputContext
+        cache.find(uid);
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(uids.size());
+}
+
+int main(int argc, char *argv[]) {
+    const int apps = argc > 1 ? std::atoi(argv[1]) : 200;
+    const size_t capacity = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 80;
+    const int count = argc > 3 ? std::atoi(argv[3]) : 2000000;
+    const auto uids = makeSwitches(apps, count);
+    size_t mapMisses, slabMisses;
+    MapListCache mapCache(capacity);
+    const double mapNanos = run(mapCache, uids, mapMisses);
+    SlabLRUCache<Context> slabCache(capacity);
+    const double slabNanos = run(slabCache, uids, slabMisses);
+    const auto &stats = slabCache.stats();
+    std::printf("{\n"
+                "  \"apps\": %d,\n"
+                "  \"capacity\": %zu,\n"
+                "  \"switches\": %d,\n"
+                "  \"misses\": %zu,\n"
+                "  \"evictions\": %llu,\n"
+                "  \"mapListNanosPerSwitch\": %.1f,\n"
+                "  \"slabNanosPerSwitch\": %.1f\n"
+                "}\n",
+                apps, capacity, count, slabMisses,
+                static_cast<unsigned long long>(stats.evictions),
+                mapNanos, slabNanos);
+    return mapMisses == slabMisses ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Replays recorded pinyin sessions through a simplified to traditional conversion, as chttrans
+// does in Instance::outputFilter, with and without OutputFilterCache.
+// OpenCC is not available on host, so conversion is a longest match over a small phrase table,
+// which is much cheaper than OpenCC. Hit rate carries over as is; the cache pays off when
+// filterNanosPerCall is above cacheNanosPerLookup / hitRate.
+// usage: benchoutputfiltercache [sessions file] [rounds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "androidfrontend/outputfiltercache.h"
+
+using List = std::vector<std::string>;
+
+static std::vector<std::vector<List>> readSessions(const char *path) {
+    std::vector<std::vector<List>> sessions(1);
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.starts_with('#')) continue;
+        if (line.empty()) {
+            if (!sessions.back().empty()) sessions.emplace_back();
+            continue;
+        }
+        List list;
+        std::istringstream words(line);
+        std::string word;
+        while (words >> word) {
+            list.push_back(word);
+        }
+        sessions.back().push_back(std::move(list));
+    }
+    if (sessions.back().empty()) sessions.pop_back();
+    return sessions;
+}
+
+static const std::unordered_map<std::string, std::string> &table() {
+    static const std::unordered_map<std::string, std::string> t = {
+            {"这", "這"}, {"们", "們"}, {"会", "會"}, {"还", "還"}, {"号", "號"}, {"国", "國"},
+            {"种", "種"}, {"众", "眾"}, {"终", "終"}, {"钟", "鐘"}, {"肿", "腫"}, {"时", "時"},
+            {"说", "說"}, {"实", "實"}, {"数", "數"}, {"术", "術"}, {"属", "屬"}, {"树", "樹"},
+            {"输", "輸"}, {"书", "書"}, {"记", "記"}, {"据", "據"}, {"问", "問"}, {"为", "為"},
+            {"网", "網"}, {"无", "無"}, {"万", "萬"}, {"对", "對"}, {"当", "當"}, {"点", "點"},
+            {"带", "帶"}, {"话", "話"}, {"确", "確"}, {"育", "育"}, {"张", "張"}, {"着", "著"},
+            {"门", "門"}, {"间", "間"}, {"关", "關"}, {"龌", "齷"}, {"锝", "鍀"}, {"涡", "渦"},
+            {"内", "內"}, {"难", "難"}, {"农", "農"}, {"拟", "擬"}, {"腻", "膩"}, {"这么", "這麼"},
+            {"中国", "中國"}, {"输入", "輸入"}, {"数据", "數據"}, {"书记", "書記"}, {"的时候", "的時候"},
+    };
+    return t;
+}
+
+static size_t codePointLength(unsigned char c) {
+    return c < 0x80 ? 1 : c < 0xe0 ? 2 : c < 0xf0 ? 3 : 4;
+}
+
+// longest match of up to 4 code points, as OpenCC's maximum forward matching segmentation
+static std::string convert(const std::string &s) {
+    const auto &t = table();
+    std::string out;
+    size_t pos = 0;
+    while (pos < s.size()) {
+        std::vector<size_t> ends;
+        for (size_t end = pos; end < s.size() && ends.size() < 4;) {
+            end += codePointLength(static_cast<unsigned char>(s[end]));
+            ends.push_back(end);
+        }
+        bool matched = false;
+        for (auto it = ends.rbegin(); it != ends.rend(); ++it) {
+            auto found = t.find(s.substr(pos, *it - pos));
+            if (found != t.end()) {
+                out += found->second;
+                pos = *it;
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            out.append(s, pos, ends.front() - pos);
+            pos = ends.front();
+        }
+    }
+    return out;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 ? argv[1] : HOST_TEST_DATA_DIR "/pinyin-sessions.txt";
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 2000;
+    const auto sessions = readSessions(path);
+    if (sessions.empty()) {
+        std::fprintf(stderr, "no session in %s\n", path);
+        return 1;
+    }
+    size_t pushes = 0;
+    size_t checksum = 0;
+    const auto uncachedStart = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const auto &session: sessions) {
+            for (const auto &push: session) {
+                pushes++;
+                for (const auto &c: push) checksum += convert(c).size();
+            }
+        }
+    }
+    const std::chrono::duration<double, std::nano> uncached = std::chrono::steady_clock::now() - uncachedStart;
+    OutputFilterCacheStats stats;
+    size_t cachedChecksum = 0;
+    const auto cachedStart = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        // one input context per round, as if the app was restarted
+        OutputFilterCache cache(stats);
+        for (const auto &session: sessions) {
+            for (const auto &push: session) {
+                for (const auto &c: push) {
+                    cachedChecksum += cache.get(c, [&c] { return convert(c); }).size();
+                }
+            }
+        }
+    }
+    const std::chrono::duration<double, std::nano> cached = std::chrono::steady_clock::now() - cachedStart;
+    const auto lookups = stats.hits + stats.misses;
+    const double filterNanos = uncached.count() / static_cast<double>(lookups);
+    // time spent in the cache itself, besides calling the filter on misses
+    const double cacheNanos = (cached.count() - filterNanos * static_cast<double>(stats.misses)) / static_cast<double>(lookups);
+    std::printf("{\n"
+                "  \"sessions\": %zu,\n"
+                "  \"pushes\": %zu,\n"
+                "  \"lookups\": %llu,\n"
+                "  \"hitRate\": %.3f,\n"
+                "  \"evictions\": %llu,\n"
+                "  \"filterNanosPerCall\": %.1f,\n"
+                "  \"cacheNanosPerLookup\": %.1f,\n"
+                "  \"uncachedNanosPerPush\": %.1f,\n"
+                "  \"cachedNanosPerPush\": %.1f\n"
+                "}\n",
+                sessions.size(), pushes,
+                static_cast<unsigned long long>(lookups),
+                static_cast<double>(stats.hits) / static_cast<double>(lookups),
+                static_cast<unsigned long long>(stats.evictions),
+                filterNanos, cacheNanos,
+                uncached.count() / static_cast<double>(pushes),
+                cached.count() / static_cast<double>(pushes));
+    return checksum == cachedChecksum ? 0 : 1;
+}
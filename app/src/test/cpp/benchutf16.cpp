@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Throughput of UTF-8 to UTF-16 decoding on ASCII, CJK, emoji and mixed text.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "utf16-utils.h"
+
+static std::string repeat(const std::string &unit, size_t bytes) {
+    std::string s;
+    while (s.size() < bytes) s += unit;
+    return s;
+}
+
+template<typename F>
+static double megabytesPerSecond(const std::string &src, std::u16string &dst, F decode) {
+    using namespace std::chrono;
+    size_t total = 0;
+    const auto start = steady_clock::now();
+    auto elapsed = steady_clock::duration::zero();
+    // units written, so that the calls can't be optimized out
+    volatile size_t sink = 0;
+    while (elapsed < milliseconds(200)) {
+        for (int i = 0; i < 64; i++) {
+            sink = sink + decode(src.data(), src.size(), dst.data());
+            total += src.size();
+        }
+        elapsed = steady_clock::now() - start;
+    }
+    return static_cast<double>(total) / duration<double>(elapsed).count() / 1e6;
+}
+
+int main() {
+    // typical lengths: candidates and labels are short, commits and preedit a bit longer
+    const std::vector<std::pair<const char *, std::string>> corpora{
+            {"ascii", repeat("The quick brown fox jumps over the lazy dog. ", 4096)},
+            {"cjk", repeat("输入法框架支持多种语言的输入，候选词列表", 4096)},
+            {"emoji", repeat("😀😂🥰👍🎉", 4096)},
+            {"mixed", repeat("Hello 你好 😀 fcitx5 输入法 ok 👍 ", 4096)},
+            {"short-mixed", "你好 hi 😀"},
+    };
+    std::printf("{\n  \"unit\": \"MB/s of UTF-8 input\",\n  \"results\": [\n");
+    for (size_t i = 0; i < corpora.size(); i++) {
+        const auto &[name, src] = corpora[i];
+        std::u16string dst(src.size(), u'\0');
+        const auto vectorized = megabytesPerSecond(src, dst, utf16::fromUtf8);
+        const auto scalar = megabytesPerSecond(src, dst, utf16::fromUtf8Scalar);
+        std::printf("    {\"corpus\": \"%s\", \"bytes\": %zu, \"fromUtf8\": %.1f, \"fromUtf8Scalar\": %.1f}%s\n",
+                    name, src.size(), vectorized, scalar, i + 1 < corpora.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
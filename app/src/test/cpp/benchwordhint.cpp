@@ -0,0 +1,222 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Replays typing words key by key, with typos fixed by backspace, through word hint lookups as
+// AndroidKeyboardEngine::updateCandidate does, with and without WordHintCache.
+// The spell module is not available on host; hints come from a generated dictionary ranked by
+// frequency. The exact cache only serves repeated inputs, so its spell calls per word carry over
+// whatever the ranking. This dictionary is also prefix ranked, so a second cache derives longer
+// inputs from prefixes as well; that does not hold for fcitx5 spell dictionaries. Provisional
+// hints are those shown while the exact cache misses, and how often their first one is right.
+// Nanos depend on the dictionary size.
+// usage: benchwordhint [words] [dictionary size]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "androidkeyboard/wordhintcache.h"
+
+// same as AndroidKeyboardEngine
+static constexpr size_t SpellCandidateSize = 20;
+
+struct Rng {
+    uint64_t state;
+
+    uint32_t next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(state >> 33);
+    }
+
+    size_t below(size_t n) { return next() % n; }
+};
+
+class Dictionary {
+public:
+    Dictionary(size_t size, Rng &rng) {
+        static const char *onsets[] = {"b", "c", "d", "f", "g", "h", "l", "m", "n", "p", "r", "s",
+                                       "t", "w", "st", "tr", "ch", "sh", "th", "pr"};
+        static const char *nuclei[] = {"a", "e", "i", "o", "u", "ea", "ou", "ai"};
+        static const char *codas[] = {"", "", "n", "r", "t", "s", "ng", "ck", "ll"};
+        while (words_.size() < size) {
+            std::string word;
+            const auto syllables = 1 + rng.below(3);
+            for (size_t i = 0; i < syllables; i++) {
+                word += onsets[rng.below(std::size(onsets))];
+                word += nuclei[rng.below(std::size(nuclei))];
+                word += codas[rng.below(std::size(codas))];
+            }
+            words_.push_back({word, 0});
+        }
+        std::sort(words_.begin(), words_.end(), [](auto &a, auto &b) { return a.text < b.text; });
+        words_.erase(std::unique(words_.begin(), words_.end(),
+                                 [](auto &a, auto &b) { return a.text == b.text; }), words_.end());
+        // zipf-like frequencies, the rank is random
+        std::vector<size_t> ranks(words_.size());
+        for (size_t i = 0; i < ranks.size(); i++) ranks[i] = i;
+        for (size_t i = ranks.size(); i > 1; i--) std::swap(ranks[i - 1], ranks[rng.below(i)]);
+        for (size_t i = 0; i < words_.size(); i++) words_[i].frequency = 1000000 / (ranks[i] + 1);
+    }
+
+    // most frequent completions of `input`; like the custom dictionaries of fcitx5 spell module,
+    // every word with the same first letter is checked
+    WordHintCache::Hints hint(const std::string &input, size_t limit) {
+        calls++;
+        auto it = std::lower_bound(words_.begin(), words_.end(), input.substr(0, 1),
+                                   [](auto &w, auto &s) { return w.text < s; });
+        std::vector<const Word *> found;
+        for (; it != words_.end() && it->text[0] == input[0]; ++it) {
+            if (it->text.starts_with(input)) found.push_back(&*it);
+        }
+        const auto n = std::min(limit, found.size());
+        std::partial_sort(found.begin(), found.begin() + static_cast<ptrdiff_t>(n), found.end(),
+                          [](auto *a, auto *b) {
+                              return a->frequency != b->frequency ? a->frequency > b->frequency : a->text < b->text;
+                          });
+        WordHintCache::Hints hints;
+        for (size_t i = 0; i < n; i++) hints.emplace_back(found[i]->text, found[i]->text);
+        return hints;
+    }
+
+    // a word picked by frequency
+    const std::string &pick(Rng &rng) const {
+        uint64_t total = 0;
+        for (const auto &w: words_) total += w.frequency;
+        auto target = (static_cast<uint64_t>(rng.next()) << 20 | rng.next()) % total;
+        for (const auto &w: words_) {
+            if (target < w.frequency) return w.text;
+            target -= w.frequency;
+        }
+        return words_.back().text;
+    }
+
+    [[nodiscard]] size_t size() const { return words_.size(); }
+
+    uint64_t calls = 0;
+
+private:
+    struct Word {
+        std::string text;
+        uint64_t frequency;
+    };
+    std::vector<Word> words_;
+};
+
+// buffer contents after each key: every letter, and a wrong letter fixed by backspace in 1/8 keys
+static std::vector<std::vector<std::string>> typing(const Dictionary &dict, size_t words, Rng &rng) {
+    std::vector<std::vector<std::string>> result;
+    for (size_t i = 0; i < words; i++) {
+        const auto &word = dict.pick(rng);
+        std::vector<std::string> buffers;
+        std::string buffer;
+        for (const char c: word) {
+            if (rng.below(8) == 0) {
+                buffers.push_back(buffer + static_cast<char>('a' + rng.below(26)));
+                buffers.push_back(buffer);
+            }
+            buffer += c;
+            buffers.push_back(buffer);
+        }
+        result.push_back(std::move(buffers));
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    const size_t words = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const size_t dictSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50000;
+    Rng rng{20260101};
+    Dictionary dict(dictSize, rng);
+    const auto stream = typing(dict, words, rng);
+    size_t keys = 0;
+    for (const auto &w: stream) keys += w.size();
+
+    size_t checksum = 0;
+    const auto uncachedStart = std::chrono::steady_clock::now();
+    for (const auto &w: stream) {
+        for (const auto &input: w) {
+            const auto hints = dict.hint(input, SpellCandidateSize);
+            checksum += hints.size();
+        }
+    }
+    const std::chrono::duration<double, std::nano> uncached = std::chrono::steady_clock::now() - uncachedStart;
+    const auto uncachedCalls = dict.calls;
+
+    dict.calls = 0;
+    WordHintCacheStats stats;
+    WordHintCache cache(stats);
+    size_t cachedChecksum = 0;
+    size_t mismatches = 0;
+    const auto cachedStart = std::chrono::steady_clock::now();
+    for (const auto &w: stream) {
+        for (const auto &input: w) {
+            const auto &hints = cache.get("en", input, [&] { return dict.hint(input, SpellCandidateSize); });
+            cachedChecksum += hints.size();
+        }
+    }
+    const std::chrono::duration<double, std::nano> cached = std::chrono::steady_clock::now() - cachedStart;
+
+    // what a miss of the exact cache shows until its lookup is done
+    size_t provisionalShown = 0, provisionalFirstRight = 0;
+    {
+        WordHintCacheStats provisionalStats;
+        WordHintCache provisionalCache(provisionalStats);
+        for (const auto &w: stream) {
+            for (const auto &input: w) {
+                if (provisionalCache.find("en", input)) continue;
+                const auto guess = provisionalCache.provisional("en", input);
+                const auto &hints = provisionalCache.put("en", input, dict.hint(input, SpellCandidateSize));
+                if (guess.empty()) continue;
+                provisionalShown++;
+                provisionalFirstRight += !hints.empty() && guess.front() == hints.front();
+            }
+        }
+    }
+
+    WordHintCacheStats derivedStats;
+    WordHintCache derivedCache(derivedStats, 32, SpellCandidateSize);
+    size_t derivedChecksum = 0;
+    for (const auto &w: stream) {
+        for (const auto &input: w) {
+            const auto &hints = derivedCache.get("en", input, [&] { return dict.hint(input, SpellCandidateSize); });
+            derivedChecksum += hints.size();
+        }
+    }
+    // shown hints must be the same
+    for (size_t i = 0; i < stream.size() && i < 200; i++) {
+        for (const auto &input: stream[i]) {
+            const auto hints = cache.get("en", input, [&] { return dict.hint(input, SpellCandidateSize); });
+            if (hints != dict.hint(input, SpellCandidateSize)) mismatches++;
+            const auto derived = derivedCache.get("en", input, [&] { return dict.hint(input, SpellCandidateSize); });
+            if (derived != dict.hint(input, SpellCandidateSize)) mismatches++;
+        }
+    }
+
+    const auto n = static_cast<double>(words);
+    std::printf("{\n"
+                "  \"dictionary\": %zu,\n"
+                "  \"words\": %zu,\n"
+                "  \"keysPerWord\": %.2f,\n"
+                "  \"spellCallsPerWord\": {\"uncached\": %.2f, \"cached\": %.2f, \"prefixRanked\": %.2f},\n"
+                "  \"hits\": %llu,\n"
+                "  \"misses\": %llu,\n"
+                "  \"provisional\": {\"shownPerMiss\": %.3f, \"firstRight\": %.3f},\n"
+                "  \"nanosPerKey\": {\"uncached\": %.0f, \"cached\": %.0f},\n"
+                "  \"mismatches\": %zu\n"
+                "}\n",
+                dict.size(), words, static_cast<double>(keys) / n,
+                static_cast<double>(uncachedCalls) / n, static_cast<double>(stats.misses) / n,
+                static_cast<double>(derivedStats.misses) / n,
+                static_cast<unsigned long long>(stats.hits),
+                static_cast<unsigned long long>(stats.misses),
+                static_cast<double>(provisionalShown) / static_cast<double>(stats.misses),
+                provisionalShown ? static_cast<double>(provisionalFirstRight) / static_cast<double>(provisionalShown) : 0.0,
+                uncached.count() / static_cast<double>(keys), cached.count() / static_cast<double>(keys),
+                mismatches);
+    return checksum == cachedChecksum && checksum == derivedChecksum && mismatches == 0 ? 0 : 1;
+}
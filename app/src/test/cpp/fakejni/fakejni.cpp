@@ -0,0 +1,567 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include "fakejni.h"
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fakejni {
+
+namespace {
+
+struct State {
+    std::mutex mutex;
+    // classes, methods and fields survive reset(), GlobalRefSingleton caches them
+    std::unordered_map<std::string, std::unique_ptr<Object>> classes;
+    std::deque<Method> methods;
+    std::deque<Field> fields;
+    std::deque<std::unique_ptr<Object>> objects;
+    std::vector<int64_t> frames;
+    std::vector<Call> calls;
+    bool recordCalls = true;
+    std::string lastException;
+    Stats stats;
+};
+
+State &state() {
+    static State s;
+    return s;
+}
+
+_JNIEnv theEnv;
+_JavaVM theVM;
+
+std::string toUtf8(const std::u16string &s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        uint32_t c = s[i];
+        if (c >= 0xd800 && c < 0xdc00 && i + 1 < s.size() && s[i + 1] >= 0xdc00 && s[i + 1] < 0xe000) {
+            c = 0x10000 + ((c - 0xd800) << 10) + (s[++i] - 0xdc00);
+        }
+        if (c < 0x80) {
+            out.push_back(static_cast<char>(c));
+        } else if (c < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | (c >> 6)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        } else if (c < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | (c >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | (c >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        }
+    }
+    return out;
+}
+
+std::u16string toUtf16(const std::string &s) {
+    std::u16string out;
+    for (size_t i = 0; i < s.size();) {
+        const auto b = static_cast<uint8_t>(s[i]);
+        uint32_t c;
+        size_t n;
+        if (b < 0x80) {
+            c = b, n = 1;
+        } else if ((b & 0xe0) == 0xc0) {
+            c = b & 0x1f, n = 2;
+        } else if ((b & 0xf0) == 0xe0) {
+            c = b & 0x0f, n = 3;
+        } else {
+            c = b & 0x07, n = 4;
+        }
+        for (size_t k = 1; k < n && i + k < s.size(); k++) {
+            c = (c << 6) | (static_cast<uint8_t>(s[i + k]) & 0x3f);
+        }
+        i += n;
+        if (c >= 0x10000) {
+            c -= 0x10000;
+            out.push_back(static_cast<char16_t>(0xd800 + (c >> 10)));
+            out.push_back(static_cast<char16_t>(0xdc00 + (c & 0x3ff)));
+        } else {
+            out.push_back(static_cast<char16_t>(c));
+        }
+    }
+    return out;
+}
+
+// caller holds the mutex
+Object *make(Kind kind) {
+    auto &s = state();
+    s.objects.push_back(std::make_unique<Object>());
+    auto *o = s.objects.back().get();
+    o->kind = kind;
+    s.stats.objects++;
+    s.stats.localRefs++;
+    return o;
+}
+
+Object *makeString(std::u16string chars) {
+    auto *o = make(Kind::String);
+    o->chars = std::move(chars);
+    o->utf = toUtf8(o->chars);
+    state().stats.strings++;
+    return o;
+}
+
+Object *classOf(const std::string &name) {
+    auto &slot = state().classes[name];
+    if (!slot) {
+        slot = std::make_unique<Object>();
+        slot->kind = Kind::Class;
+        slot->className = name;
+    }
+    return slot.get();
+}
+
+template<typename T = jobject>
+T handle(Object *o) { return reinterpret_cast<T>(o); }
+
+Object *unwrap(const void *obj) {
+    return const_cast<Object *>(reinterpret_cast<const Object *>(obj));
+}
+
+/**
+ * Read arguments of `signature` from varargs; sub-int types are promoted to int and float to
+ * double by the caller
+ */
+std::vector<Value> decode(const std::string &signature, va_list args) {
+    std::vector<Value> values;
+    size_t i = signature.find('(') + 1;
+    while (i < signature.size() && signature[i] != ')') {
+        Value v;
+        const char t = signature[i];
+        switch (t) {
+            case 'Z':
+            case 'B':
+            case 'C':
+            case 'S':
+            case 'I':
+                v.type = t;
+                v.i = va_arg(args, int);
+                i++;
+                break;
+            case 'J':
+                v.type = t;
+                v.i = va_arg(args, jlong);
+                i++;
+                break;
+            case 'F':
+            case 'D':
+                v.type = t;
+                v.d = va_arg(args, double);
+                i++;
+                break;
+            default:
+                v.type = 'L';
+                v.l = unwrap(va_arg(args, jobject));
+                while (signature[i] == '[') i++;
+                if (signature[i] == 'L') {
+                    i = signature.find(';', i);
+                }
+                i++;
+                break;
+        }
+        values.push_back(v);
+    }
+    return values;
+}
+
+thread_local int depth = 0;
+
+struct Inside {
+    Inside() { depth++; }
+
+    ~Inside() { depth--; }
+};
+
+size_t primitiveSize(char type) {
+    switch (type) {
+        case 'Z':
+        case 'B':
+            return 1;
+        case 'C':
+        case 'S':
+            return 2;
+        case 'I':
+        case 'F':
+            return 4;
+        default:
+            return 8;
+    }
+}
+
+// bytes Java would receive for `o`, following arrays and constructor arguments
+uint64_t payloadSize(const Object *o) {
+    if (!o) return 0;
+    switch (o->kind) {
+        case Kind::String:
+            return o->chars.size() * sizeof(char16_t);
+        case Kind::PrimitiveArray:
+            return o->primitives.size() * primitiveSize(o->elementType);
+        case Kind::DirectByteBuffer:
+            return o->capacity;
+        case Kind::ObjectArray: {
+            uint64_t size = 0;
+            for (const auto *e: o->elements) size += payloadSize(e);
+            return size;
+        }
+        case Kind::Instance: {
+            uint64_t size = 0;
+            for (const auto &v: o->args) {
+                size += v.type == 'L' ? payloadSize(v.l) : primitiveSize(v.type);
+            }
+            return size;
+        }
+        default:
+            return 0;
+    }
+}
+
+void recordCall(State &s, const Method *method, Object *receiver, va_list args) {
+    s.stats.callbacks++;
+    auto values = decode(method->signature, args);
+    for (const auto &v: values) {
+        s.stats.marshalledBytes += v.type == 'L' ? payloadSize(v.l) : primitiveSize(v.type);
+    }
+    if (s.recordCalls) {
+        s.calls.push_back({method, receiver, std::move(values)});
+    }
+}
+
+#define FAKEJNI_ENTER \
+    Inside inside; \
+    auto &s = state(); \
+    std::lock_guard lock(s.mutex); \
+    s.stats.jniCalls++;
+
+}
+
+JavaVM *vm() { return &theVM; }
+
+JNIEnv *env() { return &theEnv; }
+
+void reset() {
+    auto &s = state();
+    std::lock_guard lock(s.mutex);
+    s.objects.clear();
+    s.frames.clear();
+    s.calls.clear();
+    s.lastException.clear();
+    s.stats = {};
+}
+
+const Stats &stats() { return state().stats; }
+
+bool inside() { return depth > 0; }
+
+void setRecordCalls(bool record) {
+    auto &s = state();
+    std::lock_guard lock(s.mutex);
+    s.recordCalls = record;
+}
+
+const std::vector<Call> &calls() { return state().calls; }
+
+void clearCalls() {
+    auto &s = state();
+    std::lock_guard lock(s.mutex);
+    s.calls.clear();
+}
+
+const std::string &lastException() { return state().lastException; }
+
+Object *object(jobject obj) { return unwrap(obj); }
+
+std::string string(jobject obj) {
+    auto *o = unwrap(obj);
+    if (!o || o->kind != Kind::String) {
+        throw std::invalid_argument("not a string");
+    }
+    return o->utf;
+}
+
+jstring newString(const std::string &utf8) {
+    std::lock_guard lock(state().mutex);
+    return handle<jstring>(makeString(toUtf16(utf8)));
+}
+
+jobject newInstance(const std::string &className, std::map<std::string, Value> fields) {
+    std::lock_guard lock(state().mutex);
+    auto *o = make(Kind::Instance);
+    o->clazz = classOf(className);
+    o->fields = std::move(fields);
+    return handle(o);
+}
+
+jobjectArray newObjectArray(const std::string &elementClass, const std::vector<jobject> &elements) {
+    std::lock_guard lock(state().mutex);
+    auto *o = make(Kind::ObjectArray);
+    o->clazz = classOf(elementClass);
+    for (auto *e: elements) {
+        o->elements.push_back(unwrap(e));
+    }
+    return handle<jobjectArray>(o);
+}
+
+jarray newPrimitiveArray(char type, const std::vector<int64_t> &elements) {
+    std::lock_guard lock(state().mutex);
+    auto *o = make(Kind::PrimitiveArray);
+    o->elementType = type;
+    o->primitives = elements;
+    return handle<jarray>(o);
+}
+
+Value ref(jobject obj) {
+    Value v;
+    v.type = 'L';
+    v.l = unwrap(obj);
+    return v;
+}
+
+Value integer(int64_t i) {
+    Value v;
+    v.type = 'I';
+    v.i = i;
+    return v;
+}
+
+}
+
+using namespace fakejni;
+
+jclass _JNIEnv::FindClass(const char *name) {
+    FAKEJNI_ENTER
+    s.stats.localRefs++;
+    return handle<jclass>(classOf(name));
+}
+
+jint _JNIEnv::ThrowNew(jclass, const char *message) {
+    FAKEJNI_ENTER
+    s.lastException = message ? message : "";
+    s.stats.exceptions++;
+    return JNI_OK;
+}
+
+jint _JNIEnv::PushLocalFrame(jint) {
+    FAKEJNI_ENTER
+    s.frames.push_back(s.stats.localRefs);
+    return JNI_OK;
+}
+
+jobject _JNIEnv::PopLocalFrame(jobject result) {
+    FAKEJNI_ENTER
+    if (!s.frames.empty()) {
+        s.stats.localRefs = s.frames.back();
+        s.frames.pop_back();
+    }
+    if (result) s.stats.localRefs++;
+    return result;
+}
+
+jobject _JNIEnv::NewGlobalRef(jobject obj) {
+    FAKEJNI_ENTER
+    if (obj) s.stats.globalRefs++;
+    return obj;
+}
+
+void _JNIEnv::DeleteGlobalRef(jobject obj) {
+    FAKEJNI_ENTER
+    if (obj) s.stats.globalRefs--;
+}
+
+void _JNIEnv::DeleteLocalRef(jobject obj) {
+    FAKEJNI_ENTER
+    if (obj) s.stats.localRefs--;
+}
+
+jobject _JNIEnv::NewLocalRef(jobject obj) {
+    FAKEJNI_ENTER
+    if (obj) s.stats.localRefs++;
+    return obj;
+}
+
+jobject _JNIEnv::NewObject(jclass clazz, jmethodID methodID, ...) {
+    FAKEJNI_ENTER
+    auto *method = reinterpret_cast<const Method *>(methodID);
+    auto *o = make(Kind::Instance);
+    o->clazz = unwrap(clazz);
+    o->constructor = method;
+    va_list args;
+    va_start(args, methodID);
+    o->args = decode(method->signature, args);
+    va_end(args);
+    return handle(o);
+}
+
+jmethodID _JNIEnv::GetMethodID(jclass clazz, const char *name, const char *sig) {
+    FAKEJNI_ENTER
+    s.methods.push_back({unwrap(clazz), name, sig, false});
+    return reinterpret_cast<jmethodID>(&s.methods.back());
+}
+
+jmethodID _JNIEnv::GetStaticMethodID(jclass clazz, const char *name, const char *sig) {
+    FAKEJNI_ENTER
+    s.methods.push_back({unwrap(clazz), name, sig, true});
+    return reinterpret_cast<jmethodID>(&s.methods.back());
+}
+
+jfieldID _JNIEnv::GetFieldID(jclass clazz, const char *name, const char *sig) {
+    FAKEJNI_ENTER
+    s.fields.push_back({unwrap(clazz), name, sig});
+    return reinterpret_cast<jfieldID>(&s.fields.back());
+}
+
+void _JNIEnv::CallVoidMethod(jobject obj, jmethodID methodID, ...) {
+    FAKEJNI_ENTER
+    va_list args;
+    va_start(args, methodID);
+    recordCall(s, reinterpret_cast<const Method *>(methodID), unwrap(obj), args);
+    va_end(args);
+}
+
+void _JNIEnv::CallStaticVoidMethod(jclass, jmethodID methodID, ...) {
+    FAKEJNI_ENTER
+    va_list args;
+    va_start(args, methodID);
+    recordCall(s, reinterpret_cast<const Method *>(methodID), nullptr, args);
+    va_end(args);
+}
+
+jobject _JNIEnv::GetObjectField(jobject obj, jfieldID fieldID) {
+    FAKEJNI_ENTER
+    auto *field = reinterpret_cast<const Field *>(fieldID);
+    const auto &fields = unwrap(obj)->fields;
+    auto it = fields.find(field->name);
+    if (it == fields.end() || !it->second.l) return nullptr;
+    s.stats.localRefs++;
+    return handle(it->second.l);
+}
+
+jint _JNIEnv::GetIntField(jobject obj, jfieldID fieldID) {
+    FAKEJNI_ENTER
+    auto *field = reinterpret_cast<const Field *>(fieldID);
+    const auto &fields = unwrap(obj)->fields;
+    auto it = fields.find(field->name);
+    return it == fields.end() ? 0 : static_cast<jint>(it->second.i);
+}
+
+jstring _JNIEnv::NewString(const jchar *unicodeChars, jsize len) {
+    FAKEJNI_ENTER
+    return handle<jstring>(makeString({reinterpret_cast<const char16_t *>(unicodeChars), static_cast<size_t>(len)}));
+}
+
+jstring _JNIEnv::NewStringUTF(const char *bytes) {
+    FAKEJNI_ENTER
+    return handle<jstring>(makeString(toUtf16(bytes)));
+}
+
+const char *_JNIEnv::GetStringUTFChars(jstring string, jboolean *isCopy) {
+    FAKEJNI_ENTER
+    if (isCopy) *isCopy = JNI_FALSE;
+    return unwrap(string)->utf.c_str();
+}
+
+void _JNIEnv::ReleaseStringUTFChars(jstring, const char *) {
+    FAKEJNI_ENTER
+}
+
+jsize _JNIEnv::GetArrayLength(jarray array) {
+    FAKEJNI_ENTER
+    auto *o = unwrap(array);
+    return static_cast<jsize>(o->kind == Kind::ObjectArray ? o->elements.size() : o->primitives.size());
+}
+
+jobjectArray _JNIEnv::NewObjectArray(jsize length, jclass elementClass, jobject initialElement) {
+    FAKEJNI_ENTER
+    auto *o = make(Kind::ObjectArray);
+    o->clazz = unwrap(elementClass);
+    o->elements.assign(static_cast<size_t>(length), unwrap(initialElement));
+    return handle<jobjectArray>(o);
+}
+
+jobject _JNIEnv::GetObjectArrayElement(jobjectArray array, jsize index) {
+    FAKEJNI_ENTER
+    auto *e = unwrap(array)->elements.at(static_cast<size_t>(index));
+    if (e) s.stats.localRefs++;
+    return handle(e);
+}
+
+void _JNIEnv::SetObjectArrayElement(jobjectArray array, jsize index, jobject value) {
+    FAKEJNI_ENTER
+    unwrap(array)->elements.at(static_cast<size_t>(index)) = unwrap(value);
+}
+
+jintArray _JNIEnv::NewIntArray(jsize length) {
+    FAKEJNI_ENTER
+    auto *o = make(Kind::PrimitiveArray);
+    o->elementType = 'I';
+    o->primitives.assign(static_cast<size_t>(length), 0);
+    return handle<jintArray>(o);
+}
+
+jlongArray _JNIEnv::NewLongArray(jsize length) {
+    FAKEJNI_ENTER
+    auto *o = make(Kind::PrimitiveArray);
+    o->elementType = 'J';
+    o->primitives.assign(static_cast<size_t>(length), 0);
+    return handle<jlongArray>(o);
+}
+
+void _JNIEnv::SetIntArrayRegion(jintArray array, jsize start, jsize len, const jint *buf) {
+    FAKEJNI_ENTER
+    auto &p = unwrap(array)->primitives;
+    for (jsize i = 0; i < len; i++) p.at(static_cast<size_t>(start + i)) = buf[i];
+}
+
+void _JNIEnv::SetLongArrayRegion(jlongArray array, jsize start, jsize len, const jlong *buf) {
+    FAKEJNI_ENTER
+    auto &p = unwrap(array)->primitives;
+    for (jsize i = 0; i < len; i++) p.at(static_cast<size_t>(start + i)) = buf[i];
+}
+
+jboolean *_JNIEnv::GetBooleanArrayElements(jbooleanArray array, jboolean *isCopy) {
+    FAKEJNI_ENTER
+    if (isCopy) *isCopy = JNI_TRUE;
+    auto *o = unwrap(array);
+    o->booleans.assign(o->primitives.begin(), o->primitives.end());
+    return o->booleans.data();
+}
+
+void _JNIEnv::ReleaseBooleanArrayElements(jbooleanArray array, jboolean *elems, jint mode) {
+    FAKEJNI_ENTER
+    auto *o = unwrap(array);
+    if (mode != JNI_ABORT) {
+        o->primitives.assign(elems, elems + o->booleans.size());
+    }
+}
+
+jobject _JNIEnv::NewDirectByteBuffer(void *address, jlong capacity) {
+    FAKEJNI_ENTER
+    auto *o = make(Kind::DirectByteBuffer);
+    o->address = address;
+    o->capacity = capacity;
+    return handle(o);
+}
+
+jint _JavaVM::GetEnv(void **env, jint) {
+    *env = &theEnv;
+    return JNI_OK;
+}
+
+jint _JavaVM::AttachCurrentThread(_JNIEnv **p_env, void *) {
+    *p_env = &theEnv;
+    return JNI_OK;
+}
+
+jint _JavaVM::DetachCurrentThread() {
+    return JNI_OK;
+}
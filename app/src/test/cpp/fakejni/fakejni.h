@@ -0,0 +1,142 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_FAKEJNI_H
+#define FCITX5_ANDROID_FAKEJNI_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "jni.h"
+
+/**
+ * Recording fake of the JVM side of JNI, for running native-lib on desktop.
+ *
+ * Every jobject handed out points to a fakejni::Object, which lives until reset(). Classes,
+ * methods and fields are created on first lookup, so GlobalRefSingleton works unchanged.
+ * Calls into "Java" (CallStaticVoidMethod, CallVoidMethod) are decoded with the signature
+ * given to GetMethodID and kept in calls(), which is how callbacks like
+ * handleUITransactionEvent are observed.
+ */
+namespace fakejni {
+
+struct Object;
+
+struct Value {
+    // JNI signature letter: Z B C S I J F D, or L for any reference
+    char type = 'V';
+    int64_t i = 0;
+    double d = 0;
+    Object *l = nullptr;
+};
+
+struct Method {
+    Object *clazz;
+    std::string name;
+    std::string signature;
+    bool isStatic;
+};
+
+struct Field {
+    Object *clazz;
+    std::string name;
+    std::string signature;
+};
+
+enum class Kind { Class, String, Instance, ObjectArray, PrimitiveArray, DirectByteBuffer };
+
+struct Object {
+    Kind kind;
+    // class of an instance or array element, or name of a class
+    Object *clazz = nullptr;
+    std::string className;
+    // String
+    std::u16string chars;
+    std::string utf;
+    // Instance: constructor arguments, and fields set by tests
+    const Method *constructor = nullptr;
+    std::vector<Value> args;
+    std::map<std::string, Value> fields;
+    // ObjectArray
+    std::vector<Object *> elements;
+    // PrimitiveArray, elements widened to 64 bits; 'Z' arrays also keep bytes for pinning
+    char elementType = 0;
+    std::vector<int64_t> primitives;
+    std::vector<jboolean> booleans;
+    // DirectByteBuffer
+    void *address = nullptr;
+    int64_t capacity = 0;
+};
+
+struct Call {
+    const Method *method;
+    // null for static methods
+    Object *receiver;
+    std::vector<Value> args;
+};
+
+struct Stats {
+    // JNIEnv functions called
+    uint64_t jniCalls = 0;
+    // objects created, including strings and arrays
+    uint64_t objects = 0;
+    uint64_t strings = 0;
+    // calls into Java
+    uint64_t callbacks = 0;
+    int64_t localRefs = 0;
+    int64_t globalRefs = 0;
+    // exceptions thrown with ThrowNew
+    uint64_t exceptions = 0;
+    // payload of arguments passed into Java: UTF-16 strings, array elements, direct buffers
+    uint64_t marshalledBytes = 0;
+};
+
+JavaVM *vm();
+
+JNIEnv *env();
+
+// drop all objects, calls and counters; classes and methods are kept
+void reset();
+
+const Stats &stats();
+
+// true while a JNIEnv function runs on this thread, so allocation counters can leave out
+// the fake JVM, whose objects would live on the Java heap
+bool inside();
+
+// keep decoded calls into Java in calls(); on by default, benchmarks turn it off
+void setRecordCalls(bool record);
+
+const std::vector<Call> &calls();
+
+void clearCalls();
+
+// message of the last ThrowNew, empty if none
+const std::string &lastException();
+
+Object *object(jobject obj);
+
+// UTF-8 content of a string made by native code
+std::string string(jobject obj);
+
+jstring newString(const std::string &utf8);
+
+// instance of `className` with `fields`, as if made by Java code
+jobject newInstance(const std::string &className, std::map<std::string, Value> fields);
+
+jobjectArray newObjectArray(const std::string &elementClass, const std::vector<jobject> &elements);
+
+// `type` is the signature letter of elements, eg. 'Z' for jbooleanArray
+jarray newPrimitiveArray(char type, const std::vector<int64_t> &elements);
+
+Value ref(jobject obj);
+
+Value integer(int64_t i);
+
+}
+
+#endif //FCITX5_ANDROID_FAKEJNI_H
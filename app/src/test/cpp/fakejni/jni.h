@@ -0,0 +1,131 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_FAKEJNI_JNI_H
+#define FCITX5_ANDROID_FAKEJNI_JNI_H
+
+/**
+ * Stand-in for <jni.h> on host builds: the subset of types and JNIEnv/JavaVM members used by
+ * native-lib, implemented by fakejni.cpp which records what native code does instead of
+ * talking to a JVM. See fakejni.h for inspecting it.
+ */
+
+#include <cstdarg>
+#include <cstdint>
+
+using jboolean = uint8_t;
+using jbyte = int8_t;
+using jchar = uint16_t;
+using jshort = int16_t;
+using jint = int32_t;
+using jlong = int64_t;
+using jfloat = float;
+using jdouble = double;
+using jsize = jint;
+
+class _jobject {};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jthrowable : public _jobject {};
+class _jarray : public _jobject {};
+class _jobjectArray : public _jarray {};
+class _jbooleanArray : public _jarray {};
+class _jbyteArray : public _jarray {};
+class _jcharArray : public _jarray {};
+class _jshortArray : public _jarray {};
+class _jintArray : public _jarray {};
+class _jlongArray : public _jarray {};
+class _jfloatArray : public _jarray {};
+class _jdoubleArray : public _jarray {};
+
+using jobject = _jobject *;
+using jclass = _jclass *;
+using jstring = _jstring *;
+using jthrowable = _jthrowable *;
+using jarray = _jarray *;
+using jobjectArray = _jobjectArray *;
+using jbooleanArray = _jbooleanArray *;
+using jbyteArray = _jbyteArray *;
+using jcharArray = _jcharArray *;
+using jshortArray = _jshortArray *;
+using jintArray = _jintArray *;
+using jlongArray = _jlongArray *;
+using jfloatArray = _jfloatArray *;
+using jdoubleArray = _jdoubleArray *;
+
+struct _jfieldID;
+struct _jmethodID;
+using jfieldID = _jfieldID *;
+using jmethodID = _jmethodID *;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+#define JNI_VERSION_1_6 0x00010006
+
+#define JNI_OK 0
+#define JNI_ERR (-1)
+#define JNI_EDETACHED (-2)
+
+#define JNI_COMMIT 1
+#define JNI_ABORT 2
+
+#define JNIEXPORT __attribute__ ((visibility ("default")))
+#define JNICALL
+
+struct _JNIEnv {
+    jclass FindClass(const char *name);
+
+    jint ThrowNew(jclass clazz, const char *message);
+
+    jint PushLocalFrame(jint capacity);
+    jobject PopLocalFrame(jobject result);
+
+    jobject NewGlobalRef(jobject obj);
+    void DeleteGlobalRef(jobject obj);
+    void DeleteLocalRef(jobject obj);
+    jobject NewLocalRef(jobject obj);
+
+    jobject NewObject(jclass clazz, jmethodID methodID, ...);
+
+    jmethodID GetMethodID(jclass clazz, const char *name, const char *sig);
+    jmethodID GetStaticMethodID(jclass clazz, const char *name, const char *sig);
+    jfieldID GetFieldID(jclass clazz, const char *name, const char *sig);
+
+    void CallVoidMethod(jobject obj, jmethodID methodID, ...);
+    void CallStaticVoidMethod(jclass clazz, jmethodID methodID, ...);
+
+    jobject GetObjectField(jobject obj, jfieldID fieldID);
+    jint GetIntField(jobject obj, jfieldID fieldID);
+
+    jstring NewString(const jchar *unicodeChars, jsize len);
+    jstring NewStringUTF(const char *bytes);
+    const char *GetStringUTFChars(jstring string, jboolean *isCopy);
+    void ReleaseStringUTFChars(jstring string, const char *utf);
+
+    jsize GetArrayLength(jarray array);
+    jobjectArray NewObjectArray(jsize length, jclass elementClass, jobject initialElement);
+    jobject GetObjectArrayElement(jobjectArray array, jsize index);
+    void SetObjectArrayElement(jobjectArray array, jsize index, jobject value);
+
+    jintArray NewIntArray(jsize length);
+    jlongArray NewLongArray(jsize length);
+    void SetIntArrayRegion(jintArray array, jsize start, jsize len, const jint *buf);
+    void SetLongArrayRegion(jlongArray array, jsize start, jsize len, const jlong *buf);
+    jboolean *GetBooleanArrayElements(jbooleanArray array, jboolean *isCopy);
+    void ReleaseBooleanArrayElements(jbooleanArray array, jboolean *elems, jint mode);
+
+    jobject NewDirectByteBuffer(void *address, jlong capacity);
+};
+
+struct _JavaVM {
+    jint GetEnv(void **env, jint version);
+    jint AttachCurrentThread(_JNIEnv **p_env, void *thr_args);
+    jint DetachCurrentThread();
+};
+
+using JNIEnv = _JNIEnv;
+using JavaVM = _JavaVM;
+
+#endif //FCITX5_ANDROID_FAKEJNI_JNI_H
@@ -0,0 +1,178 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Replays recorded key streams through native-lib for each input method, from JNI entry to
+// the UI callbacks. Input methods whose addons are not loaded are reported as skipped; pass
+// extra addon directories (colon separated) and a data prefix containing usr/share to cover
+// chinese-addons and plugin engines built for the host.
+// usage: benchkeystrokes [rounds] [sessions] [addon dirs] [data prefix]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "countingalloc.h"
+#include "hostfcitx.h"
+
+struct Session {
+    std::string inputMethod;
+    std::vector<std::string> tokens;
+};
+
+static std::vector<Session> readSessions(const std::string &path) {
+    std::vector<Session> sessions;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream words(line);
+        Session s;
+        words >> s.inputMethod;
+        std::string token;
+        while (words >> token) s.tokens.push_back(token);
+        sessions.push_back(std::move(s));
+    }
+    return sessions;
+}
+
+static const std::map<std::string, int> NamedKeys = {
+        {"<space>", 0x0020},
+        {"<bs>",    0xff08},
+        {"<enter>", 0xff0d},
+};
+
+struct Result {
+    std::string inputMethod;
+    bool skipped = true;
+    std::vector<double> micros;
+    double seconds = 0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t marshalledBytes = 0;
+    uint64_t callbacks = 0;
+    int64_t statusAreaFlushes = 0;
+    int64_t statusAreaSuppressed = 0;
+};
+
+// one key press and release, or one candidate selection, until UI callbacks are sent, those of
+// word hints ranked off the fcitx thread included
+template<typename F>
+static void measure(Result &r, F &&f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    r.micros.push_back(elapsed.count());
+}
+
+static void replay(Result &r, const Session &session, int &timestamp) {
+    for (const auto &token: session.tokens) {
+        if (token.size() > 1 && token[0] == '#') {
+            const int idx = std::atoi(token.c_str() + 1);
+            measure(r, [idx] { HostFcitx::select(idx); });
+        } else if (auto it = NamedKeys.find(token); it != NamedKeys.end()) {
+            const int sym = it->second;
+            measure(r, [sym, &timestamp] { HostFcitx::tap(sym, timestamp++); });
+        } else {
+            // printable ASCII keysyms are the characters themselves
+            for (const char c: token) {
+                measure(r, [c, &timestamp] { HostFcitx::tap(c, timestamp++); });
+            }
+        }
+    }
+    HostFcitx::resetInputContext();
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+int main(int argc, char *argv[]) {
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 20;
+    const std::string sessionsPath = argc > 2 ? argv[2] : HOST_TEST_DATA_DIR "/keystroke-sessions.txt";
+    std::string libDirs = HOST_LIB_DIR;
+    if (argc > 3 && *argv[3]) libDirs = libDirs + ":" + argv[3];
+    const std::string dataPrefix = argc > 4 ? argv[4] : HOST_STAGE_DIR;
+
+    const auto sessions = readSessions(sessionsPath);
+    HostFcitx fcitx(dataPrefix, libDirs, "benchkeystrokes");
+    // keep every callback out of calls(), only counters are needed
+    fakejni::setRecordCalls(false);
+
+    std::vector<Result> results;
+    auto resultOf = [&](const std::string &im) -> Result & {
+        for (auto &r: results) {
+            if (r.inputMethod == im) return r;
+        }
+        results.push_back({im});
+        return results.back();
+    };
+    for (const auto &session: sessions) {
+        auto &r = resultOf(session.inputMethod);
+        if (!HostFcitx::setInputMethod(session.inputMethod)) continue;
+        r.skipped = false;
+        int timestamp = 0;
+        // warm up dictionaries and caches before counting
+        const auto measured = r.micros.size();
+        replay(r, session, timestamp);
+        const auto perRound = r.micros.size() - measured;
+        r.micros.resize(measured);
+        // latencies are stored without allocating while counting
+        r.micros.reserve(measured + perRound * rounds);
+        const auto jni = fakejni::stats();
+        const auto statusArea = HostFcitx::statusAreaStats();
+        const uint64_t allocs = allocations, bytes = allocatedBytes;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            replay(r, session, timestamp);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        r.seconds += elapsed.count();
+        r.allocations += allocations - allocs;
+        r.allocatedBytes += allocatedBytes - bytes;
+        r.marshalledBytes += fakejni::stats().marshalledBytes - jni.marshalledBytes;
+        r.callbacks += fakejni::stats().callbacks - jni.callbacks;
+        const auto statusAreaAfter = HostFcitx::statusAreaStats();
+        if (statusArea.size() >= 2 && statusAreaAfter.size() >= 2) {
+            r.statusAreaFlushes += statusAreaAfter[0] - statusArea[0];
+            r.statusAreaSuppressed += statusAreaAfter[1] - statusArea[1];
+        }
+    }
+
+    std::printf("{\n"
+                "  \"rounds\": %d,\n"
+                "  \"inputMethods\": [", rounds);
+    for (size_t i = 0; i < results.size(); i++) {
+        auto &r = results[i];
+        std::printf("%s\n    {\"name\": \"%s\", ", i ? "," : "", r.inputMethod.c_str());
+        if (r.skipped) {
+            std::printf("\"skipped\": true}");
+            continue;
+        }
+        std::sort(r.micros.begin(), r.micros.end());
+        const auto keys = static_cast<double>(r.micros.size());
+        std::printf("\"skipped\": false, \"keys\": %zu, \"keysPerSecond\": %.0f, "
+                    "\"latencyMicros\": {\"p50\": %.1f, \"p95\": %.1f, \"p99\": %.1f, \"max\": %.1f}, "
+                    "\"allocationsPerKey\": %.1f, \"allocatedBytesPerKey\": %.0f, "
+                    "\"marshalledBytesPerKey\": %.0f, \"callbacksPerKey\": %.2f, "
+                    "\"statusAreaFlushes\": %lld, \"statusAreaSuppressed\": %lld}",
+                    r.micros.size(), keys / r.seconds,
+                    percentile(r.micros, 0.5), percentile(r.micros, 0.95), percentile(r.micros, 0.99),
+                    r.micros.empty() ? 0 : r.micros.back(),
+                    static_cast<double>(r.allocations) / keys,
+                    static_cast<double>(r.allocatedBytes) / keys,
+                    static_cast<double>(r.marshalledBytes) / keys,
+                    static_cast<double>(r.callbacks) / keys,
+                    static_cast<long long>(r.statusAreaFlushes),
+                    static_cast<long long>(r.statusAreaSuppressed));
+    }
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
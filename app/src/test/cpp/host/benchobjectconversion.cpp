@@ -0,0 +1,242 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Converters of object-conversion.h against the counting fake JNIEnv, with inputs shaped like
+// what they see on device: a 16-candidate page, the global config tree, a nested status area.
+// usage: benchobjectconversion [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcitx/action.h>
+#include <fcitx/globalconfig.h>
+#include <fcitx/menu.h>
+
+#include "fakejni.h"
+#include "countingalloc.h"
+#include "object-conversion.h"
+
+GlobalRefSingleton *GlobalRef;
+
+// first push of each session in data/pinyin-sessions.txt
+static std::vector<CandidateEntity> readCandidates() {
+    std::ifstream in(HOST_TEST_DATA_DIR "/pinyin-sessions.txt");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::vector<CandidateEntity> candidates;
+        std::istringstream words(line);
+        std::string word;
+        while (words >> word) {
+            const auto label = std::to_string((candidates.size() + 1) % 10);
+            candidates.emplace_back(label, word, "");
+        }
+        return candidates;
+    }
+    return {};
+}
+
+static fcitx::Text preedit() {
+    fcitx::Text text;
+    text.append("你好", fcitx::TextFormatFlag::Underline);
+    text.append("zhong'guo", fcitx::TextFormatFlag::HighLight);
+    text.setCursor(static_cast<int>(text.textLength()));
+    return text;
+}
+
+// Java side copy of a RawConfig tree, as passed back by setGlobalConfig
+static jobject rawConfigFromJava(const fcitx::RawConfig &cfg) {
+    std::map<std::string, fakejni::Value> fields = {
+            {"name",    fakejni::ref(fakejni::newString(cfg.name()))},
+            {"comment", fakejni::ref(fakejni::newString(cfg.comment()))},
+            {"value",   fakejni::ref(fakejni::newString(cfg.value()))},
+    };
+    if (cfg.hasSubItems()) {
+        std::vector<jobject> items;
+        for (const auto &item: cfg.subItems()) {
+            items.push_back(rawConfigFromJava(*cfg.get(item)));
+        }
+        fields["subItems"] = fakejni::ref(fakejni::newObjectArray("org/fcitx/fcitx5/android/core/RawConfig", items));
+    }
+    return fakejni::newInstance("org/fcitx/fcitx5/android/core/RawConfig", std::move(fields));
+}
+
+/**
+ * Status area of pinyin: toggles of chttrans, fullwidth and punctuation, and a menu of
+ * input method options with a submenu of its own
+ */
+class StatusArea {
+public:
+    StatusArea() {
+        for (const char *name: {"chttrans", "fullwidth", "punctuation", "remind"}) {
+            top_.push_back(makeAction(name, true));
+        }
+        options_ = makeAction("pinyin-options", false);
+        options_->setMenu(&menu_);
+        top_.push_back(options_);
+        for (int i = 0; i < 6; i++) {
+            menu_.addAction(makeAction("pinyin-option-" + std::to_string(i), true));
+        }
+        auto *more = makeAction("pinyin-more", false);
+        more->setMenu(&submenu_);
+        menu_.addAction(more);
+        for (int i = 0; i < 4; i++) {
+            submenu_.addAction(makeAction("pinyin-more-" + std::to_string(i), true));
+        }
+    }
+
+    [[nodiscard]] std::vector<ActionEntity> entities() const {
+        std::vector<ActionEntity> result;
+        for (auto *act: top_) {
+            result.emplace_back(act, nullptr);
+        }
+        return result;
+    }
+
+    // what JVM gets when the options menu is opened
+    [[nodiscard]] std::vector<ActionEntity> optionsMenu() const {
+        return ActionEntity::menuOf(options_, nullptr);
+    }
+
+private:
+    std::vector<std::unique_ptr<fcitx::SimpleAction>> owned_;
+    std::vector<fcitx::Action *> top_;
+    fcitx::SimpleAction *options_;
+    fcitx::Menu menu_;
+    fcitx::Menu submenu_;
+
+    fcitx::SimpleAction *makeAction(const std::string &name, bool checkable) {
+        auto *act = owned_.emplace_back(std::make_unique<fcitx::SimpleAction>()).get();
+        act->setShortText(name);
+        act->setLongText("Toggle " + name);
+        act->setIcon("fcitx-" + name);
+        act->setCheckable(checkable);
+        return act;
+    }
+};
+
+struct Result {
+    const char *name;
+    double nanos = 0;
+    uint64_t jniCalls = 0;
+    uint64_t objects = 0;
+    uint64_t strings = 0;
+    int64_t leakedLocalRefs = 0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+/**
+ * Run `convert` in batches; the fake JVM is emptied between batches, which also clears the
+ * interned string pool, so every batch starts with one untimed call to warm it up again.
+ * `prepare` makes the Java side input after each reset.
+ */
+static Result run(const char *name, int iterations,
+                  const std::function<void(JNIEnv *)> &prepare,
+                  const std::function<jobject(JNIEnv *)> &convert) {
+    constexpr int Batch = 256;
+    Result r{name};
+    auto *env = fakejni::env();
+    for (int done = 0; done < iterations; done += Batch) {
+        GlobalRef->StringPool.clear(env);
+        fakejni::reset();
+        prepare(env);
+        env->DeleteLocalRef(convert(env));
+        const int n = std::min(Batch, iterations - done);
+        const auto jni = fakejni::stats();
+        const uint64_t allocs = allocations, bytes = allocatedBytes;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            env->DeleteLocalRef(convert(env));
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        r.nanos += elapsed.count();
+        r.jniCalls += fakejni::stats().jniCalls - jni.jniCalls;
+        r.objects += fakejni::stats().objects - jni.objects;
+        r.strings += fakejni::stats().strings - jni.strings;
+        r.leakedLocalRefs += fakejni::stats().localRefs - jni.localRefs;
+        r.allocations += allocations - allocs;
+        r.allocatedBytes += allocatedBytes - bytes;
+    }
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 10000;
+    GlobalRef = new GlobalRefSingleton(fakejni::vm());
+    fakejni::setRecordCalls(false);
+
+    const auto candidates = readCandidates();
+    const auto text = preedit();
+    fcitx::GlobalConfig globalConfig;
+    fcitx::RawConfig config;
+    {
+        auto cfg = config.get("cfg", true);
+        globalConfig.config().save(*cfg);
+        auto desc = config.get("desc", true);
+        globalConfig.config().dumpDescription(*desc);
+    }
+    const StatusArea statusArea;
+    const auto actions = statusArea.entities();
+    const auto optionsMenu = statusArea.optionsMenu();
+    jobject javaConfig = nullptr;
+    const auto nothing = [](JNIEnv *) {};
+
+    std::vector<Result> results;
+    results.push_back(run("candidateEntityToObject", iterations, nothing, [&](JNIEnv *env) {
+        return candidateEntityToObject(env, candidates[0]);
+    }));
+    results.push_back(run("candidateEntitiesToObjectArray", iterations, nothing, [&](JNIEnv *env) {
+        return candidateEntitiesToObjectArray(env, candidates);
+    }));
+    results.push_back(run("fcitxTextToJObject", iterations, nothing, [&](JNIEnv *env) {
+        return fcitxTextToJObject(env, text);
+    }));
+    results.push_back(run("fcitxRawConfigToJObject", iterations, nothing, [&](JNIEnv *env) {
+        return fcitxRawConfigToJObject(env, config);
+    }));
+    results.push_back(run("jobjectFillRawConfig", iterations, [&](JNIEnv *) {
+        javaConfig = rawConfigFromJava(config);
+    }, [&](JNIEnv *env) -> jobject {
+        fcitx::RawConfig filled;
+        jobjectFillRawConfig(env, javaConfig, filled);
+        return nullptr;
+    }));
+    results.push_back(run("fcitxActionsToJObjectArray", iterations, nothing, [&](JNIEnv *env) {
+        // status area push, menus are left to be fetched
+        return fcitxActionsToJObjectArray(env, actions);
+    }));
+    results.push_back(run("fcitxActionsToJObjectArray(menu)", iterations, nothing, [&](JNIEnv *env) {
+        return fcitxActionsToJObjectArray(env, optionsMenu);
+    }));
+
+    std::printf("{\n"
+                "  \"iterations\": %d,\n"
+                "  \"candidates\": %zu,\n"
+                "  \"converters\": [", iterations, candidates.size());
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto &r = results[i];
+        const auto n = static_cast<double>(iterations);
+        std::printf("%s\n    {\"name\": \"%s\", \"nanos\": %.0f, \"jniCalls\": %.1f, \"localRefs\": %.1f, "
+                    "\"strings\": %.1f, \"leakedLocalRefs\": %lld, \"allocations\": %.1f, \"allocatedBytes\": %.0f}",
+                    i ? "," : "", r.name, r.nanos / n,
+                    static_cast<double>(r.jniCalls) / n,
+                    static_cast<double>(r.objects) / n,
+                    static_cast<double>(r.strings) / n,
+                    static_cast<long long>(r.leakedLocalRefs),
+                    static_cast<double>(r.allocations) / n,
+                    static_cast<double>(r.allocatedBytes) / n);
+    }
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
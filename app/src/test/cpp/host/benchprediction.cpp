@@ -0,0 +1,146 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+// Next word predictions of NextWordPredictor after English words of keyboard-us sessions, with
+// the per keystroke time budget of AndroidKeyboardEngine and without one, and memory of the
+// process before and after opening the model. File backed pages of the mapped model are shared
+// and reclaimable, unlike anonymous ones.
+// The model is the one AndroidKeyboardEngine would open for "en", libime/en.lm in data
+// directories, unless given. None ships with the app, so prediction is off by default.
+// usage: benchprediction [model] [predictions]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "androidkeyboard/nextwordpredictor.h"
+
+// same as AndroidKeyboardEngine
+static constexpr size_t PredictionSize = 10;
+static constexpr auto PredictionTimeBudget = std::chrono::milliseconds(4);
+// language of keyboard-us
+static constexpr const char *Language = "en";
+
+struct Memory {
+    long anonKiB = 0;
+    long fileKiB = 0;
+};
+
+static Memory memory() {
+    Memory m;
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.starts_with("RssAnon:")) m.anonKiB = std::atol(line.c_str() + 8);
+        if (line.starts_with("RssFile:")) m.fileKiB = std::atol(line.c_str() + 8);
+    }
+    return m;
+}
+
+// words typed in keyboard-us sessions of data/keystroke-sessions.txt, in order
+static std::vector<std::string> readWords() {
+    std::vector<std::string> words;
+    std::ifstream in(HOST_TEST_DATA_DIR "/keystroke-sessions.txt");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.starts_with("keyboard-us ")) continue;
+        std::istringstream ss(line.substr(12));
+        std::string word;
+        while (ss >> word) {
+            // keys and selections
+            if (word[0] == '<' || word[0] == '#') continue;
+            words.push_back(word);
+        }
+    }
+    return words;
+}
+
+struct Result {
+    std::vector<double> micros;
+    size_t predicted = 0;
+};
+
+static Result run(fcitx::NextWordPredictor &predictor, const std::vector<std::string> &words,
+                  size_t count, std::chrono::steady_clock::duration budget) {
+    Result r;
+    r.micros.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const std::vector<std::string> history = {words[i % words.size()], words[(i * 7 + 1) % words.size()]};
+        const auto start = std::chrono::steady_clock::now();
+        const auto predictions = predictor.predict(Language, history, PredictionSize, budget);
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        r.micros.push_back(elapsed.count());
+        r.predicted += predictions.size();
+    }
+    std::sort(r.micros.begin(), r.micros.end());
+    return r;
+}
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+static void print(const char *name, const Result &r, size_t count, bool last) {
+    std::printf("    \"%s\": {\"p50\": %.1f, \"p95\": %.1f, \"p99\": %.1f, \"max\": %.1f, \"wordsPerPrediction\": %.2f}%s\n",
+                name, percentile(r.micros, 0.5), percentile(r.micros, 0.95), percentile(r.micros, 0.99),
+                r.micros.empty() ? 0 : r.micros.back(),
+                static_cast<double>(r.predicted) / static_cast<double>(count), last ? "" : ",");
+}
+
+int main(int argc, char *argv[]) {
+    const std::string model = argc > 1 ? argv[1] : fcitx::NextWordPredictor::modelPath(Language).string();
+    const size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    if (model.empty()) {
+        std::fprintf(stderr, "no libime/%s.lm in data directories, give a model\n", Language);
+        return 1;
+    }
+    const auto words = readWords();
+    if (words.empty()) {
+        std::fprintf(stderr, "no words in " HOST_TEST_DATA_DIR "/keystroke-sessions.txt\n");
+        return 1;
+    }
+
+    const auto before = memory();
+    fcitx::NextWordPredictor predictor;
+    const auto loadStart = std::chrono::steady_clock::now();
+    if (!predictor.load(Language, model)) {
+        std::fprintf(stderr, "cannot load %s\n", model.c_str());
+        return 1;
+    }
+    const std::chrono::duration<double, std::milli> load = std::chrono::steady_clock::now() - loadStart;
+    const auto loaded = memory();
+    const auto budgeted = run(predictor, words, count, PredictionTimeBudget);
+    const auto afterBudgeted = memory();
+    const auto stats = predictor.stats();
+    const auto unlimited = run(predictor, words, count, std::chrono::hours(1));
+
+    std::printf("{\n"
+                "  \"model\": \"%s\",\n"
+                "  \"predictions\": %zu,\n"
+                "  \"loadMillis\": %.1f,\n"
+                "  \"rssKiB\": {\n"
+                "    \"anonAfterLoad\": %ld, \"fileAfterLoad\": %ld,\n"
+                "    \"anonAfterPredictions\": %ld, \"fileAfterPredictions\": %ld\n"
+                "  },\n"
+                "  \"budgetMicros\": %lld,\n"
+                "  \"exhausted\": %llu,\n"
+                "  \"successorsPerPrediction\": %.1f,\n"
+                "  \"latencyMicros\": {\n",
+                model.c_str(), count, load.count(),
+                loaded.anonKiB - before.anonKiB, loaded.fileKiB - before.fileKiB,
+                afterBudgeted.anonKiB - before.anonKiB, afterBudgeted.fileKiB - before.fileKiB,
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(PredictionTimeBudget).count()),
+                static_cast<unsigned long long>(stats.exhausted),
+                static_cast<double>(stats.candidates) / static_cast<double>(count));
+    print("budgeted", budgeted, count, false);
+    print("unlimited", unlimited, count, true);
+    std::printf("  }\n}\n");
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_COUNTINGALLOC_H
+#define FCITX5_ANDROID_COUNTINGALLOC_H
+
+// Replaces global operator new and delete to count native allocations of a benchmark.
+// Replacement allocation functions cannot be inline: include from one source file per executable.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "fakejni.h"
+
+static std::atomic<uint64_t> allocations{0};
+static std::atomic<uint64_t> allocatedBytes{0};
+
+// counts native allocations only, objects made by the fake JVM would be on the Java heap
+void *operator new(size_t size) {
+    if (!fakejni::inside()) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (auto *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+#endif //FCITX5_ANDROID_COUNTINGALLOC_H
@@ -0,0 +1,160 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#ifndef FCITX5_ANDROID_HOSTFCITX_H
+#define FCITX5_ANDROID_HOSTFCITX_H
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "fakejni.h"
+
+// entry points of native-lib called by org.fcitx.fcitx5.android.core.Fcitx
+extern "C" {
+jint JNI_OnLoad(JavaVM *jvm, void *reserved);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_setupLogStream(JNIEnv *env, jclass clazz, jboolean verbose);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_startupFcitx(JNIEnv *env, jclass clazz, jstring locale, jstring appData, jstring appLib, jstring extData, jstring extCache, jobjectArray extDomains);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_loopOnce(JNIEnv *env, jclass clazz);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_scheduleEmpty(JNIEnv *env, jclass clazz);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_exitFcitx(JNIEnv *env, jclass clazz);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_sendKeySymToFcitx(JNIEnv *env, jclass clazz, jint sym, jint state, jint code, jboolean up, jint timestamp);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_setInputMethod(JNIEnv *env, jclass clazz, jstring ime);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_activateInputContext(JNIEnv *env, jclass clazz, jint uid, jstring pkgName);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_focusInputContext(JNIEnv *env, jclass clazz, jboolean focus);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_focusInputContextOutIn(JNIEnv *env, jclass clazz);
+void Java_org_fcitx_fcitx5_android_core_Fcitx_setEnabledInputMethods(JNIEnv *env, jclass clazz, jobjectArray array);
+jobject Java_org_fcitx_fcitx5_android_core_Fcitx_inputMethodStatus(JNIEnv *env, jclass clazz);
+jboolean Java_org_fcitx_fcitx5_android_core_Fcitx_selectCandidate(JNIEnv *env, jclass clazz, jint idx);
+jlongArray Java_org_fcitx_fcitx5_android_core_Fcitx_getStatusAreaStats(JNIEnv *env, jclass clazz);
+jboolean Java_org_fcitx_fcitx5_android_core_Fcitx_isKeyboardIdle(JNIEnv *env, jclass clazz);
+}
+
+/**
+ * Drives native-lib the way Fcitx.kt does, on the calling thread: JNI_OnLoad, startup with
+ * addon configs from `stageDir` and user data in a fresh directory, then loopOnce on demand.
+ */
+class HostFcitx {
+public:
+    HostFcitx(const std::string &stageDir, const std::string &libDir, const std::string &workDir) {
+        std::filesystem::remove_all(workDir);
+        std::filesystem::create_directories(workDir + "/data");
+        std::filesystem::create_directories(workDir + "/cache");
+        auto *env = fakejni::env();
+        JNI_OnLoad(fakejni::vm(), nullptr);
+        Java_org_fcitx_fcitx5_android_core_Fcitx_setupLogStream(env, nullptr, JNI_FALSE);
+        Java_org_fcitx_fcitx5_android_core_Fcitx_startupFcitx(
+                env, nullptr,
+                fakejni::newString("en_US"),
+                fakejni::newString(stageDir),
+                fakejni::newString(libDir),
+                fakejni::newString(workDir + "/data"),
+                fakejni::newString(workDir + "/cache"),
+                fakejni::newObjectArray("java/lang/String", {}));
+        // startup posts the ready event, it's delivered by the first iteration
+        loopUntil("handleReadyEvent");
+        Java_org_fcitx_fcitx5_android_core_Fcitx_activateInputContext(env, nullptr, 10000, fakejni::newString("org.example.host"));
+        Java_org_fcitx_fcitx5_android_core_Fcitx_focusInputContext(env, nullptr, JNI_TRUE);
+        loopOnce();
+    }
+
+    HostFcitx(const HostFcitx &) = delete;
+
+    ~HostFcitx() {
+        Java_org_fcitx_fcitx5_android_core_Fcitx_exitFcitx(fakejni::env(), nullptr);
+    }
+
+    // one event loop iteration, never blocks for long since a wake up is scheduled first
+    static void loopOnce() {
+        auto *env = fakejni::env();
+        Java_org_fcitx_fcitx5_android_core_Fcitx_scheduleEmpty(env, nullptr);
+        Java_org_fcitx_fcitx5_android_core_Fcitx_loopOnce(env, nullptr);
+    }
+
+    // iterate until a call of Java `method` is recorded, or abort after a few seconds
+    static void loopUntil(const std::string &method) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!called(method)) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                std::abort();
+            }
+            loopOnce();
+        }
+    }
+
+    /**
+     * iterate until word hints of keyboard-us computed off the fcitx thread are shown, or abort
+     * after a few seconds; what is on screen no longer depends on timing then
+     */
+    static void settle() {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!Java_org_fcitx_fcitx5_android_core_Fcitx_isKeyboardIdle(fakejni::env(), nullptr)) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                std::abort();
+            }
+            loopOnce();
+        }
+    }
+
+    static bool called(const std::string &method) {
+        for (const auto &call: fakejni::calls()) {
+            if (call.method->name == method) return true;
+        }
+        return false;
+    }
+
+    // enable keyboard-us and `im`, then switch to `im`; false if it's not loaded
+    static bool setInputMethod(const std::string &im) {
+        auto *env = fakejni::env();
+        const auto enabled = fakejni::newObjectArray("java/lang/String", {
+                fakejni::newString("keyboard-us"), fakejni::newString(im)});
+        Java_org_fcitx_fcitx5_android_core_Fcitx_setEnabledInputMethods(env, nullptr, enabled);
+        Java_org_fcitx_fcitx5_android_core_Fcitx_setInputMethod(env, nullptr, fakejni::newString(im));
+        loopOnce();
+        return currentInputMethod() == im;
+    }
+
+    static std::string currentInputMethod() {
+        auto *status = fakejni::object(Java_org_fcitx_fcitx5_android_core_Fcitx_inputMethodStatus(fakejni::env(), nullptr));
+        // InputMethodEntry(uniqueName, name, ...)
+        if (!status || status->args.empty() || !status->args[0].l) return {};
+        return status->args[0].l->utf;
+    }
+
+    // drop preedit and candidates, like leaving and coming back to the text field
+    static void resetInputContext() {
+        Java_org_fcitx_fcitx5_android_core_Fcitx_focusInputContextOutIn(fakejni::env(), nullptr);
+        loopOnce();
+    }
+
+    // values of a jlongArray of stats returned by native-lib
+    static std::vector<int64_t> stats(jlongArray array) {
+        auto *o = fakejni::object(array);
+        return o ? o->primitives : std::vector<int64_t>{};
+    }
+
+    // flushes, suppressed, menus
+    static std::vector<int64_t> statusAreaStats() {
+        return stats(Java_org_fcitx_fcitx5_android_core_Fcitx_getStatusAreaStats(fakejni::env(), nullptr));
+    }
+
+    static void select(int idx) {
+        Java_org_fcitx_fcitx5_android_core_Fcitx_selectCandidate(fakejni::env(), nullptr, idx);
+        loopOnce();
+        settle();
+    }
+
+    // press and release, like a key on the virtual keyboard
+    static void tap(int sym, int timestamp) {
+        auto *env = fakejni::env();
+        Java_org_fcitx_fcitx5_android_core_Fcitx_sendKeySymToFcitx(env, nullptr, sym, 0, 0, JNI_FALSE, timestamp);
+        Java_org_fcitx_fcitx5_android_core_Fcitx_sendKeySymToFcitx(env, nullptr, sym, 0, 0, JNI_TRUE, timestamp);
+        loopOnce();
+        settle();
+    }
+};
+
+#endif //FCITX5_ANDROID_HOSTFCITX_H
@@ -0,0 +1,51 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <string>
+
+#include "hostfcitx.h"
+
+// any string reachable from arguments of a recorded call into Java
+static bool mentions(const fakejni::Object *obj, const std::string &text) {
+    if (!obj) return false;
+    switch (obj->kind) {
+        case fakejni::Kind::String:
+            return obj->utf == text;
+        case fakejni::Kind::ObjectArray:
+            for (const auto *e: obj->elements) {
+                if (mentions(e, text)) return true;
+            }
+            return false;
+        case fakejni::Kind::Instance:
+            for (const auto &arg: obj->args) {
+                if (mentions(arg.l, text)) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+static bool sent(const std::string &text) {
+    for (const auto &call: fakejni::calls()) {
+        for (const auto &arg: call.args) {
+            if (mentions(arg.l, text)) return true;
+        }
+    }
+    return false;
+}
+
+int main() {
+    HostFcitx fcitx(HOST_STAGE_DIR, HOST_LIB_DIR, "hoststartup");
+    assert(HostFcitx::called("handleReadyEvent"));
+    const bool switched = HostFcitx::setInputMethod("keyboard-us");
+    assert(switched);
+    fakejni::clearCalls();
+    HostFcitx::tap('a', 1);
+    // either committed right away or shown as preedit, depends on word hints
+    assert(sent("a"));
+    assert(fakejni::stats().exceptions == 0);
+    return 0;
+}
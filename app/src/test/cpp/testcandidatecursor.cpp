@@ -0,0 +1,170 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "candidate-cursor.h"
+
+// list of `size` entries that counts how often it is read
+struct FakeList {
+    int size;
+    int calls = 0;
+
+    bool operator()(int i, std::string &out) {
+        calls++;
+        if (i >= size) return false;
+        out = std::to_string(i);
+        return true;
+    }
+};
+
+static void assertWindow(const std::vector<std::string> &out, int offset, int count) {
+    assert(static_cast<int>(out.size()) == count);
+    for (int i = 0; i < count; i++) {
+        assert(out[i] == std::to_string(offset + i));
+    }
+}
+
+void testStaleGeneration() {
+    CandidateCursor<std::string> cursor;
+    FakeList list{10};
+    std::vector<std::string> out;
+    // nothing opened yet
+    assert(!cursor.read(0, 0, 5, out, list));
+    const auto first = cursor.open(10);
+    assert(first != 0);
+    assert(cursor.read(first, 0, 5, out, list));
+    assertWindow(out, 0, 5);
+    const auto second = cursor.open(10);
+    assert(second != first);
+    const int calls = list.calls;
+    // rejected without touching the list
+    assert(!cursor.read(first, 5, 5, out, list));
+    assert(out.empty());
+    assert(list.calls == calls);
+    cursor.close();
+    assert(!cursor.read(second, 0, 5, out, list));
+    assert(cursor.stats().stale == 3);
+}
+
+void testConstantCostPerPage() {
+    constexpr int Size = 1200;
+    constexpr int Page = 48;
+    CandidateCursor<std::string> cursor;
+    FakeList list{Size};
+    std::vector<std::string> out;
+    const auto gen = cursor.open(Size);
+    for (int offset = 0; offset < Size; offset += Page) {
+        const int before = list.calls;
+        assert(cursor.read(gen, offset, Page, out, list));
+        assertWindow(out, offset, Page);
+        if (offset > 0) {
+            // served by the previous readahead
+            assert(list.calls == before);
+        }
+        const int fetching = list.calls;
+        cursor.readahead(list);
+        assert(list.calls - fetching <= Page);
+    }
+    assert(cursor.stats().fetched == Size);
+    // never call past a known total
+    assert(list.calls == Size);
+}
+
+void testUnknownTotal() {
+    CandidateCursor<std::string> cursor;
+    FakeList list{30};
+    std::vector<std::string> out;
+    const auto gen = cursor.open(-1);
+    assert(cursor.read(gen, 0, 20, out, list));
+    assertWindow(out, 0, 20);
+    assert(cursor.read(gen, 20, 20, out, list));
+    assertWindow(out, 20, 10);
+    // end of list is remembered
+    assert(!cursor.readaheadPending());
+    const int calls = list.calls;
+    assert(cursor.read(gen, 30, 20, out, list));
+    assert(out.empty());
+    assert(list.calls == calls);
+}
+
+void testScrollBackAndBound() {
+    CandidateCursor<std::string> cursor(64);
+    FakeList list{1000};
+    std::vector<std::string> out;
+    const auto gen = cursor.open(1000);
+    assert(cursor.read(gen, 100, 32, out, list));
+    assertWindow(out, 100, 32);
+    // overlapping window in front of the cached range
+    assert(cursor.read(gen, 80, 32, out, list));
+    assertWindow(out, 80, 32);
+    assert(cursor.stats().fetched == 52);
+    // jump far away
+    assert(cursor.read(gen, 500, 100, out, list));
+    assertWindow(out, 500, 100);
+    assert(cursor.read(gen, 600, 32, out, list));
+    assertWindow(out, 600, 32);
+    // entries before the window were dropped to respect the bound
+    const auto fetched = cursor.stats().fetched;
+    assert(cursor.read(gen, 500, 10, out, list));
+    assertWindow(out, 500, 10);
+    assert(cursor.stats().fetched == fetched + 10);
+}
+
+void testPrime() {
+    CandidateCursor<std::string> cursor;
+    FakeList list{100};
+    std::vector<std::string> first{"0", "1", "2", "3"};
+    const auto gen = cursor.open(100);
+    cursor.prime(first, 8);
+    assert(cursor.readaheadPending());
+    assert(list.calls == 0);
+    cursor.readahead(list);
+    assert(list.calls == 8);
+    std::vector<std::string> out;
+    // pushed and prefetched entries need no fetch
+    assert(cursor.read(gen, 2, 10, out, list));
+    assertWindow(out, 2, 10);
+    assert(list.calls == 8);
+    // whole list pushed, nothing to prefetch
+    cursor.open(4);
+    cursor.prime(first, 8);
+    assert(!cursor.readaheadPending());
+}
+
+void testReadaheadCached() {
+    CandidateCursor<std::string> cursor;
+    FakeList list{100};
+    std::vector<std::string> out;
+    const auto gen = cursor.open(100);
+    assert(cursor.read(gen, 20, 10, out, list));
+    cursor.readahead(list);
+    assert(cursor.read(gen, 30, 10, out, list));
+    assert(cursor.readaheadPending());
+    // scrolling back, the window after it is still cached
+    assert(cursor.read(gen, 10, 10, out, list));
+    assertWindow(out, 10, 10);
+    assert(!cursor.readaheadPending());
+    const int calls = list.calls;
+    cursor.readahead(list);
+    assert(list.calls == calls);
+    // pushed entries already cover the window after them
+    cursor.open(100);
+    cursor.prime({"0", "1", "2", "3"}, 8);
+    cursor.readahead(list);
+    assert(cursor.read(cursor.generation(), 0, 4, out, list));
+    assert(!cursor.readaheadPending());
+}
+
+int main() {
+    testStaleGeneration();
+    testConstantCostPerPage();
+    testUnknownTotal();
+    testScrollBackAndBound();
+    testPrime();
+    testReadaheadCached();
+    return 0;
+}
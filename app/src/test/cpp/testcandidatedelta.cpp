@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "candidate-delta.h"
+
+using List = std::vector<std::string>;
+
+static void roundTrip(const List &prev, const List &next, bool expectDelta) {
+    std::vector<size_t> inserted;
+    const auto ops = candidate_delta::encode(prev, next, inserted);
+    assert(ops.empty() == !expectDelta);
+    if (ops.empty()) return;
+    assert(ops.size() % 2 == 0);
+    List insertedEntries;
+    for (const auto i: inserted) {
+        insertedEntries.push_back(next[i]);
+    }
+    List out;
+    assert(candidate_delta::apply(prev, insertedEntries, ops, out));
+    assert(out == next);
+}
+
+void testUnchanged() {
+    const List l{"a", "b", "c"};
+    std::vector<size_t> inserted;
+    const auto ops = candidate_delta::encode(l, l, inserted);
+    // a single run covers the whole list
+    assert((ops == std::vector<int32_t>{0, 3}));
+    assert(inserted.empty());
+    roundTrip(l, l, true);
+}
+
+void testInsertAndShift() {
+    const List prev{"a", "b", "c", "d", "e", "f", "g", "h"};
+    const List next{"x", "a", "b", "c", "y", "e", "f", "g", "h"};
+    std::vector<size_t> inserted;
+    const auto ops = candidate_delta::encode(prev, next, inserted);
+    assert((ops == std::vector<int32_t>{candidate_delta::Insert, 1, 0, 3, candidate_delta::Insert, 1, 4, 4}));
+    assert((inserted == std::vector<size_t>{0, 4}));
+    roundTrip(prev, next, true);
+}
+
+void testReorder() {
+    roundTrip({"a", "b", "c"}, {"b", "c", "a", "a"}, true);
+    // one op per entry is no smaller than the list
+    roundTrip({"a", "b", "c"}, {"c", "b", "a"}, false);
+}
+
+// ops and inserted entries against a full push of the list
+void testCrossover() {
+    List prev;
+    for (int i = 0; i < 16; i++) prev.push_back("p" + std::to_string(i));
+    List next = prev;
+    next[3] = "n3";
+    next[9] = "n9";
+    // 5 ops and 2 entries
+    roundTrip(prev, next, true);
+    // one kept among 15 scattered inserts: 16 ops and 15 entries
+    List scattered;
+    for (int i = 0; i < 16; i++) scattered.push_back(i == 8 ? prev[8] : "n" + std::to_string(i));
+    roundTrip(prev, scattered, false);
+    // one kept and a run of 15 inserts, 2 ops and 15 entries
+    List run{prev[0]};
+    for (int i = 1; i < 16; i++) run.push_back("n" + std::to_string(i));
+    roundTrip(prev, run, false);
+    // two kept, 2 ops and 14 entries are as many as the list, three kept are fewer
+    run[1] = prev[1];
+    roundTrip(prev, run, false);
+    run[2] = prev[2];
+    roundTrip(prev, run, true);
+}
+
+void testFullPush() {
+    // nothing in common, or nothing to compare with
+    roundTrip({"a", "b"}, {"c", "d"}, false);
+    roundTrip({}, {"a"}, false);
+    roundTrip({"a"}, {}, false);
+}
+
+void testApplyRejectsBadOps() {
+    List out;
+    assert(!candidate_delta::apply<std::string>({"a"}, {}, {0, 2}, out));
+    assert(!candidate_delta::apply<std::string>({"a"}, {"b"}, {0, 1}, out));
+    assert(!candidate_delta::apply<std::string>({"a"}, {}, {candidate_delta::Insert, 1}, out));
+}
+
+int main() {
+    testUnchanged();
+    testInsertAndShift();
+    testReorder();
+    testCrossover();
+    testFullPush();
+    testApplyRejectsBadOps();
+    return 0;
+}
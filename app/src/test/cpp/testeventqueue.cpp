@@ -0,0 +1,110 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+#include "event-queue.h"
+
+// manually advanced clock, to check event age
+struct FakeClock {
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+    static inline time_point current{};
+
+    static time_point now() { return current; }
+
+    static void advance(duration d) { current += d; }
+};
+
+void testQueueBatch() {
+    EventQueue queue;
+    std::vector<int> delivered;
+    for (int i = 0; i < 5; i++) {
+        queue.post([&delivered, i] { delivered.push_back(i); });
+    }
+    // nothing is delivered until drain
+    assert(delivered.empty());
+    assert(queue.depth() == 5);
+    assert(queue.drain() == 5);
+    assert((delivered == std::vector<int>{0, 1, 2, 3, 4}));
+    assert(queue.depth() == 0);
+    assert(queue.drain() == 0);
+}
+
+// no limit on depth, posting never delivers in place
+void testQueueDeep() {
+    EventQueue queue;
+    std::vector<int> delivered;
+    for (int i = 0; i < 1000; i++) {
+        queue.post([&delivered, i] { delivered.push_back(i); });
+    }
+    assert(delivered.empty());
+    assert(queue.drain() == 1000);
+    for (int i = 0; i < 1000; i++) {
+        assert(delivered[i] == i);
+    }
+}
+
+void testQueueStats() {
+    EventQueue<4, FakeClock> queue;
+    std::vector<int> delivered;
+    for (int i = 0; i < 6; i++) {
+        queue.post([&delivered, i] { delivered.push_back(i); });
+        FakeClock::advance(std::chrono::microseconds(10));
+    }
+    // beyond the high-water mark events are counted, but still queued
+    assert(delivered.empty());
+    assert(queue.depth() == 6);
+    assert(queue.drain() == 6);
+    assert((delivered == std::vector<int>{0, 1, 2, 3, 4, 5}));
+
+    const auto &stats = queue.stats();
+    assert(stats.delivered == 6);
+    assert(stats.batches == 1);
+    assert(stats.overflowed == 2);
+    assert(stats.peakDepth == 6);
+    assert(stats.maxAgeNanos == 60000);
+    assert(stats.totalAgeNanos == 60000 + 50000 + 40000 + 30000 + 20000 + 10000);
+
+    // an empty drain is not a batch
+    assert(queue.drain() == 0);
+    assert(queue.stats().batches == 1);
+
+    queue.post([] {});
+    queue.drain();
+    assert(queue.stats().batches == 2);
+    assert(queue.stats().peakDepth == 6);
+    assert(queue.stats().overflowed == 2);
+
+    queue.resetStats();
+    assert(queue.stats().delivered == 0);
+    assert(queue.stats().peakDepth == 0);
+}
+
+// event posted by a handler during drain is delivered in the same drain, after the batch
+void testQueueReentrant() {
+    EventQueue queue;
+    std::vector<int> delivered;
+    queue.post([&] {
+        delivered.push_back(0);
+        queue.post([&] { delivered.push_back(2); });
+    });
+    queue.post([&] { delivered.push_back(1); });
+    assert(queue.drain() == 3);
+    assert((delivered == std::vector<int>{0, 1, 2}));
+    assert(queue.depth() == 0);
+}
+
+int main() {
+    testQueueBatch();
+    testQueueDeep();
+    testQueueStats();
+    testQueueReentrant();
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+#include "fakejni.h"
+#include "jni-utils.h"
+#include "nativestreambuf.h"
+
+GlobalRefSingleton *GlobalRef;
+
+void testGlobalRefSingleton() {
+    GlobalRef = new GlobalRefSingleton(fakejni::vm());
+    auto *fcitx = fakejni::object(GlobalRef->Fcitx);
+    assert(fcitx->kind == fakejni::Kind::Class);
+    assert(fcitx->className == "org/fcitx/fcitx5/android/core/Fcitx");
+    auto *method = reinterpret_cast<const fakejni::Method *>(GlobalRef->HandleCommitStringEvent);
+    assert(method->name == "handleCommitStringEvent");
+    assert(method->isStatic);
+}
+
+void testStringsAndRefs() {
+    fakejni::reset();
+    auto env = GlobalRef->AttachEnv();
+    {
+        JString s(env, "拼音 😀");
+        assert(fakejni::string(*s) == "拼音 😀");
+        // surrogate pair for the emoji
+        assert(fakejni::object(*s)->chars.size() == 5);
+        CString c(env, s);
+        assert(std::string(c) == "拼音 😀");
+    }
+    {
+        auto array = JRef<jintArray>(env, env->NewIntArray(3));
+        const jint values[] = {1, 2, 3};
+        env->SetIntArrayRegion(array, 0, 3, values);
+        assert(fakejni::object(array)->primitives[2] == 3);
+    }
+    assert(fakejni::stats().localRefs == 0);
+    assert(fakejni::stats().strings == 1);
+    throwJavaException(env, "oops");
+    assert(fakejni::lastException() == "oops");
+}
+
+void testCallbacksAreDecoded() {
+    fakejni::reset();
+    auto env = GlobalRef->AttachEnv();
+    env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleCommitStringEvent, *JString(env, "hello"), 5);
+    env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleKeyEvent, 0x61, 4, 0x61, JNI_TRUE, -1);
+    const auto &calls = fakejni::calls();
+    assert(calls.size() == 2);
+    assert(calls[0].method->name == "handleCommitStringEvent");
+    assert(calls[0].args.size() == 2);
+    assert(fakejni::string(reinterpret_cast<jobject>(calls[0].args[0].l)) == "hello");
+    assert(calls[0].args[1].i == 5);
+    assert(calls[1].args.size() == 5);
+    assert(calls[1].args[3].type == 'Z' && calls[1].args[3].i == 1);
+    assert(calls[1].args[4].i == -1);
+    fakejni::setRecordCalls(false);
+    env->CallStaticVoidMethod(GlobalRef->Fcitx, GlobalRef->HandleReadyEvent);
+    fakejni::setRecordCalls(true);
+    assert(fakejni::calls().size() == 2);
+    assert(fakejni::stats().callbacks == 3);
+    // "hello" in UTF-16 and an int, then four ints and a boolean
+    assert(fakejni::stats().marshalledBytes == 14 + 17);
+    assert(!fakejni::inside());
+}
+
+void testObjectsFromJava() {
+    fakejni::reset();
+    auto env = GlobalRef->AttachEnv();
+    auto name = fakejni::newString("Hotkey");
+    auto config = fakejni::newInstance("org/fcitx/fcitx5/android/core/RawConfig",
+                                       {{"name", fakejni::ref(name)}});
+    auto field = JRef<jstring>(env, env->GetObjectField(config, GlobalRef->RawConfigName));
+    assert(fakejni::string(*field) == "Hotkey");
+    assert(env->GetObjectField(config, GlobalRef->RawConfigValue) == nullptr);
+    auto states = reinterpret_cast<jbooleanArray>(fakejni::newPrimitiveArray('Z', {1, 0}));
+    auto *elements = env->GetBooleanArrayElements(states, nullptr);
+    assert(env->GetArrayLength(states) == 2 && elements[0] && !elements[1]);
+    env->ReleaseBooleanArrayElements(states, elements, JNI_ABORT);
+}
+
+void testStringPoolAndByteBuffer() {
+    fakejni::reset();
+    auto env = GlobalRef->AttachEnv();
+    {
+        JInternedString a(env, "pinyin");
+        JInternedString b(env, "pinyin");
+        assert(fakejni::string(*a) == "pinyin");
+        assert(fakejni::object(*a) == fakejni::object(*b));
+    }
+    assert(GlobalRef->StringPool.stats().hits == 1);
+    GlobalRef->StringPool.clear(env);
+    assert(fakejni::stats().globalRefs == 0);
+    JDirectByteBuffer buffer;
+    const uint8_t data[] = {1, 2, 3, 4};
+    auto *b = fakejni::object(buffer.assign(env, data, sizeof(data)));
+    assert(b->kind == fakejni::Kind::DirectByteBuffer);
+    assert(static_cast<uint8_t *>(b->address)[3] == 4);
+    assert(fakejni::stats().localRefs == 0);
+}
+
+void testLogToStderr() {
+    std::fflush(stderr);
+    auto *capture = std::tmpfile();
+    const int saved = ::dup(STDERR_FILENO);
+    ::dup2(::fileno(capture), STDERR_FILENO);
+    {
+        native_streambuf<16> buf;
+        std::ostream out(&buf);
+        // FCITX_* logging writes a level letter first, then the message
+        out << "Wthis line is longer than the buffer" << std::flush;
+        out << "Ishort" << std::flush;
+    }
+    std::fflush(stderr);
+    ::dup2(saved, STDERR_FILENO);
+    ::close(saved);
+    std::rewind(capture);
+    char text[256] = {};
+    const auto n = std::fread(text, 1, sizeof(text) - 1, capture);
+    std::fclose(capture);
+    assert(std::string(text, n) == "W/fcitx5: this line is longer than the bufferI/fcitx5: short");
+}
+
+int main() {
+    testGlobalRefSingleton();
+    testStringsAndRefs();
+    testCallbacksAreDecoded();
+    testObjectsFromJava();
+    testStringPoolAndByteBuffer();
+    testLogToStderr();
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "androidfrontend/framescheduler.h"
+
+constexpr uint64_t Budget = 16000;
+
+/**
+ * Drives FrameScheduler the way AndroidFrontend does, with a fake clock and timer
+ */
+struct FakeFrontend {
+    FrameScheduler scheduler{Budget};
+    uint64_t clock = 1000000;
+    // armed timer, 0 if none
+    uint64_t timer = 0;
+    std::string state;
+    std::vector<std::string> pushes;
+
+    void push() {
+        timer = 0;
+        pushes.push_back(state);
+        scheduler.pushed(clock);
+    }
+
+    // a key changing the panel, optionally committing text
+    void key(const std::string &s, bool commit = false) {
+        state = s;
+        if (scheduler.markDirty(clock)) {
+            timer = scheduler.deadline();
+        }
+        if (scheduler.shouldPush(clock, commit)) {
+            push();
+        }
+    }
+
+    // advance the clock, firing the timer on the way
+    void advance(uint64_t micros) {
+        const uint64_t target = clock + micros;
+        if (timer && timer <= target) {
+            clock = timer;
+            push();
+        }
+        clock = target;
+    }
+};
+
+void testQuietTypingIsNotDelayed() {
+    FakeFrontend f;
+    for (int i = 0; i < 5; i++) {
+        f.key(std::to_string(i));
+        assert(f.pushes.size() == static_cast<size_t>(i + 1));
+        assert(f.timer == 0);
+        f.advance(100000);
+    }
+    assert(f.scheduler.stats().delivered == 5);
+    assert(f.scheduler.stats().dropped == 0);
+}
+
+void testBurstIsPaced() {
+    FakeFrontend f;
+    f.key("a");
+    // 10 keys, 2 ms apart: auto repeat
+    for (int i = 0; i < 10; i++) {
+        f.advance(2000);
+        f.key(std::string(i + 2, 'a'));
+    }
+    f.advance(100000);
+    // first key at once, then one push per 16 ms, and the last state always arrives
+    assert((f.pushes == std::vector<std::string>{"a", "aaaaaaaa", "aaaaaaaaaaa"}));
+    const auto &stats = f.scheduler.stats();
+    assert(stats.delivered == 3);
+    assert(stats.dropped == 8);
+    assert(stats.delivered + stats.dropped == 11);
+}
+
+void testHeldAtMostBudget() {
+    FakeFrontend f;
+    f.key("a");
+    f.advance(1000);
+    f.key("b");
+    assert(f.pushes.size() == 1);
+    assert(f.timer == 1000000 + Budget);
+    f.advance(Budget - 1001);
+    assert(f.pushes.size() == 1);
+    f.advance(1);
+    assert((f.pushes == std::vector<std::string>{"a", "b"}));
+}
+
+void testCommitFlushesImmediately() {
+    FakeFrontend f;
+    f.key("a");
+    f.advance(1000);
+    f.key("b");
+    f.advance(1000);
+    f.key("", true);
+    assert((f.pushes == std::vector<std::string>{"a", ""}));
+    assert(f.timer == 0);
+    const auto &stats = f.scheduler.stats();
+    assert(stats.immediate == 1);
+    assert(stats.dropped == 1);
+    // nothing left for the timer
+    f.advance(100000);
+    assert(f.pushes.size() == 2);
+}
+
+void testRepeatedCompletionIsOneFrame() {
+    FakeFrontend f;
+    f.key("a");
+    f.advance(1000);
+    f.key("b");
+    // event loop iterations without changes
+    for (int i = 0; i < 5; i++) {
+        assert(!f.scheduler.shouldPush(f.clock, false));
+    }
+    f.advance(Budget);
+    assert(f.scheduler.stats().dropped == 0);
+    assert(f.scheduler.stats().delivered == 2);
+}
+
+void testBudgetZeroPushesEverything() {
+    FakeFrontend f;
+    f.scheduler.setBudget(0);
+    for (int i = 0; i < 10; i++) {
+        f.key(std::to_string(i));
+        f.advance(1);
+    }
+    assert(f.pushes.size() == 10);
+    assert(f.scheduler.stats().dropped == 0);
+}
+
+void testCancel() {
+    FakeFrontend f;
+    f.key("a");
+    f.advance(1000);
+    assert(f.scheduler.markDirty(f.clock));
+    // state turned out to be empty
+    f.scheduler.cancel();
+    assert(!f.scheduler.pending());
+    assert(f.scheduler.stats().delivered == 1);
+    assert(f.scheduler.stats().dropped == 0);
+}
+
+int main() {
+    testQuietTypingIsNotDelayed();
+    testBurstIsPaced();
+    testHeldAtMostBudget();
+    testCommitFlushesImmediately();
+    testRepeatedCompletionIsOneFrame();
+    testBudgetZeroPushesEverything();
+    testCancel();
+    return 0;
+}
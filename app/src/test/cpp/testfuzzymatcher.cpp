@@ -0,0 +1,156 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "androidkeyboard/fuzzymatcher.h"
+
+using Hints = std::vector<std::pair<std::string, std::string>>;
+
+static const auto NoLimit = std::chrono::hours(1);
+
+static FuzzyDictionary dictionary(const std::vector<std::string> &words) {
+    std::vector<std::pair<std::string, uint16_t>> entries;
+    uint16_t weight = 1000;
+    for (const auto &w: words) entries.emplace_back(w, weight--);
+    FuzzyDictionary dict;
+    dict.build(std::move(entries));
+    return dict;
+}
+
+static std::vector<std::string> words(const FuzzyMatcher::Result &result) {
+    std::vector<std::string> r;
+    for (const auto &c: result.corrections) r.push_back(c.word);
+    return r;
+}
+
+void testAdjacent() {
+    assert(FuzzyMatcher::adjacent('g', 'h') && FuzzyMatcher::adjacent('g', 't'));
+    assert(FuzzyMatcher::adjacent('g', 'y') && FuzzyMatcher::adjacent('g', 'b'));
+    assert(FuzzyMatcher::adjacent('G', 'v'));
+    assert(!FuzzyMatcher::adjacent('g', 'r') && !FuzzyMatcher::adjacent('g', 'n'));
+    assert(!FuzzyMatcher::adjacent('p', 'a') && !FuzzyMatcher::adjacent('g', 'g'));
+    assert(!FuzzyMatcher::adjacent('1', '2'));
+}
+
+void testPrefixCost() {
+    // adjacent, then other substitution; trailing letters of the word are free
+    assert(FuzzyMatcher::prefixCost("thw", "there", 4) == 1);
+    assert(FuzzyMatcher::prefixCost("thp", "there", 4) == 2);
+    // h and t are not next to each other
+    assert(FuzzyMatcher::prefixCost("hte", "the", 4) == 4);
+    assert(FuzzyMatcher::prefixCost("hell", "hello", 4) == 0);
+    // "hell" with o next to l
+    assert(FuzzyMatcher::prefixCost("helo", "hello", 4) == 1);
+    assert(FuzzyMatcher::prefixCost("hellp", "hello", 4) == 1);
+    assert(FuzzyMatcher::prefixCost("Hellp", "hello", 4) == 1);
+}
+
+void testMatch() {
+    const auto dict = dictionary({"the", "there", "their", "then", "hello", "help", "world", "word", "thaw"});
+    // "thw": "the..." are e next to w, "thaw" is a next to w; then by weight
+    const auto r = FuzzyMatcher::match(dict, "thw", 2, 10, NoLimit);
+    assert(!r.exhausted);
+    assert((words(r) == std::vector<std::string>{"the", "there", "their", "then", "thaw"}));
+    assert(r.corrections[0].cost == 1 && r.corrections[4].cost == 1);
+    // a substitution of keys apart costs more than one next to it
+    const auto far = FuzzyMatcher::match(dict, "thp", 2, 10, NoLimit);
+    assert(far.corrections.size() == 5 && far.corrections[0].cost == 2);
+    assert(FuzzyMatcher::match(dict, "thp", 1, 10, NoLimit).corrections.empty());
+    // exact prefixes are left to the spell module
+    assert(FuzzyMatcher::match(dict, "wor", 2, 10, NoLimit).corrections.empty());
+    assert(words(FuzzyMatcher::match(dict, "wprl", 2, 10, NoLimit)) == std::vector<std::string>{"world"});
+    assert(FuzzyMatcher::match(dict, "thw", 2, 1, NoLimit).corrections.size() == 1);
+}
+
+// screening must not lose anything the weighted distance accepts
+void testAgainstBruteForce() {
+    std::vector<std::string> list;
+    uint64_t state = 42;
+    auto next = [&state] {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(state >> 33);
+    };
+    for (int i = 0; i < 3000; i++) {
+        std::string w;
+        const auto len = 2 + next() % 8;
+        for (uint32_t j = 0; j < len; j++) w += static_cast<char>('a' + next() % 6);
+        list.push_back(w);
+    }
+    const auto dict = dictionary(list);
+    for (const char *input: {"abc", "fedc", "aaf", "bcdea", "ef"}) {
+        for (int maxCost = 1; maxCost <= 3; maxCost++) {
+            size_t expected = 0;
+            for (size_t i = 0; i < dict.size(); i++) {
+                const auto cost = FuzzyMatcher::prefixCost(input, dict.word(i), maxCost);
+                if (cost > 0 && cost <= maxCost && !dict.word(i).starts_with(input)) expected++;
+            }
+            const auto r = FuzzyMatcher::match(dict, input, maxCost, dict.size(), NoLimit);
+            assert(r.corrections.size() == expected);
+        }
+    }
+}
+
+// when time runs out, words starting with the letter typed or a key next to it were screened
+void testScanOrder() {
+    std::vector<std::string> list;
+    for (int i = 0; i < 200; i++) {
+        list.push_back(std::string(1, static_cast<char>('a' + i % 2)) + std::to_string(i));
+    }
+    list.emplace_back("zebra");
+    const auto dict = dictionary(list);
+    assert(dict.initial('a') == std::make_pair(size_t(0), size_t(100)));
+    assert(dict.initial('z') == std::make_pair(size_t(200), size_t(201)));
+    assert(dict.initial('y').first == dict.initial('y').second);
+    // z is next to x; a budget of nothing still screens until the clock is first read
+    const auto r = FuzzyMatcher::match(dict, "xeb", 2, 10, std::chrono::seconds(0));
+    assert(r.exhausted);
+    assert(words(r) == std::vector<std::string>{"zebra"});
+}
+
+void testMerge() {
+    Hints hints = {{"the", "the"}, {"then", "then"}, {"there", "there"}};
+    FuzzyMatcher::merge(hints, {{"thaw", 1, 0}, {"them", 2, 0}, {"there", 2, 0}}, "thw");
+    assert((hints == Hints{{"the", "the"}, {"thaw", "thaw"}, {"then", "then"}, {"them", "them"}, {"there", "there"}}));
+    Hints capitalized;
+    FuzzyMatcher::merge(capitalized, {{"world", 1, 0}}, "Wprld");
+    assert((capitalized == Hints{{"World", "World"}}));
+}
+
+void testFscd() {
+    std::string file("FSCD0000", 8);
+    file += std::string("\x03\x00\x00\x00", 4);
+    for (auto [word, weight]: std::vector<std::pair<std::string, uint16_t>>{{"zoo", 5}, {"apple", 300}, {"ape", 7}}) {
+        file += static_cast<char>(weight & 0xff);
+        file += static_cast<char>(weight >> 8);
+        file += word;
+        file += '\0';
+    }
+    FuzzyDictionary dict;
+    std::istringstream in(file);
+    assert(dict.loadFscd(in));
+    assert(dict.size() == 3);
+    assert(dict.word(0) == "ape" && dict.word(1) == "apple" && dict.word(2) == "zoo");
+    assert(dict.shared(1) == 2 && dict.shared(2) == 0);
+    assert(dict.weight(1) == 300);
+    std::istringstream bad("FSCD0001");
+    assert(!FuzzyDictionary().loadFscd(bad));
+}
+
+int main() {
+    testAdjacent();
+    testPrefixCost();
+    testMatch();
+    testAgainstBruteForce();
+    testScanOrder();
+    testMerge();
+    testFscd();
+    return 0;
+}
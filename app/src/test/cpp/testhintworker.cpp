@@ -0,0 +1,81 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "androidkeyboard/hintworker.h"
+
+static void waitIdle(HintWorker &worker) {
+    while (!worker.idle()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void testRuns() {
+    HintWorker worker;
+    std::promise<std::thread::id> ran;
+    worker.submit([&] { ran.set_value(std::this_thread::get_id()); });
+    assert(ran.get_future().get() != std::this_thread::get_id());
+    waitIdle(worker);
+    assert(worker.stats().completed == 1);
+}
+
+void testLatestOnly() {
+    HintWorker worker;
+    std::promise<void> started, release;
+    auto released = release.get_future().share();
+    worker.submit([&] {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+    // while the first one runs, only the last of these is kept
+    std::mutex mutex;
+    std::vector<int> ran;
+    for (int i = 0; i < 10; i++) {
+        worker.submit([&, i] {
+            std::lock_guard lock(mutex);
+            ran.push_back(i);
+        });
+    }
+    release.set_value();
+    waitIdle(worker);
+    assert(ran == std::vector<int>{9});
+    const auto stats = worker.stats();
+    assert(stats.completed == 2 && stats.superseded == 9);
+}
+
+void testDestroy() {
+    std::atomic<int> ran{0};
+    std::promise<void> started, release;
+    auto released = release.get_future().share();
+    auto worker = std::make_unique<HintWorker>();
+    worker->submit([&] {
+        started.set_value();
+        released.wait();
+        ran++;
+    });
+    started.get_future().wait();
+    worker->submit([&] { ran += 10; });
+    std::thread destroy([&] { worker.reset(); });
+    // give the destructor time to drop the pending one, then let the running one finish
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release.set_value();
+    destroy.join();
+    assert(ran == 1);
+}
+
+int main() {
+    testRuns();
+    testLatestOnly();
+    testDestroy();
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "androidfrontend/icsnapshot.h"
+
+static std::string tempPath() {
+    char dir[] = "/tmp/icsnapshot-XXXXXX";
+    assert(mkdtemp(dir));
+    return std::string(dir) + "/icsnapshot";
+}
+
+static size_t fileSize(const std::string &path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return static_cast<size_t>(in.tellg());
+}
+
+static std::vector<int> uids(const InputContextSnapshot &snapshot) {
+    std::vector<int> result;
+    for (const auto &s: snapshot.states()) result.push_back(s.uid);
+    return result;
+}
+
+void testRoundTrip() {
+    const auto path = tempPath();
+    const InputContextState a{10001, "com.example.a", "pinyin", 0x40};
+    const InputContextState b{10002, "com.example.b", "keyboard-us", 0};
+    const InputContextState c{10003, "com.example.c", "rime", 1ULL << 40};
+    {
+        InputContextSnapshot snapshot(path);
+        snapshot.load();
+        snapshot.put(a);
+        snapshot.put(b);
+        snapshot.put(c);
+        snapshot.touch(a.uid);
+        snapshot.erase(b.uid);
+        auto a2 = a;
+        a2.inputMethod = "shuangpin";
+        snapshot.put(a2);
+        // process gets killed here, nothing else is flushed
+    }
+    InputContextSnapshot restored(path);
+    assert(!restored.loaded());
+    restored.load();
+    assert((uids(restored) == std::vector<int>{a.uid, c.uid}));
+    assert(restored.find(a.uid)->inputMethod == "shuangpin");
+    assert(*restored.find(c.uid) == c);
+    assert(!restored.find(b.uid));
+}
+
+void testTornTail() {
+    const auto path = tempPath();
+    {
+        InputContextSnapshot snapshot(path);
+        snapshot.put({1, "p1", "im1", 1});
+        snapshot.put({2, "p2", "im2", 2});
+    }
+    // lose the last bytes, like a write cut short by the process dying
+    const auto size = fileSize(path);
+    assert(truncate(path.c_str(), static_cast<off_t>(size - 3)) == 0);
+    {
+        InputContextSnapshot snapshot(path);
+        snapshot.load();
+        assert((uids(snapshot) == std::vector<int>{1}));
+        // log was rewritten, so new records don't follow garbage
+        snapshot.put({3, "p3", "im3", 3});
+    }
+    InputContextSnapshot snapshot(path);
+    snapshot.load();
+    assert((uids(snapshot) == std::vector<int>{3, 1}));
+}
+
+void testCompactAndLimit() {
+    const auto path = tempPath();
+    {
+        InputContextSnapshot snapshot(path, 4);
+        for (int round = 0; round < 200; round++) {
+            for (int uid = 0; uid < 6; uid++) {
+                snapshot.put({uid, "pkg", "im" + std::to_string(round), 0});
+            }
+        }
+        assert(snapshot.size() == 4);
+    }
+    // bounded by compaction, instead of growing by every record
+    assert(fileSize(path) < 2048);
+    InputContextSnapshot snapshot(path, 4);
+    snapshot.load();
+    assert((uids(snapshot) == std::vector<int>{5, 4, 3, 2}));
+    assert(snapshot.find(5)->inputMethod == "im199");
+    snapshot.setMaxEntries(2);
+    assert((uids(snapshot) == std::vector<int>{5, 4}));
+}
+
+void testBadFile() {
+    const auto path = tempPath();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a snapshot";
+    }
+    InputContextSnapshot snapshot(path);
+    snapshot.load();
+    assert(snapshot.size() == 0);
+    snapshot.put({7, "p", "im", 0});
+    snapshot.sync();
+    InputContextSnapshot reloaded(path);
+    reloaded.load();
+    assert((uids(reloaded) == std::vector<int>{7}));
+}
+
+// records are written by the snapshot's own thread, sync() waits for them
+void testSync() {
+    const auto path = tempPath();
+    InputContextSnapshot snapshot(path);
+    snapshot.load();
+    snapshot.put({1, "p1", "im1", 1});
+    snapshot.sync();
+    {
+        InputContextSnapshot reader(path);
+        reader.load();
+        assert((uids(reader) == std::vector<int>{1}));
+    }
+    // records queued after a rewrite follow it in the new file
+    snapshot.put({2, "p2", "im2", 2});
+    snapshot.compact();
+    snapshot.put({3, "p3", "im3", 3});
+    snapshot.touch(1);
+    snapshot.sync();
+    InputContextSnapshot reader(path);
+    reader.load();
+    assert((uids(reader) == std::vector<int>{1, 3, 2}));
+}
+
+int main() {
+    testRoundTrip();
+    testTornTail();
+    testCompactAndLimit();
+    testBadFile();
+    testSync();
+    return 0;
+}
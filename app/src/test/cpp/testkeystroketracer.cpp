@@ -0,0 +1,154 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+#include "androidfrontend/keystroketracer.h"
+
+static const StageLatency &stage(const KeystrokeLatency &l, KeystrokeStage s) {
+    return l.stages[static_cast<size_t>(s)];
+}
+
+// reported value is within the relative error of the histogram
+static bool near(uint64_t actual, uint64_t expected) {
+    const auto diff = actual > expected ? actual - expected : expected - actual;
+    return diff * 16 <= expected;
+}
+
+void testHistogramPercentiles() {
+    LatencyHistogram h;
+    assert(h.percentile(0.5) == 0);
+    for (uint64_t i = 1; i <= 1000; i++) {
+        h.add(i * 1000);
+    }
+    assert(h.count() == 1000);
+    assert(near(h.percentile(0.5), 500000));
+    assert(near(h.percentile(0.95), 950000));
+    assert(near(h.percentile(0.99), 990000));
+    // small values are exact
+    LatencyHistogram small;
+    small.add(3);
+    assert(small.percentile(0.99) == 3);
+    // huge values are clamped instead of overflowing
+    small.add(uint64_t(1) << 50);
+    assert(small.percentile(1) >= uint64_t(1) << 39);
+    h.clear();
+    assert(h.count() == 0);
+}
+
+void testDisabledRecordsNothing() {
+    KeystrokeTracer tracer;
+    {
+        KeystrokeSpan span(&tracer, KeystrokeStage::Jni);
+    }
+    {
+        KeystrokeSpan span(nullptr, KeystrokeStage::Jni);
+    }
+    assert(stage(tracer.latency(), KeystrokeStage::Jni).count == 0);
+    tracer.setEnabled(true);
+    {
+        KeystrokeSpan span(&tracer, KeystrokeStage::Jni);
+    }
+    assert(stage(tracer.latency(), KeystrokeStage::Jni).count == 1);
+}
+
+void testStagesAndTotal() {
+    KeystrokeTracer tracer;
+    tracer.setEnabled(true);
+    for (int i = 0; i < 100; i++) {
+        const uint64_t begin = 1000000;
+        tracer.beginKeystroke(i, begin);
+        tracer.record(KeystrokeStage::Jni, begin, begin + 20000);
+        tracer.record(KeystrokeStage::Engine, begin + 1000, begin + 11000);
+        tracer.record(KeystrokeStage::Callback, begin + 30000, begin + 40000);
+        tracer.endKeystroke(begin + 40000);
+        // a second push without a new key press is not counted again
+        tracer.endKeystroke(begin + 90000);
+    }
+    const auto l = tracer.latency();
+    assert(stage(l, KeystrokeStage::Jni).count == 100);
+    assert(near(stage(l, KeystrokeStage::Jni).p50, 20000));
+    assert(near(stage(l, KeystrokeStage::Engine).p99, 10000));
+    assert(stage(l, KeystrokeStage::Total).count == 100);
+    assert(near(stage(l, KeystrokeStage::Total).p95, 40000));
+    assert(stage(l, KeystrokeStage::Candidates).count == 0);
+    tracer.reset();
+    assert(tracer.latency().stages[0].count == 0);
+}
+
+void testKeystrokeAcrossToggleIsDropped() {
+    KeystrokeTracer tracer;
+    tracer.setEnabled(true);
+    tracer.beginKeystroke(1, 1000);
+    tracer.setEnabled(false);
+    tracer.setEnabled(true);
+    tracer.endKeystroke(100000000);
+    assert(stage(tracer.latency(), KeystrokeStage::Total).count == 0);
+}
+
+void testRingOverflow() {
+    KeystrokeTracer tracer;
+    tracer.setEnabled(true);
+    const auto n = KeystrokeTracer::Ring::Capacity + 10;
+    for (uint64_t i = 0; i < n; i++) {
+        tracer.record(KeystrokeStage::FlushUI, 0, 100);
+    }
+    auto l = tracer.latency();
+    assert(stage(l, KeystrokeStage::FlushUI).count == KeystrokeTracer::Ring::Capacity);
+    assert(l.dropped == 10);
+    // drained, so there is room again
+    tracer.record(KeystrokeStage::FlushUI, 0, 100);
+    l = tracer.latency();
+    assert(stage(l, KeystrokeStage::FlushUI).count == KeystrokeTracer::Ring::Capacity + 1);
+}
+
+void testThreadsRecordConcurrently() {
+    KeystrokeTracer tracer;
+    tracer.setEnabled(true);
+    constexpr int PerThread = 100000;
+    auto producer = [&tracer](KeystrokeStage s) {
+        for (int i = 0; i < PerThread; i++) {
+            tracer.record(s, 0, 500);
+        }
+    };
+    std::thread a(producer, KeystrokeStage::Engine);
+    std::thread b(producer, KeystrokeStage::Callback);
+    // collect while they record
+    for (int i = 0; i < 100; i++) {
+        tracer.latency();
+    }
+    a.join();
+    b.join();
+    const auto l = tracer.latency();
+    const auto collected = stage(l, KeystrokeStage::Engine).count + stage(l, KeystrokeStage::Callback).count;
+    assert(collected + l.dropped == 2 * PerThread);
+}
+
+void testNewTracerAtSameAddress() {
+    alignas(KeystrokeTracer) static unsigned char storage[sizeof(KeystrokeTracer)];
+    auto *first = new(storage) KeystrokeTracer();
+    first->setEnabled(true);
+    first->record(KeystrokeStage::Jni, 0, 1);
+    first->~KeystrokeTracer();
+    // the per thread cache must not hand out the ring of the destroyed tracer
+    auto *second = new(storage) KeystrokeTracer();
+    second->setEnabled(true);
+    second->record(KeystrokeStage::Jni, 0, 1);
+    assert(stage(second->latency(), KeystrokeStage::Jni).count == 1);
+    second->~KeystrokeTracer();
+}
+
+int main() {
+    testHistogramPercentiles();
+    testDisabledRecordsNothing();
+    testStagesAndTotal();
+    testKeystrokeAcrossToggleIsDropped();
+    testRingOverflow();
+    testThreadsRecordConcurrently();
+    testNewTracerAtSameAddress();
+    return 0;
+}
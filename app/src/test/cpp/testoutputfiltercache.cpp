@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <string>
+
+#include "androidfrontend/outputfiltercache.h"
+
+static int calls = 0;
+
+static std::string upper(const std::string &s) {
+    calls++;
+    std::string r = s;
+    for (auto &c: r) c = static_cast<char>(c >= 'a' && c <= 'z' ? c - 32 : c);
+    return r;
+}
+
+void testMemo() {
+    OutputFilterCacheStats stats;
+    OutputFilterCache cache(stats, 8);
+    calls = 0;
+    const std::string a = "a", b = "b";
+    assert(cache.get(a, [&] { return upper(a); }) == "A");
+    assert(cache.get(a, [&] { return upper(a); }) == "A");
+    assert(cache.get(b, [&] { return upper(b); }) == "B");
+    assert(calls == 2);
+    assert(stats.hits == 1 && stats.misses == 2);
+}
+
+void testBounded() {
+    OutputFilterCacheStats stats;
+    OutputFilterCache cache(stats, 8);
+    calls = 0;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 100; i++) {
+            const auto s = std::to_string(i);
+            cache.get(s, [&] { return upper(s); });
+            assert(cache.size() <= 8);
+        }
+    }
+    // nothing survives a cycle longer than the capacity
+    assert(calls == 300);
+    assert(stats.evictions > 0);
+    // but a working set within it does, even while new entries keep coming
+    calls = 0;
+    for (int i = 0; i < 100; i++) {
+        const auto s = "new" + std::to_string(i);
+        cache.get(s, [&] { return upper(s); });
+        const std::string hot = "hot";
+        cache.get(hot, [&] { return upper(hot); });
+    }
+    assert(calls == 101);
+}
+
+void testReset() {
+    OutputFilterCacheStats stats;
+    OutputFilterCache cache(stats);
+    calls = 0;
+    const std::string a = "a";
+    cache.get(a, [&] { return upper(a); });
+    cache.reset();
+    assert(cache.size() == 0);
+    assert(stats.invalidations == 1);
+    // nothing to drop, not counted
+    cache.reset();
+    assert(stats.invalidations == 1);
+    assert(cache.get(a, [] { return std::string("changed"); }) == "changed");
+    assert(calls == 1);
+}
+
+void testSharedStats() {
+    OutputFilterCacheStats stats;
+    OutputFilterCache first(stats), second(stats);
+    const std::string a = "a";
+    first.get(a, [&] { return upper(a); });
+    second.get(a, [&] { return upper(a); });
+    second.get(a, [&] { return upper(a); });
+    assert(stats.misses == 2 && stats.hits == 1);
+}
+
+int main() {
+    testMemo();
+    testBounded();
+    testReset();
+    testSharedStats();
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "androidkeyboard/predictionbudget.h"
+
+void testTop() {
+    TopPredictions top(3);
+    const float scores[] = {-3.f, -1.f, -5.f, -2.f, -1.f, -4.f};
+    for (int i = 0; i < 6; i++) {
+        top.offer("w" + std::to_string(i), scores[i]);
+        assert(top.size() <= 3);
+    }
+    const auto result = top.take();
+    assert(result.size() == 3);
+    // ties keep the order they came in
+    assert(result[0].first == "w1" && result[1].first == "w4" && result[2].first == "w3");
+    assert(result[2].second == -2.f);
+    assert(top.size() == 0);
+}
+
+void testTopFewer() {
+    TopPredictions top(10);
+    top.offer("a", -1.f);
+    top.offer("b", 0.f);
+    const auto result = top.take();
+    assert(result.size() == 2 && result[0].first == "b");
+    TopPredictions none(0);
+    none.offer("a", 0.f);
+    assert(none.take().empty());
+}
+
+void testBudget() {
+    PredictionBudget budget(std::chrono::hours(1), 4);
+    for (int i = 0; i < 1000; i++) {
+        assert(budget.step());
+    }
+    assert(!budget.exhausted() && budget.steps() == 1000);
+
+    PredictionBudget expired(std::chrono::milliseconds(1), 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    // the clock is only read every 4 steps
+    assert(expired.step() && expired.step() && expired.step());
+    assert(!expired.step());
+    assert(expired.exhausted() && !expired.step());
+}
+
+int main() {
+    testTop();
+    testTopFewer();
+    testBudget();
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <algorithm>
+#include <cassert>
+#include <list>
+#include <random>
+#include <vector>
+
+#include "androidfrontend/slablrucache.h"
+
+struct Context;
+using Cache = SlabLRUCache<Context>;
+
+static int alive = 0;
+
+// releases itself from the cache on destruction, like AndroidInputContext
+struct Context {
+    Cache *cache;
+    int uid;
+
+    Context(Cache *cache, int uid) : cache(cache), uid(uid) { alive++; }
+
+    ~Context() {
+        assert(cache->release(uid) == nullptr);
+        alive--;
+    }
+};
+
+static Context *create(Cache &cache, int uid) {
+    return new Context(&cache, uid);
+}
+
+void testLRUOrder() {
+    Cache cache(3);
+    for (int uid: {1, 2, 3}) {
+        assert(cache.insert(uid, create(cache, uid)));
+    }
+    assert(cache.size() == 3);
+    assert((cache.keys() == std::vector<int>{3, 2, 1}));
+    // refresh
+    assert(cache.find(1));
+    assert((cache.keys() == std::vector<int>{1, 3, 2}));
+    // already present
+    assert(!cache.insert(1, nullptr));
+    assert(cache.find(1)->get()->uid == 1);
+    // evicts 2, whose destructor calls back into the cache
+    assert(cache.insert(4, create(cache, 4)));
+    assert(!cache.contains(2));
+    assert((cache.keys() == std::vector<int>{4, 1, 3}));
+    assert(alive == 3);
+    assert(cache.stats().evictions == 1);
+    assert(cache.stats().hits == 2);
+    assert(!cache.find(2));
+    assert(cache.stats().misses == 1);
+    cache.clear();
+    assert(cache.empty());
+    assert(alive == 0);
+}
+
+void testReleaseAndErase() {
+    Cache cache(4);
+    cache.insert(1, create(cache, 1));
+    cache.insert(2, create(cache, 2));
+    auto *c = cache.release(1);
+    assert(c && c->uid == 1);
+    assert(!cache.contains(1));
+    assert(cache.size() == 1);
+    delete c;
+    cache.erase(2);
+    assert(cache.empty());
+    assert(alive == 0);
+    // slots are reused
+    for (int uid = 10; uid < 14; uid++) {
+        assert(cache.insert(uid, create(cache, uid)));
+    }
+    assert(cache.stats().evictions == 0);
+    cache.clear();
+}
+
+void testSetCapacity() {
+    Cache cache(8);
+    for (int uid = 0; uid < 8; uid++) {
+        cache.insert(uid, create(cache, uid));
+    }
+    auto *kept = cache.find(2)->get();
+    cache.setCapacity(3);
+    assert(cache.capacity() == 3);
+    assert((cache.keys() == std::vector<int>{2, 7, 6}));
+    assert(alive == 3);
+    // objects are not moved, only their slots
+    assert(cache.find(2)->get() == kept);
+    cache.setCapacity(16);
+    assert(cache.capacity() == 16);
+    assert((cache.keys() == std::vector<int>{2, 7, 6}));
+    for (int uid = 100; uid < 113; uid++) {
+        cache.insert(uid, create(cache, uid));
+    }
+    assert(cache.size() == 16);
+    assert(cache.stats().evictions == 5);
+    cache.setCapacity(0);
+    assert(cache.capacity() == 1);
+    assert(cache.size() == 1);
+    cache.clear();
+    assert(alive == 0);
+}
+
+// compare with a plain list model under random churn, including deletions that
+// exercise backward shifting in the probe sequences
+void testRandomAgainstModel() {
+    constexpr size_t Capacity = 20;
+    Cache cache(Capacity);
+    std::list<int> model;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> uidDist(0, 60);
+    std::uniform_int_distribution<int> opDist(0, 9);
+    for (int step = 0; step < 20000; step++) {
+        const int uid = uidDist(rng) * 1000 + 10000;
+        const auto it = std::find(model.begin(), model.end(), uid);
+        const int op = opDist(rng);
+        if (op < 6) {
+            const bool found = cache.find(uid) != nullptr;
+            assert(found == (it != model.end()));
+            if (!found) {
+                cache.insert(uid, create(cache, uid));
+                if (model.size() == Capacity) model.pop_back();
+            } else {
+                model.erase(it);
+            }
+            model.push_front(uid);
+        } else {
+            cache.erase(uid);
+            if (it != model.end()) model.erase(it);
+        }
+        assert(cache.size() == model.size());
+        assert(alive == static_cast<int>(model.size()));
+    }
+    assert(cache.keys() == std::vector<int>(model.begin(), model.end()));
+}
+
+int main() {
+    testLRUOrder();
+    testReleaseAndErase();
+    testSetCapacity();
+    testRandomAgainstModel();
+    return 0;
+}
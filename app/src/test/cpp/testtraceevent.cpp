@@ -0,0 +1,99 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "trace-event.h"
+
+static std::string json(TraceRecorder &r) {
+    std::ostringstream out;
+    r.writeJson(out);
+    return out.str();
+}
+
+static size_t count(const std::string &s, const std::string &needle) {
+    size_t n = 0;
+    for (auto pos = s.find(needle); pos != std::string::npos; pos = s.find(needle, pos + 1)) {
+        n++;
+    }
+    return n;
+}
+
+void testDisarmedRecordsNothing() {
+    TraceRecorder r(4);
+    {
+        TraceSpan span("loopOnce", "loop", {}, r);
+    }
+    assert(r.size() == 0);
+    assert(json(r) == R"({"displayTimeUnit":"ms","otherData":{"overwritten":0},"traceEvents":[]})");
+    r.start();
+    {
+        TraceSpan span("loopOnce", "loop", {}, r);
+    }
+    r.stop();
+    {
+        TraceSpan span("loopOnce", "loop", {}, r);
+    }
+    assert(r.size() == 1);
+}
+
+void testRingKeepsLatest() {
+    TraceRecorder r(4);
+    for (uint64_t i = 0; i < 10; i++) {
+        r.record({"e", "c", i * 1000, 1, 1, std::to_string(i)});
+    }
+    assert(r.size() == 4);
+    assert(r.total() == 10);
+    const auto s = json(r);
+    assert(count(s, R"("ph":"X")") == 4);
+    assert(s.find(R"("overwritten":6)") != std::string::npos);
+    // oldest kept first
+    const auto first = s.find(R"("detail":"6")");
+    assert(first != std::string::npos);
+    assert(s.find(R"("detail":"9")") > first);
+    assert(s.find(R"("detail":"5")") == std::string::npos);
+    r.clear();
+    assert(r.size() == 0);
+}
+
+void testEventFormat() {
+    TraceRecorder r(4);
+    r.record({"loadAddon", "addon", 1234567, 2001, 42, "pin\"yin\\\n\x01"});
+    r.record({"loopOnce", "loop", 5000, 0, 42, ""});
+    const auto s = json(r);
+    assert(s.find(R"("name":"loadAddon","cat":"addon",)") != std::string::npos);
+    // microseconds with nanosecond fractions
+    assert(s.find(R"("tid":42,"ts":1234.567,"dur":2.001)") != std::string::npos);
+    assert(s.find(R"("args":{"detail":"pin\"yin\\\n\u0001"})") != std::string::npos);
+    // no args when there is no detail
+    assert(s.find(R"("ts":5.000,"dur":0.000})") != std::string::npos);
+}
+
+void testDump() {
+    TraceRecorder r(4);
+    r.start();
+    {
+        TraceSpan span("reloadConfig", "config", "global", r);
+    }
+    const std::string path = "testtraceevent.json";
+    assert(r.dump(path));
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    assert(content.str() == json(r));
+    std::remove(path.c_str());
+    assert(!r.dump("/nonexistent/dir/trace.json"));
+}
+
+int main() {
+    testDisarmedRecordsNothing();
+    testRingKeepsLatest();
+    testEventFormat();
+    testDump();
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "androidkeyboard/userlexicon.h"
+
+namespace fs = std::filesystem;
+
+static fs::path tempBase(const std::string &name) {
+    const auto dir = fs::temp_directory_path() / ("testuserlexicon-" + std::to_string(getpid()));
+    fs::remove_all(dir / name);
+    return dir / name / "en";
+}
+
+void testRecord() {
+    const auto base = tempBase("record");
+    UserLexicon lexicon(base);
+    lexicon.record("Hello");
+    lexicon.record("hello");
+    lexicon.record("world");
+    // too long, or not a word
+    lexicon.record(std::string(UserLexicon::MaxWordSize + 1, 'a'));
+    lexicon.record("two words");
+    lexicon.record("");
+    lexicon.sync();
+    assert(lexicon.count("hello") == 2 && lexicon.count("HELLO") == 2);
+    assert(lexicon.count("world") == 1 && lexicon.count("two") == 0);
+    assert(lexicon.stats().logged == 3);
+}
+
+void testCompactAndReload() {
+    const auto base = tempBase("compact");
+    {
+        UserLexicon lexicon(base, 4);
+        for (const char *w: {"b", "a", "c", "a", "d", "a"}) {
+            lexicon.record(w);
+            lexicon.sync();
+        }
+        assert(lexicon.stats().compactions == 1);
+        assert(lexicon.count("a") == 3 && lexicon.count("d") == 1);
+    }
+    assert(fs::file_size(fs::path(base) += ".idx") > 0);
+    UserLexicon reloaded(base, 4);
+    reloaded.record("e");
+    reloaded.sync();
+    assert(reloaded.count("a") == 3 && reloaded.count("b") == 1 && reloaded.count("e") == 1);
+    // log has 2 lines from before, the index 4
+    for (int i = 0; i < 2; i++) {
+        reloaded.record("b");
+    }
+    reloaded.sync();
+    assert(reloaded.stats().compactions == 1);
+    assert(reloaded.count("b") == 3 && reloaded.count("a") == 3 && reloaded.count("e") == 1);
+}
+
+void testCrashRecovery() {
+    const auto base = tempBase("crash");
+    {
+        UserLexicon lexicon(base, 2);
+        lexicon.record("a");
+        lexicon.record("b");
+        lexicon.sync();
+        assert(lexicon.stats().compactions == 1);
+    }
+    // as if the log was not truncated after the index was renamed, then a line was torn
+    {
+        std::ofstream log(fs::path(base) += ".log", std::ios::app);
+        log << "1 a\n2 b\n3 c\n4 d";
+    }
+    // and compaction died before renaming
+    {
+        std::ofstream tmp(fs::path(base) += ".idx.tmp");
+        tmp << "garbage";
+    }
+    UserLexicon lexicon(base, 100);
+    lexicon.sync();
+    assert(lexicon.count("a") == 1 && lexicon.count("b") == 1);
+    assert(lexicon.count("c") == 1 && lexicon.count("d") == 0);
+    // new lines continue after the highest sequence seen
+    lexicon.record("c");
+    lexicon.sync();
+    assert(lexicon.count("c") == 2);
+}
+
+// counts seen while the index is swapped never include a word twice, nor drop it
+void testCountDuringCompaction() {
+    const auto base = tempBase("swap");
+    UserLexicon lexicon(base, 2);
+    constexpr uint32_t Words = 600;
+    std::atomic<bool> done = false;
+    std::thread reader([&] {
+        uint32_t last = 0;
+        while (!done) {
+            const auto n = lexicon.count("a");
+            assert(n >= last && n <= Words);
+            last = n;
+        }
+    });
+    for (uint32_t i = 0; i < Words; i++) {
+        lexicon.record("a");
+        lexicon.sync();
+    }
+    lexicon.sync();
+    done = true;
+    reader.join();
+    assert(lexicon.count("a") == Words);
+    assert(lexicon.stats().compactions == Words / 2);
+}
+
+void testCorruptIndex() {
+    const auto base = tempBase("corrupt");
+    fs::create_directories(base.parent_path());
+    {
+        std::ofstream idx(fs::path(base) += ".idx");
+        idx << "not an index at all, but long enough";
+    }
+    UserLexicon lexicon(base);
+    lexicon.record("a");
+    lexicon.sync();
+    assert(lexicon.count("a") == 1);
+}
+
+void testRank() {
+    const auto base = tempBase("rank");
+    UserLexicon lexicon(base);
+    using Hints = std::vector<std::pair<std::string, std::string>>;
+    Hints hints;
+    for (const char *w: {"the", "then", "there", "these", "they", "thesis", "thermal", "theory"}) {
+        hints.emplace_back(w, w);
+    }
+    auto ranked = hints;
+    lexicon.rank(ranked);
+    assert(ranked == hints);
+    // used once, up 4 places behind the word there; 3 times, up 8 places
+    lexicon.record("thesis");
+    for (int i = 0; i < 3; i++) lexicon.record("theory");
+    lexicon.sync();
+    lexicon.rank(ranked);
+    assert(ranked[0].second == "theory");
+    assert(ranked[1].second == "the" && ranked[2].second == "then" && ranked[3].second == "thesis");
+    assert(ranked.size() == hints.size());
+}
+
+int main() {
+    testRecord();
+    testCompactAndReload();
+    testCrashRecovery();
+    testCountDuringCompaction();
+    testCorruptIndex();
+    testRank();
+    fs::remove_all(fs::temp_directory_path() / ("testuserlexicon-" + std::to_string(getpid())));
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utf16-utils.h"
+
+static std::u16string decode(const std::string &src, bool scalar = false) {
+    std::u16string out(src.size(), u'\0');
+    const auto n = scalar ? utf16::fromUtf8Scalar(src.data(), src.size(), out.data())
+                          : utf16::fromUtf8(src.data(), src.size(), out.data());
+    out.resize(n);
+    return out;
+}
+
+// expected UTF-16 comes from the compiler, which is the reference decoder for valid input
+static void check(const std::string &src, const std::u16string &expected) {
+    assert(decode(src) == expected);
+    assert(decode(src, true) == expected);
+}
+
+// UTF-8 bytes and the expected result; invalid pieces never end with an incomplete sequence,
+// so that any concatenation decodes to the concatenation of the results
+static const std::vector<std::pair<std::string, std::u16string>> Pieces{
+        {"a", u"a"},
+        {"0123456789abcdef", u"0123456789abcdef"},
+        {" ", u" "},
+        {"中", u"中"},
+        {"文字", u"文字"},
+        {"é", u"é"},
+        {"😀", u"😀"},
+        {"𠀀", u"𠀀"},
+        {"\x80", u"�"},
+        {"\xff", u"�"},
+        {"\xe4\xbdz", u"�z"},
+        {"\xf0\x9f\x98!", u"�!"},
+        {"\xc0\xaf", u"��"},
+        {"\xed\xa0\x80", u"���"},
+};
+
+void testValid() {
+    check("", u"");
+    check("hello", u"hello");
+    check("a long ascii string that spans more than one sixteen byte block",
+          u"a long ascii string that spans more than one sixteen byte block");
+    check("你好，世界", u"你好，世界");
+    check("emoji 😀 mixed with 中文 and ascii, 𠀀 from extension B, ñ, é",
+          u"emoji 😀 mixed with 中文 and ascii, 𠀀 from extension B, ñ, é");
+    check("中文 text spanning the block boundary 中文", u"中文 text spanning the block boundary 中文");
+}
+
+void testMalformed() {
+    // truncated at end of input
+    check("a\xe4\xbd", u"a�");
+    check("\xf0\x9f\x98", u"�");
+    // overlong, surrogate, out of range: each byte that can't continue is replaced
+    check("\xe0\x80\xaf", u"���");
+    check("\xf4\x90\x80\x80", u"����");
+    check("\xf5", u"�");
+    // invalid byte inside an ASCII block
+    check("0123456789abcdef\xff" "0123456789abcdef", u"0123456789abcdef�0123456789abcdef");
+}
+
+void testRandom() {
+    std::mt19937 rng(42);
+    for (int round = 0; round < 20000; round++) {
+        std::string src;
+        std::u16string expected;
+        const int count = static_cast<int>(rng() % 40);
+        for (int i = 0; i < count; i++) {
+            const auto &[bytes, units] = Pieces[rng() % Pieces.size()];
+            src += bytes;
+            expected += units;
+        }
+        check(src, expected);
+    }
+    // arbitrary bytes: vectorized and scalar decoders must agree
+    for (int round = 0; round < 20000; round++) {
+        std::string src(rng() % 80, '\0');
+        for (auto &c: src) {
+            c = static_cast<char>(rng() % 2 ? rng() % 0x80 : rng() % 0x100);
+        }
+        const auto result = decode(src);
+        assert(result == decode(src, true));
+        assert(result.size() <= src.size());
+    }
+}
+
+// segments of a fcitx::Text and its byte cursor, to UTF-16
+static int cursor(const std::vector<std::string> &segments, int byteCursor) {
+    utf16::CursorFromUtf8 c(byteCursor);
+    std::u16string units;
+    int length = 0;
+    for (const auto &s: segments) {
+        units.resize(s.size());
+        c.segment(s.data(), s.size(), length, units.data());
+        length += static_cast<int>(decode(s).size());
+    }
+    return c.cursor(length);
+}
+
+void testCursor() {
+    // no cursor stays so, FcitxInputMethodService tells it apart
+    assert(cursor({"ab", "中"}, -1) == -1);
+    assert(cursor({}, -1) == -1);
+    assert(cursor({}, 0) == 0);
+    assert(cursor({"ab", "中"}, 0) == 0);
+    // end of a segment, inside the next one and at the end
+    assert(cursor({"ab", "中"}, 2) == 2);
+    assert(cursor({"ab", "中", "😀"}, 5) == 3);
+    assert(cursor({"ab", "中", "😀"}, 9) == 5);
+    // splitting a character counts the units decoded so far
+    assert(cursor({"😀"}, 2) == 1);
+    // past the end goes to the end
+    assert(cursor({"ab", "中"}, 100) == 3);
+}
+
+int main() {
+    testValid();
+    testMalformed();
+    testRandom();
+    testCursor();
+    return 0;
+}
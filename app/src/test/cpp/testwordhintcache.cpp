@@ -0,0 +1,129 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "androidkeyboard/wordhintcache.h"
+
+static int calls = 0;
+
+static const std::vector<std::string> Words = {
+        "hello", "help", "helmet", "hero", "her", "herb", "world", "word", "work", "worry",
+};
+
+// prefix completions in dictionary order, as the spell module would give for a short input
+static WordHintCache::Hints hint(const std::string &input) {
+    calls++;
+    WordHintCache::Hints hints;
+    for (const auto &word: Words) {
+        if (word.compare(0, input.size(), input) == 0) hints.emplace_back(word, word);
+    }
+    return hints;
+}
+
+static WordHintCache::Hints get(WordHintCache &cache, const std::string &input,
+                                const std::string &language = "en") {
+    return cache.get(language, input, [&] { return hint(input); });
+}
+
+void testBackspace() {
+    WordHintCacheStats stats;
+    WordHintCache cache(stats);
+    calls = 0;
+    for (const char *input: {"w", "wo", "wor", "worl", "wor", "wo", "wor", "work"}) {
+        assert(get(cache, input) == hint(input));
+    }
+    // each one is compared with hint() above
+    assert(calls == 5 + 8);
+    assert(stats.hits == 3 && stats.misses == 5);
+}
+
+// spell dictionaries rank by distance to the whole input, a prefix tells nothing
+void testPrefixNotDerived() {
+    WordHintCacheStats stats;
+    WordHintCache cache(stats);
+    get(cache, "he");
+    assert(cache.find("en", "hel") == nullptr);
+    get(cache, "hel");
+    assert(stats.misses == 2 && stats.hits == 0);
+}
+
+// prefix completions ranked by each word alone, with fewer than the limit
+void testPrefixRanked() {
+    WordHintCacheStats stats;
+    WordHintCache cache(stats, 32, 10);
+    calls = 0;
+    get(cache, "he");
+    assert(get(cache, "her") == hint("her"));
+    assert(get(cache, "herb") == hint("herb"));
+    assert(calls == 1 + 2);
+    assert(stats.misses == 1 && stats.derived == 2);
+    // "w" has as many hints as asked for, a fifth one may have been left out
+    WordHintCache limited(stats, 32, 4);
+    get(limited, "w");
+    assert(limited.find("en", "wo") == nullptr);
+}
+
+void testProvisional() {
+    WordHintCacheStats stats;
+    WordHintCache cache(stats);
+    assert(cache.provisional("en", "hel").empty());
+    get(cache, "h");
+    get(cache, "he");
+    assert((cache.provisional("en", "hel") == WordHintCache::Hints{
+            {"hello", "hello"}, {"help", "help"}, {"helmet", "helmet"}}));
+    assert(cache.provisional("en_GB", "hel").empty());
+    // not a hit, the lookup still has to be done
+    assert(cache.find("en", "hel") == nullptr);
+}
+
+void testFindPut() {
+    WordHintCacheStats stats;
+    WordHintCache cache(stats);
+    // as AndroidKeyboardEngine does, with lookups finishing later
+    assert(cache.find("en", "wor") == nullptr);
+    cache.put("en", "wor", hint("wor"));
+    assert(*cache.find("en", "wor") == hint("wor"));
+    // a later lookup of the same input replaces it
+    cache.put("en", "wor", {{"Work", "work"}});
+    assert(cache.find("en", "wor")->front().first == "Work");
+    assert(cache.size() == 1);
+    assert(stats.misses == 2 && stats.hits == 2);
+}
+
+void testLanguage() {
+    WordHintCacheStats stats;
+    WordHintCache cache(stats);
+    get(cache, "he", "en");
+    get(cache, "he", "en_GB");
+    get(cache, "he", "de");
+    assert(stats.misses == 3 && stats.hits == 0);
+}
+
+void testBounded() {
+    WordHintCacheStats stats;
+    WordHintCache cache(stats, 4);
+    for (int i = 0; i < 20; i++) {
+        get(cache, "x" + std::to_string(i));
+        assert(cache.size() <= 4);
+    }
+    // least recently used went first
+    assert(cache.find("en", "x15") == nullptr);
+    assert(cache.find("en", "x16") != nullptr);
+    cache.clear();
+    assert(cache.size() == 0);
+}
+
+int main() {
+    testBackspace();
+    testPrefixNotDerived();
+    testPrefixRanked();
+    testProvisional();
+    testFindPut();
+    testLanguage();
+    testBounded();
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ * SPDX-FileCopyrightText: Copyright 2026 Fcitx5 for Android Contributors
+ */
+
+package org.fcitx.fcitx5.android
+
+import org.fcitx.fcitx5.android.core.CandidateBuffer
+import org.fcitx.fcitx5.android.core.CandidateDelta
+import org.fcitx.fcitx5.android.core.CandidateWord
+import org.junit.Assert
+import org.junit.Test
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+class CandidateBufferTest {
+
+    // mirrors CandidateBuffer in helper-types.h
+    private fun encode(candidates: List<CandidateWord>): ByteBuffer {
+        val buffer = ByteBuffer.allocateDirect(4096).order(ByteOrder.nativeOrder())
+        buffer.position(8)
+        val offsets = candidates.map {
+            val pos = buffer.position()
+            buffer.putChar((if (it.spaceBetweenComment) 1 else 0).toChar())
+            listOf(it.label, it.text, it.comment).forEach { s ->
+                buffer.putChar(s.length.toChar())
+                s.forEach { c -> buffer.putChar(c) }
+            }
+            pos
+        }
+        buffer.position((buffer.position() + 3) and 3.inv())
+        val table = buffer.position()
+        offsets.forEach { buffer.putInt(it) }
+        buffer.putInt(0, candidates.size)
+        buffer.putInt(4, table)
+        return buffer
+    }
+
+    private val data = listOf(
+        CandidateWord("1", "你好", "nǐ hǎo"),
+        CandidateWord("", "😀", "", false),
+        CandidateWord("10", "hello", "world", true),
+        CandidateWord("", "", "")
+    )
+
+    @Test
+    fun testDecode() {
+        val src = encode(data)
+        val buffer = CandidateBuffer.copyOf(src, src.position())
+        Assert.assertEquals(data.size, buffer.size)
+        Assert.assertEquals(data, buffer.toArray().toList())
+        Assert.assertEquals(data[2], buffer[2])
+    }
+
+    @Test
+    fun testCopyIsDetached() {
+        val src = encode(data)
+        val buffer = CandidateBuffer.copyOf(src, src.position())
+        // native side reuses its buffer for the next push
+        src.clear()
+        while (src.hasRemaining()) src.put(0)
+        Assert.assertEquals(data, buffer.toArray().toList())
+    }
+
+    @Test
+    fun testEmpty() {
+        val src = encode(emptyList())
+        val buffer = CandidateBuffer.copyOf(src, src.position())
+        Assert.assertEquals(0, buffer.size)
+        Assert.assertArrayEquals(emptyArray<CandidateWord>(), buffer.toArray())
+    }
+
+    @Test
+    fun testDeltaApply() {
+        val previous = data.toTypedArray()
+        val inserted = listOf(CandidateWord("", "new", ""))
+        val src = encode(inserted)
+        val buffer = CandidateBuffer.copyOf(src, src.position())
+        val ops = intArrayOf(2, 1, CandidateDelta.INSERT, 1, 0, 2)
+        val expected = listOf(data[2], inserted[0], data[0], data[1])
+        Assert.assertEquals(expected, CandidateDelta.apply(previous, buffer, ops)?.toList())
+    }
+
+    @Test
+    fun testDeltaRejectsMismatch() {
+        val previous = data.toTypedArray()
+        val src = encode(emptyList())
+        val buffer = CandidateBuffer.copyOf(src, src.position())
+        // out of previous list
+        Assert.assertNull(CandidateDelta.apply(previous, buffer, intArrayOf(3, 2)))
+        // more inserted than sent
+        Assert.assertNull(CandidateDelta.apply(previous, buffer, intArrayOf(CandidateDelta.INSERT, 1)))
+        Assert.assertNull(CandidateDelta.apply(previous, buffer, intArrayOf(0)))
+    }
+}